@@ -18,6 +18,8 @@
 
 #include "config.hpp"
 
+#include <vector>
+
 #include "memory.hpp"
 #include "utils.hpp"
 #include "MeshInfo.hpp"
@@ -251,9 +253,11 @@ struct Box3d
   }
 
 #ifdef COMB_ENABLE_MPI
-  MPI_Datatype get_type_subarray() const
+  MPI_Datatype get_type_subarray(ElemType type) const
   {
-    MPI_Datatype mpi_type = detail::MPI::Type_create_subarray(3, info.len, sizes, min, MPI_ORDER_FORTRAN, MPI_DOUBLE);
+    // the padded mesh is the array
+    IdxT array_sizes[3] { info.stride[1], info.stride[2] / info.stride[1], info.len[2] };
+    MPI_Datatype mpi_type = detail::MPI::Type_create_subarray(3, array_sizes, sizes, min, MPI_ORDER_FORTRAN, detail::MPI::elem_mpi_type(type));
     detail::MPI::Type_commit(&mpi_type);
     return mpi_type;
   }
@@ -268,13 +272,100 @@ struct Box3d
     IdxT imax = min[0] + sizes[0];
     IdxT jmax = min[1] + sizes[1];
     IdxT kmax = min[2] + sizes[2];
-    con.for_all_3d(kmin, kmax, jmin, jmax, imin, imax, make_set_idxr_idxr(detail::indexer_kji{info.len[0]*info.len[1], info.len[0]}, index_list, detail::indexer_idx{}));
+    con.for_all_3d(kmin, kmax, jmin, jmax, imin, imax, make_set_idxr_idxr(detail::indexer_kji{info.stride[2], info.stride[1]}, index_list, detail::indexer_idx{}));
     //for(IdxT idx = 0; idx < (imax-imin)*(jmax-jmin)*(kmax-kmin); ++idx) {
     //  FGPRINTF(FileGroup::proc, "indices[%i] = %i\n", idx, index_list[idx]);
     //  assert(0 <= index_list[idx] && index_list[idx] < (imax-imin)*(jmax-jmin)*(kmax-kmin));
     //}
     con.synchronize();
   }
+
+  // classify this box by the number of dimensions in which
+  // it is no wider than the ghost zones
+  detail::ShapeClass shape_class() const
+  {
+    IdxT num_thin = 0;
+    for (IdxT dim = 0; dim < 3; ++dim) {
+      if (sizes[dim] <= info.ghost_widths[dim]) ++num_thin;
+    }
+    return (num_thin == 3) ? detail::ShapeClass::corner
+         : (num_thin == 2) ? detail::ShapeClass::edge
+         : (num_thin == 1) ? detail::ShapeClass::face
+                           : detail::ShapeClass::mixed;
+  }
+
+  // describe this box as contiguous runs in i,
+  // merging j and k into the runs when the box spans whole rows or planes
+  detail::box_runs get_box_runs() const
+  {
+    IdxT lens[3]    { sizes[0], sizes[1], sizes[2] };
+    IdxT strides[3] { info.stride[0], info.stride[1], info.stride[2] };
+    IdxT ndims = 3;
+    while (ndims > 1 && lens[0] * strides[0] == strides[1]) {
+      lens[0] *= lens[1];
+      for (IdxT dim = 1; dim < ndims-1; ++dim) {
+        lens[dim]    = lens[dim+1];
+        strides[dim] = strides[dim+1];
+      }
+      ndims -= 1;
+    }
+    IdxT lens1    = (ndims > 1) ? lens[1] : 1;
+    IdxT strides1 = (ndims > 1) ? strides[1] : 0;
+    IdxT lens2    = (ndims > 2) ? lens[2] : 1;
+    IdxT strides2 = (ndims > 2) ? strides[2] : 0;
+    detail::box_runs box;
+    box.offset  = min[0] + min[1] * info.stride[1] + min[2] * info.stride[2];
+    box.run_len = lens[0];
+    // the buffer is ordered like the box, loop over the longer dimension
+    if (lens2 >= lens1) {
+      box.row_runs       = lens1;
+      box.run_stride     = strides1;
+      box.run_buf_stride = lens[0];
+      box.num_rows       = lens2;
+      box.row_stride     = strides2;
+      box.row_buf_stride = lens[0] * lens1;
+    } else {
+      box.row_runs       = lens2;
+      box.run_stride     = strides2;
+      box.run_buf_stride = lens[0] * lens1;
+      box.num_rows       = lens1;
+      box.row_stride     = strides1;
+      box.row_buf_stride = lens[0];
+    }
+    if (box.size() == 0) box.num_rows = 0;
+    return box;
+  }
+
+  // true if the zones of this box in buffer order are evenly strided runs
+  // in the mesh, ie the box runs have a single row or a single run per row
+  bool single_stride() const
+  {
+    detail::box_runs box = get_box_runs();
+    return box.size() > 0 && (box.row_runs == 1 || box.num_rows == 1);
+  }
+
+  // append the zones of this box in buffer order to the runs of contiguous
+  // zones given by starts and offsets, offsets must have at least one entry,
+  // runs that continue the previous run are merged into it
+  void append_index_runs(std::vector<LidxT>& starts, std::vector<IdxT>& offsets) const
+  {
+    assert(!offsets.empty());
+    for (IdxT k = min[2]; k < min[2] + sizes[2]; ++k) {
+      for (IdxT j = min[1]; j < min[1] + sizes[1]; ++j) {
+        LidxT start = min[0] + j * info.stride[1] + k * info.stride[2];
+        IdxT len = sizes[0];
+        if (len == 0) continue;
+        IdxT num_runs = starts.size();
+        if (num_runs > 0 &&
+            starts[num_runs-1] + (offsets[num_runs] - offsets[num_runs-1]) == start) {
+          offsets[num_runs] += len;
+        } else {
+          starts.emplace_back(start);
+          offsets.emplace_back(offsets[num_runs] + len);
+        }
+      }
+    }
+  }
 };
 
 struct Box3dTemplate
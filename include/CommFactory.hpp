@@ -20,6 +20,7 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <cstring>
 #include <cassert>
 #include <type_traits>
 #include <list>
@@ -28,6 +29,7 @@
 #include <set>
 #include <unordered_map>
 #include <utility>
+#include <algorithm>
 
 #include "memory.hpp"
 #include "for_all.hpp"
@@ -173,6 +175,11 @@ struct CommFactory
 
     populate_mesh_info_maps(recv_mesh_info_map, send_mesh_info_map);
 
+    // messages whose partner is this rank are copied in the mesh instead
+    if (comb_allow_self_copy()) {
+      populate_self_copy(comm, con_many, recv_mesh_info_map, send_mesh_info_map);
+    }
+
     // use the msg_info_maps to populate messages in comm
     populate_comm(comm, con_many, con_few, comm.m_recvs, recv_mesh_info_map);
     populate_comm(comm, con_many, con_few, comm.m_sends, send_mesh_info_map);
@@ -398,7 +405,69 @@ private:
   template < typename context >
   bool msg_info_items_combineable(context&) const
   {
-    return comb_allow_per_message_pack_fusing();
+    // boxes can not be combined into a single box item
+    return comb_allow_per_message_pack_fusing() &&
+           comb_pack_mode() != PackMode::box;
+  }
+
+  // index runs are built on the host so are only used with host policies
+  template < typename context >
+  bool index_runs_usable(context&) const
+  {
+    return false;
+  }
+
+  bool index_runs_usable(ExecContext<seq_pol>&) const
+  {
+    return comb_pack_mode() == PackMode::runs;
+  }
+
+  bool index_runs_usable(ExecContext<simd_pol>&) const
+  {
+    return comb_pack_mode() == PackMode::runs;
+  }
+
+#ifdef COMB_ENABLE_OPENMP
+  bool index_runs_usable(ExecContext<omp_pol>&) const
+  {
+    return comb_pack_mode() == PackMode::runs;
+  }
+#endif
+
+  // items of a single box with evenly strided zones may skip packing
+  static void set_strided_box(detail::MessageItemBase& item, Box3d const* msg_box)
+  {
+    if (msg_box != nullptr && msg_box->single_stride()) {
+      item.strided = true;
+      item.strided_box = msg_box->get_box_runs();
+    }
+  }
+
+  template < typename exec_policy, typename msg_group_type >
+  void add_index_runs_item(
+      msg_group_type& msg_group,
+      int partner_rank,
+      std::vector<LidxT> const& starts,
+      std::vector<IdxT> const& offsets,
+      Box3d const* msg_box,
+      COMB::Allocator& mesh_aloc) const
+  {
+    using message_item_type = detail::MessageItem<exec_policy>;
+
+    detail::index_runs runs;
+    runs.num_runs = starts.size();
+    runs.starts  = (LidxT*)mesh_aloc.allocate(sizeof(LidxT)*runs.num_runs);
+    runs.offsets = (IdxT*) mesh_aloc.allocate(sizeof(IdxT)*(runs.num_runs+1));
+    std::copy(starts.begin(), starts.end(), runs.starts);
+    std::copy(offsets.begin(), offsets.end(), runs.offsets);
+
+    IdxT size = offsets.back();
+    IdxT nbytes = item_nbytes(size, msg_group.m_zone_nbytes); // data nbytes
+
+    message_item_type item{size, nbytes, runs, mesh_aloc};
+    set_strided_box(item, msg_box);
+
+    msg_group.add_message_item(partner_rank, std::move(item));
   }
 
 #ifdef COMB_ENABLE_MPI
@@ -408,6 +477,80 @@ private:
   }
 #endif
 
+  // moves the messages whose partner is this rank out of the maps into the
+  // self copy of the comm, each recv box and the send box msg_map pairs it
+  // with become an item, described by box unless packing by index list so
+  // box, runs, and low footprint modes keep no index lists
+  template < typename comm_type, typename exec_policy >
+  void populate_self_copy(comm_type& comm,
+                          ExecContext<exec_policy>& con_many,
+                          mesh_info_map_type& recv_mesh_info_map,
+                          mesh_info_map_type& send_mesh_info_map) const
+  {
+    int myrank = comm.comminfo.rank;
+    bool box_items = comb_pack_mode() != PackMode::list;
+
+    for (auto& mesh_msg_item : recv_mesh_info_map) {
+
+      MeshInfo const& meshinfo = mesh_msg_item.first;
+      msg_info_map_type& recv_msg_info_map = mesh_msg_item.second;
+
+      auto recv_iter = recv_msg_info_map.find(myrank);
+      if (recv_iter == recv_msg_info_map.end()) continue;
+
+      msg_info_map_type& send_msg_info_map = send_mesh_info_map.at(meshinfo);
+      auto send_iter = send_msg_info_map.find(myrank);
+      assert(send_iter != send_msg_info_map.end());
+
+      std::list<MeshData const*> const& msg_data_list = data_map.at(meshinfo);
+
+      for (MeshData const* msg_data : msg_data_list) {
+        comm.m_self_copy.add_variable(msg_data->ptr, msg_data->type);
+      }
+
+      // get allocator for mesh for use with indices
+      COMB::Allocator& mesh_aloc = msg_data_list.front()->aloc;
+
+      std::list<Box3d> const& recv_boxes = recv_iter->second.data_items.boxes;
+      assert(recv_boxes.size() == send_iter->second.data_items.boxes.size());
+
+      for (Box3d const& recv_box : recv_boxes) {
+        // the send box of the same neighbor direction
+        Box3d const& send_box = msg_map.at(recv_box);
+        if (send_box.sizes[0] != recv_box.sizes[0] ||
+            send_box.sizes[1] != recv_box.sizes[1] ||
+            send_box.sizes[2] != recv_box.sizes[2]) {
+          fgprintf(FileGroup::err_any, "Self copy send and recv boxes differ in extent.\n");
+          comm.comminfo.abort();
+        }
+        if (box_items) {
+          comm.m_self_copy.add_item(send_box.get_box_runs(), recv_box.get_box_runs());
+          continue;
+        }
+        IdxT size = recv_box.size();
+        LidxT* src_idxs = (LidxT*)mesh_aloc.allocate(sizeof(LidxT)*size);
+        LidxT* dst_idxs = (LidxT*)mesh_aloc.allocate(sizeof(LidxT)*size);
+        send_box.set_indices(con_many, src_idxs);
+        recv_box.set_indices(con_many, dst_idxs);
+        comm.m_self_copy.add_item(size, src_idxs, dst_idxs, mesh_aloc);
+      }
+
+      recv_msg_info_map.erase(recv_iter);
+      send_msg_info_map.erase(send_iter);
+    }
+  }
+
+#ifdef COMB_ENABLE_MPI
+  // mpi_type contexts have no copy kernels, their self messages are sent
+  template < typename comm_type >
+  void populate_self_copy(comm_type&,
+                          ExecContext<mpi_type_pol>&,
+                          mesh_info_map_type&,
+                          mesh_info_map_type&) const
+  {
+  }
+#endif
+
   template < typename comm_type, typename exec_policy, typename msg_group_type >
   void populate_msg_info(
       comm_type& comm,
@@ -421,43 +564,88 @@ private:
     COMB::ignore_unused(comm);
     using message_item_type = detail::MessageItem<exec_policy>;
 
+    if (index_runs_usable(con)) {
+
+      std::vector<LidxT> starts;
+      std::vector<IdxT> offsets{0};
+
+      for (Box3d const& msg_box : data_item.boxes) {
+
+        msg_box.append_index_runs(starts, offsets);
+
+        if (!combineable) {
+          add_index_runs_item<exec_policy>(msg_group, partner_rank, starts, offsets, &msg_box, mesh_aloc);
+          starts.clear();
+          offsets.resize(1);
+        }
+      }
+
+      if (combineable) {
+        Box3d const* msg_box = (data_item.boxes.size() == 1) ? &data_item.boxes.front() : nullptr;
+        add_index_runs_item<exec_policy>(msg_group, partner_rank, starts, offsets, msg_box, mesh_aloc);
+      }
+
+      return;
+    }
+
     IdxT combined_size = 0;
     IdxT combined_nbytes = 0;
     LidxT* combined_indices = nullptr;
     IdxT combined_offset = 0;
+    detail::ShapeClass combined_shape = detail::ShapeClass::mixed;
 
     if (combineable) {
       combined_size = data_item.total_size();
-      combined_nbytes = sizeof(DataT)*combined_size; // data nbytes
+      combined_nbytes = item_nbytes(combined_size, msg_group.m_zone_nbytes); // data nbytes
       combined_indices = (LidxT*)mesh_aloc.allocate(sizeof(LidxT)*combined_size);
+      if (!data_item.boxes.empty()) {
+        combined_shape = data_item.boxes.front().shape_class();
+      }
     }
 
     for (Box3d const& msg_box : data_item.boxes) {
 
-      if (!combineable) {
+      if (!combineable && comb_pack_mode() == PackMode::box) {
+
+        // fill item data
+        IdxT size = msg_box.size();
+        IdxT nbytes = item_nbytes(size, msg_group.m_zone_nbytes); // data nbytes
+
+        message_item_type item{size, nbytes, msg_box.get_box_runs(), mesh_aloc};
+        set_strided_box(item, &msg_box);
+
+        msg_group.add_message_item(partner_rank, std::move(item));
+
+      } else if (!combineable) {
 
         // fill item data
         IdxT size = msg_box.size();
-        IdxT nbytes = sizeof(DataT)*size; // data nbytes
+        IdxT nbytes = item_nbytes(size, msg_group.m_zone_nbytes); // data nbytes
         LidxT* indices = (LidxT*)mesh_aloc.allocate(sizeof(LidxT)*size);
         msg_box.set_indices(con, indices);
 
-        msg_group.add_message_item(
-            partner_rank,
-            message_item_type{size, nbytes, indices, mesh_aloc});
+        message_item_type item{size, nbytes, indices, mesh_aloc};
+        item.shape = msg_box.shape_class();
+        set_strided_box(item, &msg_box);
+
+        msg_group.add_message_item(partner_rank, std::move(item));
 
       } else {
 
         // append data
         msg_box.set_indices(con, combined_indices + combined_offset);
         combined_offset += msg_box.size();
+
+        combined_shape = detail::combine_shape_class(combined_shape, msg_box.shape_class());
       }
     }
 
     if (combineable) {
-      msg_group.add_message_item(
-          partner_rank,
-          message_item_type{combined_size, combined_nbytes, combined_indices, mesh_aloc});
+      message_item_type item{combined_size, combined_nbytes, combined_indices, mesh_aloc};
+      item.shape = combined_shape;
+      set_strided_box(item, (data_item.boxes.size() == 1) ? &data_item.boxes.front() : nullptr);
+
+      msg_group.add_message_item(partner_rank, std::move(item));
     }
   }
 
@@ -479,15 +667,20 @@ private:
 
     for (Box3d const& msg_box : data_item.boxes) {
 
-      // fill item data
+      // fill item data, one datatype per variable section
       IdxT size = msg_box.size();
-      MPI_Datatype mpi_type = msg_box.get_type_subarray();
-      detail::MPI::Type_commit(&mpi_type);
-      IdxT nbytes = detail::MPI::Pack_size(1, mpi_type, comm.con_comm.comm);
+      std::vector<MPI_Datatype> mpi_types;
+      IdxT nbytes = 0;
+      for (detail::var_section const& sec : msg_group.m_sections) {
+        MPI_Datatype mpi_type = msg_box.get_type_subarray(sec.type);
+        detail::MPI::Type_commit(&mpi_type);
+        nbytes += sec.num_vars * detail::MPI::Pack_size(1, mpi_type, comm.con_comm.comm);
+        mpi_types.emplace_back(mpi_type);
+      }
 
       msg_group.add_message_item(
           partner_rank,
-          message_item_type{size, nbytes, mpi_type});
+          message_item_type{size, nbytes, std::move(mpi_types)});
     }
   }
 #endif
@@ -559,9 +752,8 @@ private:
 
       // add variables for this MeshInfo
       for (MeshData const* msg_data : msg_data_list) {
-        DataT *data = msg_data->data();
-        msg_list.message_group_many.add_variable(data);
-        msg_list.message_group_few.add_variable(data);
+        msg_list.message_group_many.add_variable(msg_data->ptr, msg_data->type);
+        msg_list.message_group_few.add_variable(msg_data->ptr, msg_data->type);
       }
 
       // get allocator for mesh for use with indices
@@ -612,17 +804,20 @@ private:
 
   void print_msg_info(const char* name,
                       size_t nvars,
+                      IdxT zone_nbytes,
                       int partner_rank,
                       int msg_tag,
                       message_info_data_type const& data_item,
                       bool print_packing_sizes, bool print_message_sizes) const
   {
     size_t combined_size = data_item.total_size()*nvars;
-    size_t combined_nbytes = sizeof(DataT)*combined_size;
+    size_t combined_nbytes = item_nbytes(data_item.total_size(), zone_nbytes);
 
     const char* prefix = "";
 
-    if (print_message_sizes || print_packing_sizes) {
+    bool print_index_runs = comb_pack_mode() == PackMode::runs;
+
+    if (print_message_sizes || print_packing_sizes || print_index_runs) {
 
       fgprintf(FileGroup::proc, "%s%s: %4i partner %4i tag %9zu items %9zu bytes\n",
           prefix, name, partner_rank, msg_tag, combined_size, combined_nbytes);
@@ -637,12 +832,42 @@ private:
 
         // fill item data
         IdxT size = msg_box.size();
-        IdxT nbytes = sizeof(DataT)*size;
+        IdxT nbytes = item_nbytes(size, zone_nbytes);
 
-        fgprintf(FileGroup::proc, "%*s %4zu var%s %9zu items/var %9zu bytes/var\n",
+        fgprintf(FileGroup::proc, "%*s %4zu var%s %9zu items/var %9zu bytes\n",
             prefix_size, prefix, nvars, (nvars == 1) ? "" : "s", size, nbytes);
       }
     }
+
+    if (print_index_runs) {
+
+      // index memory used by the message as a list and as runs
+      bool combineable = comb_allow_per_message_pack_fusing();
+      size_t num_items = combineable ? 1 : data_item.num_boxes();
+      size_t num_runs = 0;
+
+      std::vector<LidxT> starts;
+      std::vector<IdxT> offsets{0};
+
+      for (Box3d const& msg_box : data_item.boxes) {
+
+        msg_box.append_index_runs(starts, offsets);
+
+        if (!combineable) {
+          num_runs += starts.size();
+          starts.clear();
+          offsets.resize(1);
+        }
+      }
+      num_runs += starts.size();
+
+      size_t list_nbytes = sizeof(LidxT)*data_item.total_size();
+      size_t runs_nbytes = sizeof(LidxT)*num_runs + sizeof(IdxT)*(num_runs + num_items);
+
+      fgprintf(FileGroup::proc, "%*s %9zu index runs %9zu bytes list %9zu bytes compression %.1fx\n",
+          prefix_size, prefix, num_runs, runs_nbytes, list_nbytes,
+          (runs_nbytes > 0) ? static_cast<double>(list_nbytes) / runs_nbytes : 1.0);
+    }
   }
 
   void print_mesh_info_map(mesh_info_map_type const& mesh_info_map,
@@ -664,11 +889,24 @@ private:
       // skip this MeshInfo if it isn't used
       if (msg_data_list.size() == 0) continue;
 
+      IdxT zone_nbytes = 0;
+      for (MeshData const* msg_data : msg_data_list) {
+        zone_nbytes += wire_elem_size(msg_data->type, comb_wire_precision());
+      }
+
       // add message and each box per message to the comm
       auto lambda = [&](message_info_type const& msginfo) {
 
+        // messages to this rank are listed once as a self copy
+        if (msginfo.partner_rank == myrank && comb_allow_self_copy()) {
+          if (strcmp(name, "send") == 0) {
+            print_msg_info("self", msg_data_list.size(), zone_nbytes, msginfo.partner_rank, msginfo.msg_tag, msginfo.data_items, print_packing_sizes, print_message_sizes);
+          }
+          return;
+        }
+
         // add a new message to the message group
-        print_msg_info(name, msg_data_list.size(), msginfo.partner_rank, msginfo.msg_tag, msginfo.data_items, print_packing_sizes, print_message_sizes);
+        print_msg_info(name, msg_data_list.size(), zone_nbytes, msginfo.partner_rank, msginfo.msg_tag, msginfo.data_items, print_packing_sizes, print_message_sizes);
       };
 
       // order messages (myrank-end), [begin-myrank)
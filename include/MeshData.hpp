@@ -25,11 +25,13 @@ struct MeshData
 {
   COMB::Allocator& aloc;
   MeshInfo const& info;
-  DataT* ptr;
+  ElemType type;
+  void* ptr;
 
-  MeshData(MeshInfo const& meshinfo, COMB::Allocator& aloc_)
+  MeshData(MeshInfo const& meshinfo, COMB::Allocator& aloc_, ElemType type_ = ElemType::f64)
     : aloc(aloc_)
     , info(meshinfo)
+    , type(type_)
     , ptr(nullptr)
   {
 
@@ -38,20 +40,26 @@ struct MeshData
   void allocate()
   {
     if (ptr == nullptr) {
-      ptr = (DataT*)aloc.allocate(info.totallen*sizeof(DataT));
+      ptr = aloc.allocate(nbytes());
     }
   }
 
+  IdxT nbytes() const
+  {
+    return info.totallen*elem_type_size(type);
+  }
+
   bool operator==(MeshData const& other) const
   {
     return aloc.name() == other.aloc.name() &&
            info == other.info &&
+           type == other.type &&
            ptr == other.ptr;
   }
 
-  DataT* data() const
+  ElemPtr data() const
   {
-    return ptr;
+    return ElemPtr{ptr, type};
   }
 
   void deallocate()
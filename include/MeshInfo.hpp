@@ -31,14 +31,18 @@ struct GlobalMeshInfo {
   int divisions[3];
   int periodic[3];
   IdxT ghost_widths[3];
+  // zones added to each row and rows added to each plane of the local
+  // meshes, negative to pad automatically
+  IdxT pads[2];
   IdxT* division_indices[3];
 
-  GlobalMeshInfo(IdxT sizes_[], IdxT num_divisions, int divisions_[], int periodic_[], IdxT ghost_widths_[])
+  GlobalMeshInfo(IdxT sizes_[], IdxT num_divisions, int divisions_[], int periodic_[], IdxT ghost_widths_[], IdxT pads_[])
     : sizes{sizes_[0], sizes_[1], sizes_[2]}
     , totalsize{sizes_[0] * sizes_[1] * sizes_[2]}
     , divisions{divisions_[0], divisions_[1], divisions_[2]}
     , periodic{periodic_[0] ? 1 : 0, periodic_[1] ? 1 : 0, periodic_[2] ? 1 : 0}
     , ghost_widths{ghost_widths_[0], ghost_widths_[1], ghost_widths_[2]}
+    , pads{pads_[0], pads_[1]}
     , division_indices{nullptr, nullptr, nullptr}
   {
     set_divisions(num_divisions);
@@ -155,6 +159,34 @@ struct GlobalMeshInfo {
     return division_indices[dim][coord] + idx_offset;
   }
 
+  // zones per row including padding,
+  // automatic padding makes long rows an odd number of 8 zone cache lines
+  IdxT padded_row_len(IdxT row_len) const
+  {
+    if (pads[0] >= 0) {
+      return row_len + pads[0];
+    } else if (row_len < 64) {
+      return row_len;
+    }
+    IdxT padded_len = (row_len + 7) / 8 * 8;
+    if (padded_len % 16 == 0) padded_len += 8;
+    return padded_len;
+  }
+
+  // rows per plane including padding,
+  // automatic padding makes planes not an even number of cache lines
+  // unless every row is
+  IdxT padded_plane_rows(IdxT row_stride, IdxT plane_rows) const
+  {
+    if (pads[1] >= 0) {
+      return plane_rows + pads[1];
+    }
+    IdxT padded_rows = plane_rows;
+    if (row_stride % 16 == 0) return padded_rows;
+    while ((row_stride * padded_rows) % 16 == 0) padded_rows += 1;
+    return padded_rows;
+  }
+
   bool operator==(GlobalMeshInfo const& other) const
   {
     if (this == &other) return true;
@@ -271,8 +303,8 @@ struct MeshInfo {
   IdxT size[3];
   IdxT totalsize;
   IdxT len[3];
-  IdxT totallen;
-  IdxT stride[3]; // stride[0] = 1
+  IdxT totallen; // including padding
+  IdxT stride[3]; // stride[0] = 1, stride[2] is a multiple of stride[1]
   IdxT ghost_widths[3];
   IdxT global_min[3];
   IdxT global_max[3];
@@ -300,12 +332,15 @@ struct MeshInfo {
     , len{ global_max_[0] - global_min_[0] + 2*ghost_widths_[0]
          , global_max_[1] - global_min_[1] + 2*ghost_widths_[1]
          , global_max_[2] - global_min_[2] + 2*ghost_widths_[2] }
-    , totallen{ (global_max_[0] - global_min_[0] + 2*ghost_widths_[0])
-              * (global_max_[1] - global_min_[1] + 2*ghost_widths_[1])
+    , totallen{ global_.padded_row_len(global_max_[0] - global_min_[0] + 2*ghost_widths_[0])
+              * global_.padded_plane_rows(global_.padded_row_len(global_max_[0] - global_min_[0] + 2*ghost_widths_[0]),
+                                          global_max_[1] - global_min_[1] + 2*ghost_widths_[1])
               * (global_max_[2] - global_min_[2] + 2*ghost_widths_[2]) }
     , stride{ 1
-            , global_max_[0] - global_min_[0] + 2*ghost_widths_[0]
-            , (global_max_[0] - global_min_[0] + 2*ghost_widths_[0]) * (global_max_[1] - global_min_[1] + 2*ghost_widths_[1]) }
+            , global_.padded_row_len(global_max_[0] - global_min_[0] + 2*ghost_widths_[0])
+            , global_.padded_row_len(global_max_[0] - global_min_[0] + 2*ghost_widths_[0])
+              * global_.padded_plane_rows(global_.padded_row_len(global_max_[0] - global_min_[0] + 2*ghost_widths_[0]),
+                                          global_max_[1] - global_min_[1] + 2*ghost_widths_[1]) }
     , ghost_widths{ ghost_widths_[0]
                   , ghost_widths_[1]
                   , ghost_widths_[2] }
@@ -21,6 +21,7 @@
 #include <type_traits>
 #include <list>
 #include <utility>
+#include <algorithm>
 
 #include "memory.hpp"
 #include "for_all.hpp"
@@ -49,10 +50,18 @@ struct MessageItemBase
 {
   IdxT size;
   IdxT nbytes;
+  ShapeClass shape;
+  // set for items of a single box whose zones are evenly strided runs
+  // in the mesh, these may be sent and received in place
+  bool strided;
+  box_runs strided_box;
 
   MessageItemBase(IdxT _size, IdxT _nbytes)
     : size(_size)
     , nbytes(_nbytes)
+    , shape(ShapeClass::mixed)
+    , strided(false)
+    , strided_box()
   { }
 
   MessageItemBase(MessageItemBase const&) = delete;
@@ -61,6 +70,9 @@ struct MessageItemBase
   MessageItemBase(MessageItemBase && o)
     : size(detail::exchange(o.size, 0))
     , nbytes(detail::exchange(o.nbytes, 0))
+    , shape(o.shape)
+    , strided(o.strided)
+    , strided_box(o.strided_box)
   { }
   MessageItemBase& operator=(MessageItemBase &&) = delete;
 };
@@ -68,44 +80,551 @@ struct MessageItemBase
 template < typename exec_policy >
 struct MessageItem : MessageItemBase
 {
+  // the zones are described by exactly one of indices, runs, or box,
+  // indices and runs.starts are nullptr when the item is described by box
   LidxT* indices;
+  index_runs runs;
+  box_runs box;
   COMB::Allocator& m_aloc;
 
   MessageItem(IdxT _size, IdxT _nbytes, LidxT* _indices, COMB::Allocator& _aloc)
     : MessageItemBase(_size, _nbytes)
     , indices(_indices)
+    , runs()
+    , box()
     , m_aloc(_aloc)
   { }
 
+  MessageItem(IdxT _size, IdxT _nbytes, index_runs const& _runs, COMB::Allocator& _aloc)
+    : MessageItemBase(_size, _nbytes)
+    , indices(nullptr)
+    , runs(_runs)
+    , box()
+    , m_aloc(_aloc)
+  {
+    assert(runs.size() == _size);
+  }
+
+  MessageItem(IdxT _size, IdxT _nbytes, box_runs const& _box, COMB::Allocator& _aloc)
+    : MessageItemBase(_size, _nbytes)
+    , indices(nullptr)
+    , runs()
+    , box(_box)
+    , m_aloc(_aloc)
+  {
+    assert(box.size() == _size);
+  }
+
   MessageItem(MessageItem const&) = delete;
   MessageItem& operator=(MessageItem const&) = delete;
 
   MessageItem(MessageItem && o)
     : MessageItemBase(std::move(o))
     , indices(detail::exchange(o.indices, nullptr))
+    , runs(detail::exchange(o.runs, index_runs{}))
+    , box(o.box)
     , m_aloc(o.m_aloc)
   { }
   MessageItem& operator=(MessageItem &&) = delete;
 
+  bool is_list() const
+  {
+    return indices != nullptr;
+  }
+
+  bool is_runs() const
+  {
+    return runs.starts != nullptr;
+  }
+
+  bool is_box() const
+  {
+    return indices == nullptr && !is_runs();
+  }
+
+  // length of the loop used to pack or unpack this item
+  IdxT loop_len() const
+  {
+    return is_box() ? box.num_rows : (is_runs() ? runs.num_runs : size);
+  }
+
+  // bytes of the index list or runs describing the zones
+  IdxT index_nbytes() const
+  {
+    return is_list() ? size*sizeof(LidxT)
+         : (is_runs() ? runs.num_runs*sizeof(LidxT) + (runs.num_runs+1)*sizeof(IdxT) : 0);
+  }
+
+  // bytes of the index list used by the default list pack mode
+  IdxT list_nbytes() const
+  {
+    return size*sizeof(LidxT);
+  }
+
   ~MessageItem()
   {
     if (indices) {
       m_aloc.deallocate(indices); indices = nullptr;
     }
+    if (runs.starts) {
+      m_aloc.deallocate(runs.starts); runs.starts = nullptr;
+      m_aloc.deallocate(runs.offsets); runs.offsets = nullptr;
+    }
+  }
+};
+
+// variables of one element type, the variables of a message group are kept
+// sorted by element type so each type is a contiguous section of the
+// variables and of each item's buffer
+struct var_section
+{
+  ElemType type;
+  WirePrecision wire; // precision in buffers, only reduced for double
+  IdxT first;
+  IdxT num_vars;
+  IdxT zone_offset; // bytes per zone of the sections before this one
+};
+
+template < typename context_type, typename exec_policy, typename T, typename B >
+inline void pack_item(context_type& con, MessageItem<exec_policy> const* item,
+                      T const* src, B* buf)
+{
+  if (item->is_box()) {
+    con.for_all(0, item->box.num_rows, make_box_packer(src, item->box, buf));
+  } else if (item->is_runs()) {
+    con.for_all(0, item->runs.num_runs, make_runs_packer(src, item->runs, buf));
+  } else {
+    con.for_all(0, item->size, make_copy_idxr_idxr(src, detail::indexer_list_idx{item->indices},
+                                                   buf, detail::indexer_idx{}));
+  }
+}
+
+template < typename context_type, typename exec_policy, typename T, typename B >
+inline void unpack_item(context_type& con, MessageItem<exec_policy> const* item,
+                        T* dst, B const* buf)
+{
+  if (item->is_box()) {
+    con.for_all(0, item->box.num_rows, make_box_unpacker(dst, item->box, buf));
+  } else if (item->is_runs()) {
+    con.for_all(0, item->runs.num_runs, make_runs_unpacker(dst, item->runs, buf));
+  } else {
+    con.for_all(0, item->size, make_copy_idxr_idxr(buf, detail::indexer_idx{},
+                                                   dst, detail::indexer_list_idx{item->indices}));
+  }
+}
+
+template < typename T, typename B, typename context_type, typename exec_policy >
+inline void pack_item_section(context_type& con, MessageItem<exec_policy> const* item,
+                              void* const* vars, IdxT num_vars, B* buf, BufferLayout layout)
+{
+  if (layout == BufferLayout::zone && item->is_list()) {
+    for (IdxT j = 0; j < num_vars; ++j) {
+      con.for_all(0, item->size, make_copy_idxr_idxr(static_cast<T const*>(vars[j]), detail::indexer_list_idx{item->indices},
+                                                     buf + j, detail::indexer_stride_idx{num_vars}));
+    }
+  } else {
+    for (IdxT j = 0; j < num_vars; ++j) {
+      pack_item(con, item, static_cast<T const*>(vars[j]), buf + j*item->size);
+    }
+  }
+}
+
+template < typename T, typename B, typename context_type, typename exec_policy >
+inline void unpack_item_section(context_type& con, MessageItem<exec_policy> const* item,
+                                void* const* vars, IdxT num_vars, B const* buf, BufferLayout layout)
+{
+  if (layout == BufferLayout::zone && item->is_list()) {
+    for (IdxT j = 0; j < num_vars; ++j) {
+      con.for_all(0, item->size, make_copy_idxr_idxr(buf + j, detail::indexer_stride_idx{num_vars},
+                                                     static_cast<T*>(vars[j]), detail::indexer_list_idx{item->indices}));
+    }
+  } else {
+    for (IdxT j = 0; j < num_vars; ++j) {
+      unpack_item(con, item, static_cast<T*>(vars[j]), buf + j*item->size);
+    }
+  }
+}
+
+// packs all variables of an item into buf one section at a time, the
+// variables of list items are interleaved by zone with the zone buffer layout
+template < typename context_type, typename exec_policy >
+inline void pack_item_vars(context_type& con, MessageItem<exec_policy> const* item,
+                           std::vector<var_section> const& sections, std::vector<void*> const& vars,
+                           char* buf, BufferLayout layout)
+{
+  for (var_section const& sec : sections) {
+    void* const* sec_vars = &vars[sec.first];
+    char* sec_buf = buf + item->size*sec.zone_offset;
+    switch (sec.type) {
+      case ElemType::f64:
+        switch (sec.wire) {
+          case WirePrecision::full:
+            pack_item_section<double>(con, item, sec_vars, sec.num_vars, reinterpret_cast<double*>(sec_buf), layout); break;
+          case WirePrecision::f32:
+            pack_item_section<double>(con, item, sec_vars, sec.num_vars, reinterpret_cast<float*>(sec_buf), layout); break;
+          case WirePrecision::bf16:
+            pack_item_section<double>(con, item, sec_vars, sec.num_vars, reinterpret_cast<detail::bf16*>(sec_buf), layout); break;
+        }
+        break;
+      case ElemType::f32:
+        pack_item_section<float>(con, item, sec_vars, sec.num_vars, reinterpret_cast<float*>(sec_buf), layout); break;
+      case ElemType::i32:
+        pack_item_section<int>(con, item, sec_vars, sec.num_vars, reinterpret_cast<int*>(sec_buf), layout); break;
+    }
+  }
+}
+
+template < typename context_type, typename exec_policy >
+inline void unpack_item_vars(context_type& con, MessageItem<exec_policy> const* item,
+                             std::vector<var_section> const& sections, std::vector<void*> const& vars,
+                             char const* buf, BufferLayout layout)
+{
+  for (var_section const& sec : sections) {
+    void* const* sec_vars = &vars[sec.first];
+    char const* sec_buf = buf + item->size*sec.zone_offset;
+    switch (sec.type) {
+      case ElemType::f64:
+        switch (sec.wire) {
+          case WirePrecision::full:
+            unpack_item_section<double>(con, item, sec_vars, sec.num_vars, reinterpret_cast<double const*>(sec_buf), layout); break;
+          case WirePrecision::f32:
+            unpack_item_section<double>(con, item, sec_vars, sec.num_vars, reinterpret_cast<float const*>(sec_buf), layout); break;
+          case WirePrecision::bf16:
+            unpack_item_section<double>(con, item, sec_vars, sec.num_vars, reinterpret_cast<detail::bf16 const*>(sec_buf), layout); break;
+        }
+        break;
+      case ElemType::f32:
+        unpack_item_section<float>(con, item, sec_vars, sec.num_vars, reinterpret_cast<float const*>(sec_buf), layout); break;
+      case ElemType::i32:
+        unpack_item_section<int>(con, item, sec_vars, sec.num_vars, reinterpret_cast<int const*>(sec_buf), layout); break;
+    }
+  }
+}
+
+// all non-empty items in a fused loop are described the same way,
+// empty items do no work with any of the fused kernels
+inline PackMode fused_pack_mode(IdxT num_fused, LidxT const** idxs,
+                                index_runs const* runs, IdxT const* lens)
+{
+  for (IdxT k = 0; k < num_fused; ++k) {
+    if (lens[k] > 0) {
+      return (idxs[k] != nullptr) ? PackMode::list
+           : ((runs[k].starts != nullptr) ? PackMode::runs : PackMode::box);
+    }
+  }
+  return PackMode::list;
+}
+
+// variable counts with pack kernels specialised on the number of variables
+inline bool specialised_num_vars(IdxT num_vars)
+{
+  return num_vars == 1 || num_vars == 2 || num_vars == 3 ||
+         num_vars == 4 || num_vars == 8;
+}
+
+// name of the kernel used to pack or unpack items in list mode
+inline const char* fused_kernel_str(std::vector<var_section> const& sections)
+{
+  bool specialised = true;
+  for (var_section const& sec : sections) {
+    specialised = specialised && specialised_num_vars(sec.num_vars);
+  }
+  return specialised ? "specialised" : "generic";
+}
+
+template < typename T, typename B, IdxT num_vars, typename context_type >
+inline void fused_pack_vars(context_type& con, IdxT num_fused, IdxT num_corners, IdxT len_hint,
+                            void const* const* srcs, char* const* bufs,
+                            LidxT const** idxs, IdxT const* lens, IdxT zone_offset,
+                            bool interleaved)
+{
+  if (num_corners > 0) {
+    con.fused(num_corners, 1, 1, fused_packer_vars<T, num_vars, true, B>(srcs, bufs, idxs, lens, zone_offset, interleaved));
+  }
+  if (num_fused > num_corners) {
+    con.fused(num_fused - num_corners, 1, len_hint, fused_packer_vars<T, num_vars, false, B>(srcs, bufs + num_corners, idxs + num_corners, lens + num_corners, zone_offset, interleaved));
+  }
+}
+
+template < typename T, typename B, IdxT num_vars, typename context_type >
+inline void fused_unpack_vars(context_type& con, IdxT num_fused, IdxT num_corners, IdxT len_hint,
+                              void* const* dsts, char const* const* bufs,
+                              LidxT const** idxs, IdxT const* lens, IdxT zone_offset,
+                              bool interleaved)
+{
+  if (num_corners > 0) {
+    con.fused(num_corners, 1, 1, fused_unpacker_vars<T, num_vars, true, B>(dsts, bufs, idxs, lens, zone_offset, interleaved));
+  }
+  if (num_fused > num_corners) {
+    con.fused(num_fused - num_corners, 1, len_hint, fused_unpacker_vars<T, num_vars, false, B>(dsts, bufs + num_corners, idxs + num_corners, lens + num_corners, zone_offset, interleaved));
+  }
+}
+
+// list items use kernels specialised on the number of variables, the first
+// num_corners items are corners packed whole by one call each and the rest
+// use the per zone kernel, the buffer layout only applies to list items
+template < typename T, typename B, typename context_type >
+inline void fused_pack_section(context_type& con, IdxT num_fused, IdxT num_corners, IdxT num_vars, IdxT len_hint,
+                               void const* const* srcs, char* const* bufs,
+                               LidxT const** idxs, box_runs const* boxs,
+                               index_runs const* runs, IdxT const* lens, IdxT zone_offset,
+                               PackMode mode, bool interleaved)
+{
+  switch (mode) {
+    case PackMode::list:
+      switch (num_vars) {
+        case 1: fused_pack_vars<T, B, 1>(con, num_fused, num_corners, len_hint, srcs, bufs, idxs, lens, zone_offset, interleaved); break;
+        case 2: fused_pack_vars<T, B, 2>(con, num_fused, num_corners, len_hint, srcs, bufs, idxs, lens, zone_offset, interleaved); break;
+        case 3: fused_pack_vars<T, B, 3>(con, num_fused, num_corners, len_hint, srcs, bufs, idxs, lens, zone_offset, interleaved); break;
+        case 4: fused_pack_vars<T, B, 4>(con, num_fused, num_corners, len_hint, srcs, bufs, idxs, lens, zone_offset, interleaved); break;
+        case 8: fused_pack_vars<T, B, 8>(con, num_fused, num_corners, len_hint, srcs, bufs, idxs, lens, zone_offset, interleaved); break;
+        default:
+          if (interleaved) {
+            con.fused(num_fused, 1, len_hint, fused_interleaved_packer<T, B>(srcs, bufs, idxs, lens, num_vars, zone_offset));
+          } else {
+            con.fused(num_fused, num_vars, len_hint, fused_packer<T, B>(srcs, bufs, idxs, lens, zone_offset));
+          }
+          break;
+      }
+      break;
+    case PackMode::box:
+      con.fused(num_fused, num_vars, len_hint, fused_box_packer<T, B>(srcs, bufs, boxs, zone_offset)); break;
+    case PackMode::runs:
+      con.fused(num_fused, num_vars, len_hint, fused_runs_packer<T, B>(srcs, bufs, runs, zone_offset)); break;
+  }
+}
+
+template < typename T, typename B, typename context_type >
+inline void fused_unpack_section(context_type& con, IdxT num_fused, IdxT num_corners, IdxT num_vars, IdxT len_hint,
+                                 void* const* dsts, char const* const* bufs,
+                                 LidxT const** idxs, box_runs const* boxs,
+                                 index_runs const* runs, IdxT const* lens, IdxT zone_offset,
+                                 PackMode mode, bool interleaved)
+{
+  switch (mode) {
+    case PackMode::list:
+      switch (num_vars) {
+        case 1: fused_unpack_vars<T, B, 1>(con, num_fused, num_corners, len_hint, dsts, bufs, idxs, lens, zone_offset, interleaved); break;
+        case 2: fused_unpack_vars<T, B, 2>(con, num_fused, num_corners, len_hint, dsts, bufs, idxs, lens, zone_offset, interleaved); break;
+        case 3: fused_unpack_vars<T, B, 3>(con, num_fused, num_corners, len_hint, dsts, bufs, idxs, lens, zone_offset, interleaved); break;
+        case 4: fused_unpack_vars<T, B, 4>(con, num_fused, num_corners, len_hint, dsts, bufs, idxs, lens, zone_offset, interleaved); break;
+        case 8: fused_unpack_vars<T, B, 8>(con, num_fused, num_corners, len_hint, dsts, bufs, idxs, lens, zone_offset, interleaved); break;
+        default:
+          if (interleaved) {
+            con.fused(num_fused, 1, len_hint, fused_interleaved_unpacker<T, B>(dsts, bufs, idxs, lens, num_vars, zone_offset));
+          } else {
+            con.fused(num_fused, num_vars, len_hint, fused_unpacker<T, B>(dsts, bufs, idxs, lens, zone_offset));
+          }
+          break;
+      }
+      break;
+    case PackMode::box:
+      con.fused(num_fused, num_vars, len_hint, fused_box_unpacker<T, B>(dsts, bufs, boxs, zone_offset)); break;
+    case PackMode::runs:
+      con.fused(num_fused, num_vars, len_hint, fused_runs_unpacker<T, B>(dsts, bufs, runs, zone_offset)); break;
+  }
+}
+
+// per variable and per item arrays of the fused pack or unpack loops of a
+// message group, each loop sets the items it runs starting at pos
+template < MessageBase::Kind kind >
+struct FusedVars
+{
+  using var_type = typename std::conditional<kind == MessageBase::Kind::send,
+                                             void const*, void*>::type;
+  using buf_type = typename std::conditional<kind == MessageBase::Kind::send,
+                                             char*, char const*>::type;
+
+  var_type*     vars = nullptr;
+
+  buf_type*     bufs = nullptr;
+  LidxT const** idxs = nullptr;
+  box_runs*     boxs = nullptr;
+  index_runs*   runs = nullptr;
+  IdxT*         lens = nullptr;
+  ShapeClass*   shapes = nullptr;
+  IdxT pos = 0;
+  COMB::Allocator* aloc = nullptr;
+
+  FusedVars() = default;
+  FusedVars(FusedVars const&) = delete;
+  FusedVars& operator=(FusedVars const&) = delete;
+
+  bool allocated() const
+  {
+    return vars != nullptr;
+  }
+
+  void allocate(COMB::Allocator& aloc_, std::vector<void*> const& variables, IdxT num_items)
+  {
+    assert(!allocated());
+    aloc = &aloc_;
+
+    // allocate per variable vars
+    IdxT num_vars = variables.size();
+    vars = (var_type*)aloc->allocate(num_vars*sizeof(var_type));
+
+    // variable vars initialized here
+    for (IdxT i = 0; i < num_vars; ++i) {
+      vars[i] = variables[i];
+    }
+
+    // allocate per item vars
+    bufs = (buf_type*)     aloc->allocate(num_items*sizeof(buf_type));
+    idxs = (LidxT const**) aloc->allocate(num_items*sizeof(LidxT const*));
+    boxs = (box_runs*)     aloc->allocate(num_items*sizeof(box_runs));
+    runs = (index_runs*)   aloc->allocate(num_items*sizeof(index_runs));
+    lens = (IdxT*)         aloc->allocate(num_items*sizeof(IdxT));
+    shapes = (ShapeClass*) aloc->allocate(num_items*sizeof(ShapeClass));
+
+    // item vars initialized by set_item
+  }
+
+  // sets item k of the loop starting at pos
+  template < typename item_type >
+  void set_item(IdxT k, buf_type buf, item_type const* item)
+  {
+    bufs[pos + k] = buf;
+    idxs[pos + k] = item->indices;
+    boxs[pos + k] = item->box;
+    runs[pos + k] = item->runs;
+    lens[pos + k] = item->size;
+    shapes[pos + k] = item->shape;
+  }
+
+  // moves the corner items of the loop starting at pos in front of the
+  // others so they run in their own kernel, returns the number of corners
+  IdxT group_corners(IdxT num_items)
+  {
+    IdxT num_corners = 0;
+    for (IdxT k = pos; k < pos + num_items; ++k) {
+      if (shapes[k] != ShapeClass::corner) continue;
+      IdxT c = pos + num_corners++;
+      if (c == k) continue;
+      std::swap(bufs[c], bufs[k]);
+      std::swap(idxs[c], idxs[k]);
+      std::swap(boxs[c], boxs[k]);
+      std::swap(runs[c], runs[k]);
+      std::swap(lens[c], lens[k]);
+      std::swap(shapes[c], shapes[k]);
+    }
+    return num_corners;
+  }
+
+  void deallocate()
+  {
+    // deallocate per variable vars
+    aloc->deallocate(vars); vars = nullptr;
+
+    // deallocate per item vars
+    aloc->deallocate(bufs); bufs = nullptr;
+    aloc->deallocate(idxs); idxs = nullptr;
+    aloc->deallocate(boxs); boxs = nullptr;
+    aloc->deallocate(runs); runs = nullptr;
+    aloc->deallocate(lens); lens = nullptr;
+    aloc->deallocate(shapes); shapes = nullptr;
+  }
+
+  ~FusedVars()
+  {
+    if (allocated()) {
+      deallocate();
+    }
   }
 };
 
+// packs the num_fused items set at the position of fused one section at a
+// time, list items are grouped so the corners are packed whole
+template < typename context_type >
+inline void fused_pack(context_type& con, FusedVars<MessageBase::Kind::send>& fused, IdxT num_fused,
+                       std::vector<var_section> const& sections, IdxT len_hint,
+                       BufferLayout layout)
+{
+  void const* const* srcs = fused.vars;
+  char* const*       bufs = fused.bufs + fused.pos;
+  LidxT const**      idxs = fused.idxs + fused.pos;
+  box_runs const*    boxs = fused.boxs + fused.pos;
+  index_runs const*  runs = fused.runs + fused.pos;
+  IdxT const*        lens = fused.lens + fused.pos;
+  PackMode mode = fused_pack_mode(num_fused, idxs, runs, lens);
+  IdxT num_corners = (mode == PackMode::list) ? fused.group_corners(num_fused) : 0;
+  bool interleaved = (layout == BufferLayout::zone);
+  for (var_section const& sec : sections) {
+    switch (sec.type) {
+      case ElemType::f64:
+        switch (sec.wire) {
+          case WirePrecision::full:
+            fused_pack_section<double, double>(con, num_fused, num_corners, sec.num_vars, len_hint, srcs + sec.first, bufs,
+                                               idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+          case WirePrecision::f32:
+            fused_pack_section<double, float>(con, num_fused, num_corners, sec.num_vars, len_hint, srcs + sec.first, bufs,
+                                              idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+          case WirePrecision::bf16:
+            fused_pack_section<double, detail::bf16>(con, num_fused, num_corners, sec.num_vars, len_hint, srcs + sec.first, bufs,
+                                                     idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+        }
+        break;
+      case ElemType::f32:
+        fused_pack_section<float, float>(con, num_fused, num_corners, sec.num_vars, len_hint, srcs + sec.first, bufs,
+                                         idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+      case ElemType::i32:
+        fused_pack_section<int, int>(con, num_fused, num_corners, sec.num_vars, len_hint, srcs + sec.first, bufs,
+                                     idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+    }
+  }
+}
+
+template < typename context_type >
+inline void fused_unpack(context_type& con, FusedVars<MessageBase::Kind::recv>& fused, IdxT num_fused,
+                         std::vector<var_section> const& sections, IdxT len_hint,
+                         BufferLayout layout)
+{
+  void* const*        dsts = fused.vars;
+  char const* const*  bufs = fused.bufs + fused.pos;
+  LidxT const**       idxs = fused.idxs + fused.pos;
+  box_runs const*     boxs = fused.boxs + fused.pos;
+  index_runs const*   runs = fused.runs + fused.pos;
+  IdxT const*         lens = fused.lens + fused.pos;
+  PackMode mode = fused_pack_mode(num_fused, idxs, runs, lens);
+  IdxT num_corners = (mode == PackMode::list) ? fused.group_corners(num_fused) : 0;
+  bool interleaved = (layout == BufferLayout::zone);
+  for (var_section const& sec : sections) {
+    switch (sec.type) {
+      case ElemType::f64:
+        switch (sec.wire) {
+          case WirePrecision::full:
+            fused_unpack_section<double, double>(con, num_fused, num_corners, sec.num_vars, len_hint, dsts + sec.first, bufs,
+                                                 idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+          case WirePrecision::f32:
+            fused_unpack_section<double, float>(con, num_fused, num_corners, sec.num_vars, len_hint, dsts + sec.first, bufs,
+                                                idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+          case WirePrecision::bf16:
+            fused_unpack_section<double, detail::bf16>(con, num_fused, num_corners, sec.num_vars, len_hint, dsts + sec.first, bufs,
+                                                       idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+        }
+        break;
+      case ElemType::f32:
+        fused_unpack_section<float, float>(con, num_fused, num_corners, sec.num_vars, len_hint, dsts + sec.first, bufs,
+                                           idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+      case ElemType::i32:
+        fused_unpack_section<int, int>(con, num_fused, num_corners, sec.num_vars, len_hint, dsts + sec.first, bufs,
+                                       idxs, boxs, runs, lens, sec.zone_offset, mode, interleaved); break;
+    }
+  }
+}
+
 #ifdef COMB_ENABLE_MPI
 
 template < >
 struct MessageItem<mpi_type_pol> : MessageItemBase
 {
-  MPI_Datatype mpi_type;
+  // one datatype per variable section
+  std::vector<MPI_Datatype> mpi_types;
   int packed_nbytes;
 
-  MessageItem(IdxT _size, IdxT _nbytes, MPI_Datatype _mpi_type)
+  MessageItem(IdxT _size, IdxT _nbytes, std::vector<MPI_Datatype>&& _mpi_types)
     : MessageItemBase(_size, _nbytes)
-    , mpi_type(_mpi_type)
+    , mpi_types(std::move(_mpi_types))
     , packed_nbytes(0)
   { }
 
@@ -114,15 +633,28 @@ struct MessageItem<mpi_type_pol> : MessageItemBase
 
   MessageItem(MessageItem && o)
     : MessageItemBase(std::move(o))
-    , mpi_type(detail::exchange(o.mpi_type, MPI_DATATYPE_NULL))
+    , mpi_types(std::move(o.mpi_types))
     , packed_nbytes(detail::exchange(o.packed_nbytes, 0))
   { }
   MessageItem& operator=(MessageItem &&) = delete;
 
+  // zones are described by datatypes
+  IdxT index_nbytes() const
+  {
+    return 0;
+  }
+
+  IdxT list_nbytes() const
+  {
+    return 0;
+  }
+
   ~MessageItem()
   {
-    if (mpi_type != MPI_DATATYPE_NULL) {
-      detail::MPI::Type_free(&mpi_type); mpi_type = MPI_DATATYPE_NULL;
+    for (MPI_Datatype& mpi_type : mpi_types) {
+      if (mpi_type != MPI_DATATYPE_NULL) {
+        detail::MPI::Type_free(&mpi_type); mpi_type = MPI_DATATYPE_NULL;
+      }
     }
   }
 };
@@ -193,6 +725,73 @@ struct MessageInterface
   }
 };
 
+// messages sent or received in place in the mesh have no buffer
+template < typename message_type >
+inline bool message_has_buffer(message_type const&)
+{
+  return true;
+}
+
+// called once the buffers of the messages of a comm have the addresses they
+// keep across cycles, policies that expose them to partners overload it
+template < typename communicator_type, typename send_message_type, typename recv_message_type >
+inline void connect_buffers(communicator_type&,
+                            std::vector<send_message_type*> const&,
+                            std::vector<recv_message_type*> const&)
+{
+}
+
+// memory of the slab holding the recv buffers of a comm with slab buffers,
+// policies whose partners reach into the slab specialize it
+template < typename policy_comm >
+struct recv_slab
+{
+  static void* allocate(CommContext<policy_comm>&, COMB::Allocator& aloc, IdxT nbytes)
+  {
+    return aloc.allocate(nbytes);
+  }
+
+  static void deallocate(CommContext<policy_comm>&, COMB::Allocator& aloc, void* ptr)
+  {
+    aloc.deallocate(ptr);
+  }
+};
+
+// synchronization every rank of a comm takes part in once per exchange,
+// opened before the recvs are posted and closed before they are waited on,
+// policies whose synchronization is collective specialize it
+template < typename policy_comm >
+struct exchange_epoch
+{
+  static void open(CommContext<policy_comm>&) { }
+  static void close(CommContext<policy_comm>&) { }
+};
+
+// policies that pack with MPI datatypes send variables at full precision
+template < typename exec_policy >
+struct converts_wire_precision : std::true_type { };
+
+#ifdef COMB_ENABLE_MPI
+template < >
+struct converts_wire_precision<mpi_type_pol> : std::false_type { };
+#endif
+
+// policies that pack on the host, their message buffers can be compressed
+// and messages can be sent in place in the mesh
+template < typename exec_policy >
+struct packs_on_host : std::false_type { };
+
+template < >
+struct packs_on_host<seq_pol> : std::true_type { };
+
+#ifdef COMB_ENABLE_OPENMP
+template < >
+struct packs_on_host<omp_pol> : std::true_type { };
+#endif
+
+template < >
+struct packs_on_host<simd_pol> : std::true_type { };
+
 template < MessageBase::Kind kind, typename comm_policy, typename exec_policy >
 struct MessageGroupInterface
 {
@@ -218,16 +817,40 @@ struct MessageGroupInterface
   std::vector<component_type> m_components;
   std::vector<group_type> m_groups;
 
-  std::vector<DataT*> m_variables;
+  // variables sorted by element type
+  std::vector<void*> m_variables;
+  std::vector<ElemType> m_var_types;
+  std::vector<var_section> m_sections;
+  IdxT m_zone_nbytes = 0;
 
   std::vector<int> m_item_partner_ranks;
   std::vector<message_item_type> m_items;
 
+  BufferLayout m_layout;
+
+  WirePrecision m_wire;
+
   COMB::Allocator& m_aloc;
 
+  // buffers allocated in Comm::finish_populating are kept by deallocate
+  // and freed when the group is destroyed
+  bool m_persistent_buffers = false;
+
+  // persistent buffers placed in a slab owned by the comm, not freed here
+  bool m_planned_buffers = false;
+
+  // arena set in Comm::finish_populating that non persistent groups take
+  // their fused pack arrays from, reset by the comm after each exchange
+  COMB::ArenaAllocator* m_util_arena = nullptr;
+
+  // arrays of the fused pack loops
+  FusedVars<kind> m_fused;
+
 
   MessageGroupInterface(COMB::Allocator& aloc_)
-    : m_aloc(aloc_)
+    : m_layout(comb_buffer_layout())
+    , m_wire(converts_wire_precision<exec_policy>::value ? comb_wire_precision() : WirePrecision::full)
+    , m_aloc(aloc_)
   {
 
   }
@@ -241,9 +864,33 @@ struct MessageGroupInterface
     m_groups.emplace_back( m_contexts.back().create_group() );
   }
 
-  void add_variable(DataT *data)
+  void add_variable(void* data, ElemType type)
   {
-    m_variables.emplace_back(data);
+    // keep variables of the same type together, larger types first
+    auto pos = std::upper_bound(m_var_types.begin(), m_var_types.end(), type);
+    m_variables.insert(m_variables.begin() + (pos - m_var_types.begin()), data);
+    m_var_types.insert(pos, type);
+
+    m_sections.clear();
+    IdxT num_vars = m_var_types.size();
+    for (IdxT i = 0; i < num_vars; ++i) {
+      if (m_sections.empty() || m_sections.back().type != m_var_types[i]) {
+        WirePrecision wire = (m_var_types[i] == ElemType::f64) ? m_wire : WirePrecision::full;
+        m_sections.push_back(var_section{m_var_types[i], wire, i, 0, 0});
+      }
+      m_sections.back().num_vars += 1;
+    }
+
+    // keep sections aligned by placing larger buffer elements first
+    std::stable_sort(m_sections.begin(), m_sections.end(),
+        [](var_section const& a, var_section const& b) {
+      return wire_elem_size(a.type, a.wire) > wire_elem_size(b.type, b.wire);
+    });
+    m_zone_nbytes = 0;
+    for (var_section& sec : m_sections) {
+      sec.zone_offset = m_zone_nbytes;
+      m_zone_nbytes += sec.num_vars * wire_elem_size(sec.type, sec.wire);
+    }
   }
 
   void add_message_item(int partner_rank, message_item_type&& item)
@@ -257,6 +904,7 @@ struct MessageGroupInterface
   {
     // add items to messages
     IdxT numItems = m_items.size();
+    IdxT num_corner_items = 0;
     for (IdxT i = 0; i < numItems; ++i) {
 
       int partner_rank = m_item_partner_ranks[i];
@@ -271,12 +919,68 @@ struct MessageGroupInterface
         }
       }
       assert(found);
+
+      if (item.shape == ShapeClass::corner) {
+        num_corner_items += 1;
+      }
     }
     m_item_partner_ranks.clear();
+
+    if (!messages.empty()) {
+      IdxT num_vars = m_variables.size();
+      const char* kernel = comb_allow_pack_loop_fusion()
+                           ? fused_kernel_str(m_sections) : "generic";
+      char types[256] = "";
+      int types_len = 0;
+      for (var_section const& sec : m_sections) {
+        types_len += snprintf(types + types_len, 256 - types_len, "%s%i %s",
+                              (types_len > 0) ? "," : "", sec.num_vars, elem_type_str(sec.type));
+        if (types_len >= 256) break;
+      }
+      fgprintf(FileGroup::proc, "Message group %s %s vars %i (%s) corner items %i of %i layout %s wire %s fused pack kernel %s\n",
+                                (kind == MessageBase::Kind::send) ? "send" : "recv",
+                                exec_policy::get_name(), num_vars, types,
+                                num_corner_items, numItems, buffer_layout_str(m_layout),
+                                wire_precision_str(m_wire), kernel);
+    }
+  }
+
+  // allocates the fused pack arrays when pack loop fusion is allowed, from
+  // the util arena unless they are kept with persistent buffers
+  void allocate_fused_vars(context_type& con)
+  {
+    if (comb_allow_pack_loop_fusion() && !m_fused.allocated()) {
+      COMB::Allocator& util_aloc = (m_util_arena != nullptr && !m_persistent_buffers)
+                                 ? static_cast<COMB::Allocator&>(*m_util_arena) : con.util_aloc;
+      m_fused.allocate(util_aloc, m_variables, m_items.size());
+    }
+  }
+
+  // resets the fused pack arrays once all items are done, the arrays are
+  // kept with persistent buffers
+  void deallocate_fused_vars()
+  {
+    if (comb_allow_pack_loop_fusion() && m_fused.allocated() && m_fused.pos == static_cast<IdxT>(m_items.size())) {
+
+      if (!m_persistent_buffers) {
+        m_fused.deallocate();
+      }
+
+      // reset pos
+      m_fused.pos = 0;
+    }
   }
 
   ~MessageGroupInterface()
   {
+    if (m_persistent_buffers && !m_planned_buffers) {
+      for (message_type& msg : messages) {
+        if (msg.buf != nullptr) {
+          m_aloc.deallocate(msg.buf);
+          msg.buf = nullptr;
+        }
+      }
+    }
     IdxT numMessages = messages.size();
     for(IdxT i = 0; i < numMessages; i++) {
       m_contexts[i].destroyEvent(m_events[i]);
@@ -290,6 +994,216 @@ struct MessageGroupInterface
   }
 };
 
+// messages whose partner is this rank, each pair of send and recv boxes is
+// an item whose send zones are copied directly to its recv zones in the
+// mesh, with one fused kernel per element type instead of packing,
+// messaging, and unpacking, items are described by index lists or by box
+template < typename exec_policy >
+struct SelfCopy
+{
+  using context_type = ExecContext<exec_policy>;
+
+  std::vector<void*> m_variables;
+  std::vector<ElemType> m_var_types;
+  std::vector<var_section> m_sections;
+
+  // index lists of the send and recv zones of each list item
+  std::vector<LidxT*> m_src_idxs;
+  std::vector<LidxT*> m_dst_idxs;
+  // send and recv boxes of each box item
+  std::vector<box_runs> m_src_boxs;
+  std::vector<box_runs> m_dst_boxs;
+  std::vector<IdxT> m_lens;
+  IdxT m_total_len = 0;
+
+  // fused kernel arrays in util memory, allocated in finalize
+  void** m_vars = nullptr;
+  LidxT const** m_srcs = nullptr;
+  LidxT const** m_dsts = nullptr;
+  IdxT* m_fused_lens = nullptr;
+  box_runs* m_fused_src_boxs = nullptr;
+  box_runs* m_fused_dst_boxs = nullptr;
+  COMB::Allocator* m_util_aloc = nullptr;
+
+  COMB::Allocator* m_aloc = nullptr;
+
+  bool empty() const
+  {
+    return m_lens.empty();
+  }
+
+  bool box_items() const
+  {
+    return !m_src_boxs.empty();
+  }
+
+  // bytes of the send and recv index lists
+  IdxT index_nbytes() const
+  {
+    return box_items() ? 0 : list_nbytes();
+  }
+
+  // bytes of the index lists used by the default list pack mode
+  IdxT list_nbytes() const
+  {
+    return 2*m_total_len*sizeof(LidxT);
+  }
+
+  void add_variable(void* data, ElemType type)
+  {
+    // keep variables of the same type together
+    auto pos = std::upper_bound(m_var_types.begin(), m_var_types.end(), type);
+    m_variables.insert(m_variables.begin() + (pos - m_var_types.begin()), data);
+    m_var_types.insert(pos, type);
+
+    m_sections.clear();
+    IdxT num_vars = m_var_types.size();
+    for (IdxT i = 0; i < num_vars; ++i) {
+      if (m_sections.empty() || m_sections.back().type != m_var_types[i]) {
+        m_sections.push_back(var_section{m_var_types[i], WirePrecision::full, i, 0, 0});
+      }
+      m_sections.back().num_vars += 1;
+    }
+  }
+
+  // takes the index lists allocated from aloc
+  void add_item(IdxT len, LidxT* src_idxs, LidxT* dst_idxs, COMB::Allocator& aloc)
+  {
+    m_aloc = &aloc;
+    m_src_idxs.emplace_back(src_idxs);
+    m_dst_idxs.emplace_back(dst_idxs);
+    m_lens.emplace_back(len);
+    m_total_len += len;
+  }
+
+  // boxes of the same extents have the same rows and runs
+  void add_item(box_runs const& src_box, box_runs const& dst_box)
+  {
+    assert(src_box.run_len  == dst_box.run_len &&
+           src_box.row_runs == dst_box.row_runs &&
+           src_box.num_rows == dst_box.num_rows);
+    assert(m_src_idxs.empty());
+    m_src_boxs.emplace_back(src_box);
+    m_dst_boxs.emplace_back(dst_box);
+    m_lens.emplace_back(src_box.size());
+    m_total_len += src_box.size();
+  }
+
+  void finalize(context_type& con)
+  {
+    if (empty()) return;
+
+    m_util_aloc = &con.util_aloc;
+
+    IdxT num_vars = m_variables.size();
+    IdxT num_items = m_lens.size();
+    m_vars = (void**)m_util_aloc->allocate(num_vars*sizeof(void*));
+    for (IdxT j = 0; j < num_vars; ++j) {
+      m_vars[j] = m_variables[j];
+    }
+    if (box_items()) {
+      m_fused_src_boxs = (box_runs*)m_util_aloc->allocate(num_items*sizeof(box_runs));
+      m_fused_dst_boxs = (box_runs*)m_util_aloc->allocate(num_items*sizeof(box_runs));
+      for (IdxT k = 0; k < num_items; ++k) {
+        m_fused_src_boxs[k] = m_src_boxs[k];
+        m_fused_dst_boxs[k] = m_dst_boxs[k];
+      }
+    } else {
+      m_srcs = (LidxT const**)m_util_aloc->allocate(num_items*sizeof(LidxT const*));
+      m_dsts = (LidxT const**)m_util_aloc->allocate(num_items*sizeof(LidxT const*));
+      m_fused_lens = (IdxT*)m_util_aloc->allocate(num_items*sizeof(IdxT));
+      for (IdxT k = 0; k < num_items; ++k) {
+        m_srcs[k] = m_src_idxs[k];
+        m_dsts[k] = m_dst_idxs[k];
+        m_fused_lens[k] = m_lens[k];
+      }
+    }
+
+    fgprintf(FileGroup::proc, "Self copy %s %s vars %i items %i zones %i\n",
+                              exec_policy::get_name(), box_items() ? "box" : "list",
+                              static_cast<int>(num_vars), static_cast<int>(num_items),
+                              static_cast<int>(m_total_len));
+  }
+
+  void copy(context_type& con)
+  {
+    if (empty()) return;
+    IdxT num_items = m_lens.size();
+    if (box_items()) {
+      copy_boxes(con, num_items);
+      return;
+    }
+    IdxT avg_len = (m_total_len + num_items - 1) / num_items;
+    for (var_section const& sec : m_sections) {
+      void* const* vars = m_vars + sec.first;
+      switch (sec.type) {
+        case ElemType::f64:
+          con.fused(num_items, sec.num_vars, avg_len, fused_copier<double>(vars, m_srcs, m_dsts, m_fused_lens)); break;
+        case ElemType::f32:
+          con.fused(num_items, sec.num_vars, avg_len, fused_copier<float>(vars, m_srcs, m_dsts, m_fused_lens)); break;
+        case ElemType::i32:
+          con.fused(num_items, sec.num_vars, avg_len, fused_copier<int>(vars, m_srcs, m_dsts, m_fused_lens)); break;
+      }
+    }
+  }
+
+  // one row of a box per call
+  void copy_boxes(context_type& con, IdxT num_items)
+  {
+    IdxT total_rows = 0;
+    for (box_runs const& box : m_src_boxs) {
+      total_rows += box.num_rows;
+    }
+    IdxT avg_rows = (total_rows + num_items - 1) / num_items;
+    for (var_section const& sec : m_sections) {
+      void* const* vars = m_vars + sec.first;
+      switch (sec.type) {
+        case ElemType::f64:
+          con.fused(num_items, sec.num_vars, avg_rows, fused_box_copier<double>(vars, m_fused_src_boxs, m_fused_dst_boxs)); break;
+        case ElemType::f32:
+          con.fused(num_items, sec.num_vars, avg_rows, fused_box_copier<float>(vars, m_fused_src_boxs, m_fused_dst_boxs)); break;
+        case ElemType::i32:
+          con.fused(num_items, sec.num_vars, avg_rows, fused_box_copier<int>(vars, m_fused_src_boxs, m_fused_dst_boxs)); break;
+      }
+    }
+  }
+
+  ~SelfCopy()
+  {
+    if (m_vars != nullptr) {
+      m_util_aloc->deallocate(m_vars); m_vars = nullptr;
+    }
+    if (m_srcs != nullptr) {
+      m_util_aloc->deallocate(m_srcs); m_srcs = nullptr;
+      m_util_aloc->deallocate(m_dsts); m_dsts = nullptr;
+      m_util_aloc->deallocate(m_fused_lens); m_fused_lens = nullptr;
+    }
+    if (m_fused_src_boxs != nullptr) {
+      m_util_aloc->deallocate(m_fused_src_boxs); m_fused_src_boxs = nullptr;
+      m_util_aloc->deallocate(m_fused_dst_boxs); m_fused_dst_boxs = nullptr;
+    }
+    for (IdxT k = 0; k < static_cast<IdxT>(m_src_idxs.size()); ++k) {
+      m_aloc->deallocate(m_src_idxs[k]);
+      m_aloc->deallocate(m_dst_idxs[k]);
+    }
+  }
+};
+
+#ifdef COMB_ENABLE_MPI
+// mpi_type contexts have no kernels, their self messages are sent
+template < >
+struct SelfCopy<mpi_type_pol>
+{
+  using context_type = ExecContext<mpi_type_pol>;
+
+  bool empty() const { return true; }
+  IdxT index_nbytes() const { return 0; }
+  IdxT list_nbytes() const { return 0; }
+  void finalize(context_type&) { }
+  void copy(context_type&) { }
+};
+#endif
+
 } // namespace detail
 
 
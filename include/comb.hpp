@@ -35,6 +35,7 @@
 #include "SetReset.hpp"
 #include "MeshInfo.hpp"
 #include "MeshData.hpp"
+#include "compress.hpp"
 
 namespace COMB {
 
@@ -66,37 +67,59 @@ namespace detail {
   };
 
   struct set_n1 {
-     DataT* data;
-     set_n1(DataT* data_) : data(data_) {}
+     ElemPtr data;
+     set_n1(ElemPtr data_) : data(data_) {}
      COMB_HOST COMB_DEVICE
      void operator()(IdxT i, IdxT) const {
        IdxT zone = i;
        DataT next = -1.0;
-       // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, next);
-       data[zone] = next;
+       // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data.ptr, zone, next);
+       data.store(zone, next);
      }
   };
 
+  COMB_HOST COMB_DEVICE
+  inline uint32_t hash32(uint32_t h)
+  {
+    h ^= h >> 16; h *= 0x85ebca6bu;
+    h ^= h >> 13; h *= 0xc2b2ae35u;
+    h ^= h >> 16;
+    return h;
+  }
+
+  // sets the given fraction of zones to 1, the others to pseudo-random
+  // values in [1, 2^20) that differ per variable
   struct set_1 {
      IdxT ilen, ijlen;
-     DataT* data;
-     set_1(IdxT ilen_, IdxT ijlen_, DataT* data_) : ilen(ilen_), ijlen(ijlen_), data(data_) {}
+     ElemPtr data;
+     uint64_t cutoff;
+     uint32_t seed;
+     set_1(IdxT ilen_, IdxT ijlen_, ElemPtr data_, double compressibility_ = 1.0, IdxT var_ = 0)
+       : ilen(ilen_), ijlen(ijlen_), data(data_)
+       , cutoff(static_cast<uint64_t>(compressibility_ * 4294967296.0))
+       , seed(static_cast<uint32_t>(var_) * 0x9e3779b9u)
+     {}
      COMB_HOST COMB_DEVICE
      void operator()(IdxT k, IdxT j, IdxT i, IdxT idx) const {
        COMB::ignore_unused(idx);
        IdxT zone = i + j * ilen + k * ijlen;
+       uint32_t h = hash32(static_cast<uint32_t>(zone) ^ seed);
        DataT next = 1.0;
-       // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, next);
-       data[zone] = next;
+       if (h >= cutoff) {
+         uint64_t bits = (static_cast<uint64_t>(h) << 20) ^ hash32(h ^ 0x68e31da4u);
+         next += static_cast<DataT>(bits & ((uint64_t(1) << 52) - 1)) / (uint64_t(1) << 32);
+       }
+       // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data.ptr, zone, next);
+       data.store(zone, next);
      }
   };
 
   struct reset_1 {
      IdxT ilen, ijlen;
-     DataT* data;
+     ElemPtr data;
      IdxT imin, jmin, kmin;
      IdxT imax, jmax, kmax;
-     reset_1(IdxT ilen_, IdxT ijlen_, DataT* data_, IdxT imin_, IdxT jmin_, IdxT kmin_, IdxT imax_, IdxT jmax_, IdxT kmax_)
+     reset_1(IdxT ilen_, IdxT ijlen_, ElemPtr data_, IdxT imin_, IdxT jmin_, IdxT kmin_, IdxT imax_, IdxT jmax_, IdxT kmax_)
        : ilen(ilen_), ijlen(ijlen_), data(data_)
        , imin(imin_), jmin(jmin_), kmin(kmin_)
        , imax(imax_), jmax(jmax_), kmax(kmax_)
@@ -118,7 +141,7 @@ namespace detail {
        // }
        //FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
        DataT next = 1.0;
-       data[zone] = next;
+       data.store(zone, next);
      }
   };
 
@@ -126,6 +149,11 @@ namespace detail {
 } // namespace detail
 
 extern void print_timer(CommInfo& comminfo, Timer& tm, const char* prefix = "");
+extern void print_compression(CommInfo& comminfo, Timer& tm);
+extern void print_memory_stats(CommInfo& comminfo, std::vector<COMB::Allocator*> const& alocs, IdxT ncycles);
+extern void print_util_arenas(CommInfo& comminfo, std::vector<COMB::ArenaAllocator*> const& arenas, IdxT ncycles);
+extern void print_footprint(CommInfo& comminfo, CommFootprint const& fp);
+extern void print_numa_placement(CommInfo& comminfo, const char* what, COMB::Allocator& aloc);
 
 extern void print_message_info(CommInfo& comminfo, MeshInfo& info,
                                COMB::Allocator& aloc_unused,
@@ -144,6 +172,17 @@ extern void test_copy(CommInfo& comminfo,
                       COMB::ExecutorsAvailable& exec_avail,
                       Timer& tm, IdxT num_vars, IdxT len, IdxT nrepeats);
 
+extern void test_pack(CommInfo& comminfo, MeshInfo& info,
+                      COMB::ExecContexts& exec,
+                      COMB::Allocators& alloc,
+                      COMB::ExecutorsAvailable& exec_avail,
+                      Timer& tm, IdxT num_vars, IdxT nrepeats);
+
+extern void test_mempool(CommInfo& comminfo, MeshInfo& info,
+                         COMB::ExecContexts& exec,
+                         COMB::Allocators& alloc,
+                         Timer& tm, IdxT num_vars, IdxT nrepeats);
+
 extern void test_cycles_mock(CommInfo& comminfo, MeshInfo& info,
                              COMB::ExecContexts& exec,
                              COMB::Allocators& alloc,
@@ -156,6 +195,30 @@ extern void test_cycles_mpi(CommInfo& comminfo, MeshInfo& info,
                             COMB::Allocators& alloc,
                             COMB::ExecutorsAvailable& exec_avail,
                             IdxT num_vars, IdxT ncycles, Timer& tm, Timer& tm_total);
+
+extern void test_cycles_mpi_persistent(CommInfo& comminfo, MeshInfo& info,
+                                       COMB::ExecContexts& exec,
+                                       COMB::Allocators& alloc,
+                                       COMB::ExecutorsAvailable& exec_avail,
+                                       IdxT num_vars, IdxT ncycles, Timer& tm, Timer& tm_total);
+
+extern void test_cycles_mpi_neighbor(CommInfo& comminfo, MeshInfo& info,
+                                     COMB::ExecContexts& exec,
+                                     COMB::Allocators& alloc,
+                                     COMB::ExecutorsAvailable& exec_avail,
+                                     IdxT num_vars, IdxT ncycles, Timer& tm, Timer& tm_total);
+
+extern void test_cycles_mpi_rma(CommInfo& comminfo, MeshInfo& info,
+                                COMB::ExecContexts& exec,
+                                COMB::Allocators& alloc,
+                                COMB::ExecutorsAvailable& exec_avail,
+                                IdxT num_vars, IdxT ncycles, Timer& tm, Timer& tm_total);
+
+extern void test_cycles_mpi_shm(CommInfo& comminfo, MeshInfo& info,
+                                COMB::ExecContexts& exec,
+                                COMB::Allocators& alloc,
+                                COMB::ExecutorsAvailable& exec_avail,
+                                IdxT num_vars, IdxT ncycles, Timer& tm, Timer& tm_total);
 #endif
 
 #ifdef COMB_ENABLE_GDSYNC
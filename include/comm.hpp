@@ -25,6 +25,7 @@
 #include <vector>
 #include <map>
 #include <utility>
+#include <algorithm>
 
 #ifdef COMB_ENABLE_MPI
 #include <mpi.h>
@@ -34,6 +35,7 @@
 #include "memory.hpp"
 #include "for_all.hpp"
 #include "utils.hpp"
+#include "compress.hpp"
 
 #include "MessageBase.hpp"
 
@@ -233,6 +235,85 @@ struct CommInfo
   }
 };
 
+namespace detail {
+
+// places buffers in one slab, the lifetime of a buffer is an inclusive
+// range of phases and buffers whose lifetimes do not overlap share bytes
+struct buffer_plan
+{
+  static constexpr IdxT alignment = 64;
+
+  struct entry
+  {
+    void** ptr;
+    IdxT nbytes;
+    int first;
+    int last;
+    IdxT offset;
+  };
+
+  std::vector<entry> entries;
+  IdxT nbytes = 0;
+
+  void add(void** ptr, IdxT entry_nbytes, int first, int last)
+  {
+    entries.push_back(entry{ptr, entry_nbytes, first, last, 0});
+  }
+
+  // first fit in decreasing size order against the placed buffers whose
+  // lifetimes overlap
+  void place()
+  {
+    std::vector<entry*> order;
+    for (entry& e : entries) {
+      order.push_back(&e);
+    }
+    std::stable_sort(order.begin(), order.end(),
+        [](entry const* a, entry const* b) { return a->nbytes > b->nbytes; });
+
+    nbytes = 0;
+    std::vector<std::pair<IdxT, IdxT>> busy;
+    for (IdxT i = 0; i < static_cast<IdxT>(order.size()); ++i) {
+      entry& e = *order[i];
+      busy.clear();
+      for (IdxT j = 0; j < i; ++j) {
+        entry const& o = *order[j];
+        if (o.first <= e.last && e.first <= o.last) {
+          busy.emplace_back(o.offset, o.offset + o.nbytes);
+        }
+      }
+      std::sort(busy.begin(), busy.end());
+      e.offset = 0;
+      for (std::pair<IdxT, IdxT> const& b : busy) {
+        if (e.offset + e.nbytes <= b.first) break;
+        e.offset = std::max(e.offset, (b.second + alignment - 1) / alignment * alignment);
+      }
+      nbytes = std::max(nbytes, e.offset + e.nbytes);
+    }
+  }
+
+  void assign(void* base) const
+  {
+    for (entry const& e : entries) {
+      *e.ptr = static_cast<char*>(base) + e.offset;
+    }
+  }
+};
+
+} // namespace detail
+
+// bytes held by a rank for the mesh, the index lists, and the message
+// buffers, before is the default layout with index lists and a buffer
+// allocated per message
+struct CommFootprint
+{
+  IdxT mesh_nbytes = 0;
+  IdxT index_nbytes_before = 0;
+  IdxT index_nbytes = 0;
+  IdxT buffer_nbytes_before = 0;
+  IdxT buffer_nbytes = 0;
+};
+
 template < typename policy_many_, typename policy_few_, typename policy_comm_ >
 struct Comm
 {
@@ -263,18 +344,36 @@ struct Comm
   CommInfo::method wait_recv_method;
   CommInfo::method wait_send_method;
 
-  using send_message_type = detail::Message<detail::MessageBase::Kind::send, policy_comm>;
-  using recv_message_type = detail::Message<detail::MessageBase::Kind::recv, policy_comm>;
-
   using send_message_group_many_type = detail::MessageGroup<detail::MessageBase::Kind::send, policy_comm, policy_many>;
   using send_message_group_few_type  = detail::MessageGroup<detail::MessageBase::Kind::send, policy_comm, policy_few>;
 
   using recv_message_group_many_type = detail::MessageGroup<detail::MessageBase::Kind::recv, policy_comm, policy_many>;
   using recv_message_group_few_type  = detail::MessageGroup<detail::MessageBase::Kind::recv, policy_comm, policy_few>;
 
+  // from the groups as policies may reuse the messages of another policy
+  using send_message_type = typename send_message_group_many_type::message_type;
+  using recv_message_type = typename recv_message_group_many_type::message_type;
+
   using send_request_type = typename policy_comm::send_request_type;
   using recv_request_type = typename policy_comm::recv_request_type;
 
+  // arenas for the fused pack arrays of the many and few message groups,
+  // backed by the util allocators of their exec contexts and declared
+  // before the groups so they outlive them
+  COMB::ArenaAllocator m_util_arena_many;
+  COMB::ArenaAllocator m_util_arena_few;
+
+  // slabs holding the message buffers planned in low footprint mode
+  struct buffer_slab
+  {
+    COMB::Allocator* aloc;
+    void* ptr;
+    IdxT nbytes;
+    // the recv slab of policies with slab buffers, from recv_slab
+    bool recv;
+  };
+  std::vector<buffer_slab> m_buffer_slabs;
+
 
   struct send_message_vars_s
   {
@@ -307,6 +406,9 @@ struct Comm
 
   recv_message_vars_s m_recvs;
 
+  // messages whose partner is this rank, copied directly in the mesh
+  detail::SelfCopy<policy_many> m_self_copy;
+
 
   Comm(CommContext<policy_comm>& con_comm_, CommInfo& comminfo_,
        COMB::Allocator& mesh_aloc_, COMB::Allocator& many_aloc_, COMB::Allocator& few_aloc_)
@@ -328,6 +430,8 @@ struct Comm
     COMB::ignore_unused(con_many, con_few);
     //FGPRINTF(FileGroup::proc, "finish populating comm\n");
 
+    m_self_copy.finalize(con_many);
+
     std::vector<int> send_ranks;
     std::vector<int> recv_ranks;
     for (send_message_type& msg : m_sends.message_group_many.messages) {
@@ -345,6 +449,175 @@ struct Comm
     con_comm.connect_ranks(send_ranks, recv_ranks);
 
     con_comm.setup_mempool(many_aloc, few_aloc);
+
+    if (comb_allow_util_arena() && policy_comm::util_arena) {
+      m_util_arena_many.set_backing(con_many.util_aloc);
+      // share one arena when the contexts use the same util allocator
+      COMB::ArenaAllocator* arena_few = &m_util_arena_many;
+      if (&con_few.util_aloc != &con_many.util_aloc) {
+        m_util_arena_few.set_backing(con_few.util_aloc);
+        arena_few = &m_util_arena_few;
+      }
+      m_recvs.message_group_many.m_util_arena = &m_util_arena_many;
+      m_recvs.message_group_few.m_util_arena  = arena_few;
+      m_sends.message_group_many.m_util_arena = &m_util_arena_many;
+      m_sends.message_group_few.m_util_arena  = arena_few;
+    }
+
+    if (policy_comm::slab_buffers) {
+      plan_slab_buffers();
+    } else if (comb_allow_low_footprint() && policy_comm::persistent_buffers &&
+        comb_compression() == Compression::none) {
+      // place buffers in planned slabs, the groups keep them like persistent buffers
+      plan_buffers();
+    } else if (comb_allow_persistent_buffers() && policy_comm::persistent_buffers) {
+      // allocate buffers once, the per cycle allocate and deallocate keep them
+      allocate_persistent(con_many, con_comm, m_recvs.message_group_many);
+      allocate_persistent(con_few,  con_comm, m_recvs.message_group_few);
+      allocate_persistent(con_many, con_comm, m_sends.message_group_many);
+      allocate_persistent(con_few,  con_comm, m_sends.message_group_few);
+    }
+
+    // buffers kept across cycles have their final addresses now
+    std::vector<send_message_type*> send_messages;
+    for (send_message_type& msg : m_sends.message_group_many.messages) {
+      send_messages.emplace_back(&msg);
+    }
+    for (send_message_type& msg : m_sends.message_group_few.messages) {
+      send_messages.emplace_back(&msg);
+    }
+    std::vector<recv_message_type*> recv_messages;
+    for (recv_message_type& msg : m_recvs.message_group_many.messages) {
+      recv_messages.emplace_back(&msg);
+    }
+    for (recv_message_type& msg : m_recvs.message_group_few.messages) {
+      recv_messages.emplace_back(&msg);
+    }
+    connect_buffers(con_comm, send_messages, recv_messages);
+  }
+
+  template < typename context_type, typename message_group_type >
+  static void allocate_persistent(context_type& con, CommContext<policy_comm>& con_comm,
+                                  message_group_type& message_group)
+  {
+    IdxT num_messages = message_group.messages.size();
+    std::vector<typename message_group_type::message_type*> messages(num_messages, nullptr);
+    for (IdxT i = 0; i < num_messages; i++) {
+      messages[i] = &message_group.messages[i];
+    }
+    message_group.m_persistent_buffers = true;
+    message_group.allocate(con, con_comm, messages.data(), num_messages);
+  }
+
+  // phases of an exchange that bound the lifetimes of message buffers
+  enum struct phase : int
+  {
+    post_recv
+   ,post_send
+   ,wait_recv
+   ,wait_send
+  };
+
+  // every receive is posted before any send and buffers are released in
+  // the waits, so a recv buffer lives from post_recv to wait_recv and a
+  // send buffer from post_send to wait_send
+  void plan_buffers()
+  {
+    detail::buffer_plan plan_many;
+    detail::buffer_plan plan_few;
+    // use one slab when the groups share an allocator
+    detail::buffer_plan& plan_few_ref = (&few_aloc == &many_aloc) ? plan_many : plan_few;
+
+    add_to_plan(plan_many,    m_recvs.message_group_many, phase::post_recv, phase::wait_recv);
+    add_to_plan(plan_few_ref, m_recvs.message_group_few,  phase::post_recv, phase::wait_recv);
+    add_to_plan(plan_many,    m_sends.message_group_many, phase::post_send, phase::wait_send);
+    add_to_plan(plan_few_ref, m_sends.message_group_few,  phase::post_send, phase::wait_send);
+
+    allocate_plan(many_aloc, plan_many);
+    if (&plan_few_ref == &plan_few) {
+      allocate_plan(few_aloc, plan_few);
+    }
+  }
+
+  // one slab per direction in the many allocator, every buffer of a
+  // direction lives for the whole exchange
+  void plan_slab_buffers()
+  {
+#ifdef COMB_ENABLE_MPI
+    // mpi_type messages are described by datatypes and need no buffers
+    if (use_mpi_type) return;
+#endif
+    detail::buffer_plan plan_recv;
+    detail::buffer_plan plan_send;
+
+    add_to_plan(plan_recv, m_recvs.message_group_many, phase::post_recv, phase::wait_send);
+    add_to_plan(plan_recv, m_recvs.message_group_few,  phase::post_recv, phase::wait_send);
+    add_to_plan(plan_send, m_sends.message_group_many, phase::post_recv, phase::wait_send);
+    add_to_plan(plan_send, m_sends.message_group_few,  phase::post_recv, phase::wait_send);
+
+    allocate_plan(many_aloc, plan_recv, true);
+    allocate_plan(many_aloc, plan_send);
+  }
+
+  template < typename message_group_type >
+  static void add_to_plan(detail::buffer_plan& plan, message_group_type& message_group,
+                          phase first, phase last)
+  {
+    for (auto& msg : message_group.messages) {
+      if (message_has_buffer(msg)) {
+        plan.add(&msg.buf, msg.nbytes(), static_cast<int>(first), static_cast<int>(last));
+      }
+    }
+    message_group.m_persistent_buffers = true;
+    message_group.m_planned_buffers = true;
+  }
+
+  // the recv slab is allocated even when empty as recv_slab may be
+  // collective over the ranks of the comm
+  void allocate_plan(COMB::Allocator& aloc, detail::buffer_plan& plan, bool recv = false)
+  {
+    if (plan.entries.empty() && !recv) return;
+    plan.place();
+    IdxT nbytes = std::max(plan.nbytes, IdxT{1});
+    void* ptr = recv ? detail::recv_slab<policy_comm>::allocate(con_comm, aloc, nbytes)
+                     : aloc.allocate(nbytes);
+    plan.assign(ptr);
+    m_buffer_slabs.push_back(buffer_slab{&aloc, ptr, plan.nbytes, recv});
+  }
+
+  // footprint of the index lists and message buffers, the mesh is not
+  // known to the comm
+  CommFootprint footprint()
+  {
+    CommFootprint fp;
+    add_footprint(fp, m_recvs.message_group_many);
+    add_footprint(fp, m_recvs.message_group_few);
+    add_footprint(fp, m_sends.message_group_many);
+    add_footprint(fp, m_sends.message_group_few);
+    fp.index_nbytes_before += m_self_copy.list_nbytes();
+    fp.index_nbytes        += m_self_copy.index_nbytes();
+    if (!m_buffer_slabs.empty()) {
+      fp.buffer_nbytes = 0;
+      for (buffer_slab const& slab : m_buffer_slabs) {
+        fp.buffer_nbytes += slab.nbytes;
+      }
+    }
+    return fp;
+  }
+
+  template < typename message_group_type >
+  static void add_footprint(CommFootprint& fp, message_group_type& message_group)
+  {
+    for (auto const& item : message_group.m_items) {
+      fp.index_nbytes_before += item.list_nbytes();
+      fp.index_nbytes        += item.index_nbytes();
+    }
+    for (auto const& msg : message_group.messages) {
+      if (message_has_buffer(msg)) {
+        fp.buffer_nbytes_before += msg.nbytes();
+        fp.buffer_nbytes        += msg.nbytes();
+      }
+    }
   }
 
   ~Comm()
@@ -366,6 +639,37 @@ struct Comm
       recv_ranks.emplace_back(msg.partner_rank);
     }
     con_comm.disconnect_ranks(send_ranks, recv_ranks);
+
+    // after disconnecting as the comm context may expose the slabs
+    for (buffer_slab& slab : m_buffer_slabs) {
+      if (slab.recv) {
+        detail::recv_slab<policy_comm>::deallocate(con_comm, *slab.aloc, slab.ptr);
+      } else {
+        slab.aloc->deallocate(slab.ptr);
+      }
+    }
+    m_buffer_slabs.clear();
+  }
+
+  // arenas used by the message groups, empty if the util arena is not used
+  std::vector<COMB::ArenaAllocator*> util_arenas()
+  {
+    std::vector<COMB::ArenaAllocator*> arenas;
+    if (m_util_arena_many.has_backing()) {
+      arenas.push_back(&m_util_arena_many);
+    }
+    if (m_util_arena_few.has_backing()) {
+      arenas.push_back(&m_util_arena_few);
+    }
+    return arenas;
+  }
+
+  // rewinds the arenas once the send and recv groups have released their
+  // fused pack arrays at the end of an exchange
+  void reset_util_arenas()
+  {
+    m_util_arena_many.reset();
+    m_util_arena_few.reset();
   }
 
   bool mock_communication() const
@@ -383,6 +687,8 @@ struct Comm
     COMB::ignore_unused(con_many, con_few);
     //FGPRINTF(FileGroup::proc, "posting receives\n");
 
+    detail::exchange_epoch<policy_comm>::open(con_comm);
+
     IdxT num_many = m_recvs.message_group_many.messages.size();
     IdxT num_few = m_recvs.message_group_few.messages.size();
 
@@ -458,6 +764,9 @@ struct Comm
     COMB::ignore_unused(con_many, con_few);
     //FGPRINTF(FileGroup::proc, "posting sends\n");
 
+    // completed with the unpacking of the recvs
+    m_self_copy.copy(con_many);
+
     IdxT num_many = m_sends.message_group_many.messages.size();
     IdxT num_few = m_sends.message_group_few.messages.size();
 
@@ -744,6 +1053,8 @@ struct Comm
   {
     //FGPRINTF(FileGroup::proc, "waiting receives\n");
 
+    detail::exchange_epoch<policy_comm>::close(con_comm);
+
     IdxT num_many = m_recvs.message_group_many.messages.size();
     IdxT num_few = m_recvs.message_group_few.messages.size();
 
@@ -874,9 +1185,11 @@ struct Comm
     if (num_few > 0) {
       con_few.synchronize();
     }
-    if (num_many > 0) {
+    if (num_many > 0 || !m_self_copy.empty()) {
       con_many.synchronize();
     }
+
+    reset_util_arenas();
   }
 
 
@@ -996,6 +1309,8 @@ struct Comm
 
     m_sends.messages.clear();
     m_sends.requests.clear();
+
+    reset_util_arenas();
   }
 };
 
@@ -1005,6 +1320,10 @@ struct CommunicatorsAvailable
 {
   bool mock = false;
   bool mpi = false;
+  bool mpi_persistent = false;
+  bool mpi_neighbor = false;
+  bool mpi_rma = false;
+  bool mpi_shm = false;
   bool gdsync = false;
   bool gpump = false;
   bool mp = false;
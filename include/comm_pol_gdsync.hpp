@@ -314,6 +314,12 @@ struct gdsync_pol {
   static const bool mock = false;
   // compile mpi_type packing/unpacking tests for this comm policy
   static const bool use_mpi_type = false;
+  // message buffers come from the comm mempool every cycle
+  static const bool persistent_buffers = false;
+  // fused pack arrays may still be in use by the device after deallocate
+  static const bool util_arena = false;
+  // message buffers are placed per message group
+  static const bool slab_buffers = false;
   static const char* get_name() { return "gdsync"; }
   using send_request_type = detail::gdsync::Request*;
   using recv_request_type = detail::gdsync::Request*;
@@ -882,14 +888,6 @@ struct MessageGroup<MessageBase::Kind::send, gdsync_pol, exec_policy>
 
   std::vector<message_request_type> m_msg_requests;
 
-  // vars for fused loops
-  DataT const** m_srcs = nullptr;
-
-  DataT**       m_bufs = nullptr;
-  LidxT const** m_idxs = nullptr;
-  IdxT*         m_lens = nullptr;
-  IdxT m_pos = 0;
-
   // use the base class constructor
   using base::base;
 
@@ -912,7 +910,7 @@ struct MessageGroup<MessageBase::Kind::send, gdsync_pol, exec_policy>
       message_type* msg = msgs[i];
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       message_request_type& msg_request = m_msg_requests[msg->idx];
       msg_request.region = con_comm.get_mempool().allocate(con_comm.g, this->m_aloc, nbytes);
@@ -920,25 +918,7 @@ struct MessageGroup<MessageBase::Kind::send, gdsync_pol, exec_policy>
       con_comm.get_message_request_map().emplace(&msg_request);
     }
 
-    if (comb_allow_pack_loop_fusion() && m_srcs == nullptr) {
-
-      // allocate per variable vars
-      IdxT num_vars = this->m_variables.size();
-      m_srcs = (DataT const**)con.util_aloc.allocate(num_vars*sizeof(DataT const*));
-
-      // variable vars initialized here
-      for (IdxT i = 0; i < num_vars; ++i) {
-        m_srcs[i] = this->m_variables[i];
-      }
-
-      // allocate per item vars
-      IdxT num_items = this->m_items.size();
-      m_bufs = (DataT**)      con.util_aloc.allocate(num_items*sizeof(DataT*));
-      m_idxs = (LidxT const**)con.util_aloc.allocate(num_items*sizeof(LidxT const*));
-      m_lens = (IdxT*)        con.util_aloc.allocate(num_items*sizeof(IdxT));
-
-      // item vars initialized in pack
-    }
+    this->allocate_fused_vars(con);
   }
 
   void pack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
@@ -954,15 +934,9 @@ struct MessageGroup<MessageBase::Kind::send, gdsync_pol, exec_policy>
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT len = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          for (DataT const* src : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] len %d\n", this, buf, src, indices, len);
-            this->m_contexts[msg->idx].for_all(0, len, make_copy_idxr_idxr(src, detail::indexer_list_idx{indices},
-                                               static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{}));
-            buf += nbytes;
-          }
+          pack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
         }
         if (async == detail::Async::no) {
           this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
@@ -972,11 +946,6 @@ struct MessageGroup<MessageBase::Kind::send, gdsync_pol, exec_policy>
       }
     }
     else if (false && async == detail::Async::no) { // not sure how to know when individual contexts are in different streams
-      IdxT num_vars = this->m_variables.size();
-      DataT const** srcs = m_srcs;
-      DataT**       bufs = m_bufs + m_pos;
-      LidxT const** idxs = m_idxs + m_pos;
-      IdxT*         lens = m_lens + m_pos;
       IdxT total_items = 0;
       IdxT num_fused = 0;
       for (IdxT i = 0; i < len; ++i) {
@@ -985,52 +954,39 @@ struct MessageGroup<MessageBase::Kind::send, gdsync_pol, exec_policy>
         assert(buf != nullptr);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
       }
       // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
       IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-      con.fused(num_fused, num_vars, avg_items, fused_packer(srcs, bufs, idxs, lens));
-      m_pos += num_fused;
+      fused_pack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      this->m_fused.pos += num_fused;
     } else {
-      IdxT num_vars = this->m_variables.size();
       for (IdxT i = 0; i < len; ++i) {
         const message_type* msg = msgs[i];
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
-        DataT const** srcs = m_srcs;
-        DataT**       bufs = m_bufs + m_pos;
-        LidxT const** idxs = m_idxs + m_pos;
-        IdxT*         lens = m_lens + m_pos;
         IdxT total_items = 0;
         IdxT num_fused = 0;
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
         // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
         IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-        this->m_contexts[msg->idx].fused(num_fused, num_vars, avg_items, fused_packer(srcs, bufs, idxs, lens));
-        m_pos += num_fused;
+        fused_pack(this->m_contexts[msg->idx], this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+        this->m_fused.pos += num_fused;
         this->m_contexts[msg->idx].finish_component_recordEvent(this->m_groups[len-1], this->m_components[msg->idx], this->m_events[msg->idx]);
       }
     }
@@ -1062,7 +1018,7 @@ struct MessageGroup<MessageBase::Kind::send, gdsync_pol, exec_policy>
       assert(buf != nullptr);
       const int partner_rank = msg->partner_rank;
       // const int tag = msg->msg_tag;
-      const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      const IdxT nbytes = msg->nbytes();
 
       // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
       message_request_type& msg_request = m_msg_requests[msg->idx];
@@ -1100,19 +1056,7 @@ struct MessageGroup<MessageBase::Kind::send, gdsync_pol, exec_policy>
     }
 
     // TODO: worry about host reusing this memory before device synchronized
-    if (comb_allow_pack_loop_fusion() && m_srcs != nullptr && m_pos == static_cast<IdxT>(this->m_items.size())) {
-
-      // deallocate per variable vars
-      con.util_aloc.deallocate(m_srcs); m_srcs = nullptr;
-
-      // deallocate per item vars
-      con.util_aloc.deallocate(m_bufs); m_bufs = nullptr;
-      con.util_aloc.deallocate(m_idxs); m_idxs = nullptr;
-      con.util_aloc.deallocate(m_lens); m_lens = nullptr;
-
-      // reset pos
-      m_pos = 0;
-    }
+    this->deallocate_fused_vars();
   }
 
 private:
@@ -1181,14 +1125,6 @@ struct MessageGroup<MessageBase::Kind::recv, gdsync_pol, exec_policy>
 
   std::vector<message_request_type> m_msg_requests;
 
-  // fused loop vars
-  DataT**       m_dsts = nullptr;
-
-  DataT const** m_bufs = nullptr;
-  LidxT const** m_idxs = nullptr;
-  IdxT*         m_lens = nullptr;
-  IdxT m_pos = 0;
-
   // use the base class constructor
   using base::base;
 
@@ -1211,7 +1147,7 @@ struct MessageGroup<MessageBase::Kind::recv, gdsync_pol, exec_policy>
       message_type* msg = msgs[i];
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       message_request_type& msg_request = m_msg_requests[msg->idx];
       msg_request.region = con_comm.get_mempool().allocate(con_comm.g, this->m_aloc, nbytes);
@@ -1219,25 +1155,7 @@ struct MessageGroup<MessageBase::Kind::recv, gdsync_pol, exec_policy>
       con_comm.get_message_request_map().emplace(&msg_request);
     }
 
-    if (comb_allow_pack_loop_fusion() && m_dsts == nullptr) {
-
-      // allocate per variable vars
-      IdxT num_vars = this->m_variables.size();
-      m_dsts = (DataT**)con.util_aloc.allocate(num_vars*sizeof(DataT*));
-
-      // variable vars initialized here
-      for (IdxT i = 0; i < num_vars; ++i) {
-        m_dsts[i] = this->m_variables[i];
-      }
-
-      // allocate per item vars
-      IdxT num_items = this->m_items.size();
-      m_bufs = (DataT const**)con.util_aloc.allocate(num_items*sizeof(DataT const*));
-      m_idxs = (LidxT const**)con.util_aloc.allocate(num_items*sizeof(LidxT const*));
-      m_lens = (IdxT*)        con.util_aloc.allocate(num_items*sizeof(IdxT));
-
-      // item vars initialized in pack
-    }
+    this->allocate_fused_vars(con);
   }
 
   void Irecv(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
@@ -1250,7 +1168,7 @@ struct MessageGroup<MessageBase::Kind::recv, gdsync_pol, exec_policy>
       assert(buf != nullptr);
       const int partner_rank = msg->partner_rank;
       // const int tag = msg->msg_tag;
-      const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      const IdxT nbytes = msg->nbytes();
       // FGPRINTF(FileGroup::proc, "%p Irecv %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
       message_request_type& msg_request = m_msg_requests[msg->idx];
       detail::gdsync::receive(con_comm.g, partner_rank, msg_request.region.mr, msg_request.region.offset, nbytes);
@@ -1276,25 +1194,14 @@ struct MessageGroup<MessageBase::Kind::recv, gdsync_pol, exec_policy>
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT len = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          for (DataT* dst : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p unpack %p[%p] = %p len %d\n", this, dst, indices, buf, len);
-            this->m_contexts[msg->idx].for_all(0, len, make_copy_idxr_idxr(static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{},
-                                               dst, detail::indexer_list_idx{indices}));
-            buf += nbytes;
-          }
+          unpack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
         }
         this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
       }
     }
     else if (false) { // not sure how to know when individual contexts are in different streams
-      IdxT num_vars = this->m_variables.size();
-      DataT**       dsts = m_dsts;
-      DataT const** bufs = m_bufs + m_pos;
-      LidxT const** idxs = m_idxs + m_pos;
-      IdxT*         lens = m_lens + m_pos;
       IdxT total_items = 0;
       IdxT num_fused = 0;
       for (IdxT i = 0; i < len; ++i) {
@@ -1303,52 +1210,39 @@ struct MessageGroup<MessageBase::Kind::recv, gdsync_pol, exec_policy>
         assert(buf != nullptr);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT const*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
       }
       // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, dst, indices, nitems);
       IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-      con.fused(num_fused, num_vars, avg_items, fused_unpacker(dsts, bufs, idxs, lens));
-      m_pos += num_fused;
+      fused_unpack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      this->m_fused.pos += num_fused;
     } else {
-      IdxT num_vars = this->m_variables.size();
-      DataT** dsts = m_dsts;
       for (IdxT i = 0; i < len; ++i) {
         const message_type* msg = msgs[i];
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
-        DataT const** bufs = m_bufs + m_pos;
-        LidxT const** idxs = m_idxs + m_pos;
-        IdxT*         lens = m_lens + m_pos;
         IdxT total_items = 0;
         IdxT num_fused = 0;
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT const*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
         // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, dst, indices, nitems);
       IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-        con.fused(num_fused, num_vars, avg_items, fused_unpacker(dsts, bufs, idxs, lens));
-        m_pos += num_fused;
+        fused_unpack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+        this->m_fused.pos += num_fused;
         this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
       }
     }
@@ -1372,19 +1266,7 @@ struct MessageGroup<MessageBase::Kind::recv, gdsync_pol, exec_policy>
     }
 
     // TODO: worry about host reusing this memory before device synchronized
-    if (comb_allow_pack_loop_fusion() && m_dsts != nullptr && m_pos == static_cast<IdxT>(this->m_items.size())) {
-
-      // deallocate per variable vars
-      con.util_aloc.deallocate(m_dsts); m_dsts = nullptr;
-
-      // deallocate per item vars
-      con.util_aloc.deallocate(m_bufs); m_bufs = nullptr;
-      con.util_aloc.deallocate(m_idxs); m_idxs = nullptr;
-      con.util_aloc.deallocate(m_lens); m_lens = nullptr;
-
-      // reset pos
-      m_pos = 0;
-    }
+    this->deallocate_fused_vars();
   }
 
 private:
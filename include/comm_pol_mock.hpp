@@ -31,6 +31,12 @@ struct mock_pol {
   // compile mpi_type packing/unpacking tests for this comm policy
   static const bool use_mpi_type = true;
 #endif
+  // message buffers may be kept across cycles
+  static const bool persistent_buffers = true;
+  // fused pack arrays may come from the comm util arena
+  static const bool util_arena = true;
+  // message buffers are placed per message group
+  static const bool slab_buffers = false;
   static const char* get_name() { return "mock"; }
   using send_request_type = int;
   using recv_request_type = int;
@@ -354,14 +360,6 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, exec_policy>
   using group_type        = typename base::group_type;
   using component_type    = typename base::component_type;
 
-  // vars for fused loops
-  DataT const** m_srcs = nullptr;
-
-  DataT**       m_bufs = nullptr;
-  LidxT const** m_idxs = nullptr;
-  IdxT*         m_lens = nullptr;
-  IdxT m_pos = 0;
-
   // use the base class constructor
   using base::base;
 
@@ -372,32 +370,15 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       msg->buf = this->m_aloc.allocate(nbytes);
     }
 
-    if (comb_allow_pack_loop_fusion() && m_srcs == nullptr) {
-
-      // allocate per variable vars
-      IdxT num_vars = this->m_variables.size();
-      m_srcs = (DataT const**)con.util_aloc.allocate(num_vars*sizeof(DataT const*));
-
-      // variable vars initialized here
-      for (IdxT i = 0; i < num_vars; ++i) {
-        m_srcs[i] = this->m_variables[i];
-      }
-
-      // allocate per item vars
-      IdxT num_items = this->m_items.size();
-      m_bufs = (DataT**)      con.util_aloc.allocate(num_items*sizeof(DataT*));
-      m_idxs = (LidxT const**)con.util_aloc.allocate(num_items*sizeof(LidxT const*));
-      m_lens = (IdxT*)        con.util_aloc.allocate(num_items*sizeof(IdxT));
-
-      // item vars initialized in pack
-    }
+    this->allocate_fused_vars(con);
   }
 
   void pack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
@@ -413,15 +394,9 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, exec_policy>
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          for (DataT const* src : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
-            this->m_contexts[msg->idx].for_all(0, nitems, make_copy_idxr_idxr(src, detail::indexer_list_idx{indices},
-                                               static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{}));
-            buf += nbytes;
-          }
+          pack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
         }
         if (async == detail::Async::no) {
           this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
@@ -431,11 +406,6 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, exec_policy>
       }
     }
     else if (async == detail::Async::no) {
-      IdxT num_vars = this->m_variables.size();
-      DataT const** srcs = m_srcs;
-      DataT**       bufs = m_bufs + m_pos;
-      LidxT const** idxs = m_idxs + m_pos;
-      IdxT*         lens = m_lens + m_pos;
       IdxT total_items = 0;
       IdxT num_fused = 0;
       for (IdxT i = 0; i < len; ++i) {
@@ -444,52 +414,39 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, exec_policy>
         assert(buf != nullptr);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
       }
       // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
       IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-      con.fused(num_fused, num_vars, avg_items, fused_packer(srcs, bufs, idxs, lens));
-      m_pos += num_fused;
+      fused_pack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      this->m_fused.pos += num_fused;
     } else {
-      IdxT num_vars = this->m_variables.size();
       for (IdxT i = 0; i < len; ++i) {
         const message_type* msg = msgs[i];
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
-        DataT const** srcs = m_srcs;
-        DataT**       bufs = m_bufs + m_pos;
-        LidxT const** idxs = m_idxs + m_pos;
-        IdxT*         lens = m_lens + m_pos;
         IdxT total_items = 0;
         IdxT num_fused = 0;
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
         // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
         IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-        this->m_contexts[msg->idx].fused(num_fused, num_vars, avg_items, fused_packer(srcs, bufs, idxs, lens));
-        m_pos += num_fused;
+        fused_pack(this->m_contexts[msg->idx], this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+        this->m_fused.pos += num_fused;
         this->m_contexts[msg->idx].finish_component_recordEvent(this->m_groups[len-1], this->m_components[msg->idx], this->m_events[msg->idx]);
       }
     }
@@ -530,7 +487,7 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, exec_policy>
       // const int partner_rank = msg->partner_rank;
       // const int tag = msg->msg_tag;
       for (const MessageItemBase* msg_item : msg->message_items) {
-        const IdxT nbytes = msg_item->nbytes * this->m_variables.size();
+        const IdxT nbytes = msg_item->nbytes;
         // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
         buf += nbytes;
       }
@@ -551,6 +508,7 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
       assert(msg->buf != nullptr);
 
       this->m_aloc.deallocate(msg->buf);
@@ -558,20 +516,9 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, exec_policy>
       msg->buf = nullptr;
     }
 
-    if (comb_allow_pack_loop_fusion() && m_srcs != nullptr && m_pos == static_cast<IdxT>(this->m_items.size())) {
-
-      // deallocate per variable vars
-      con.util_aloc.deallocate(m_srcs); m_srcs = nullptr;
-
-      // deallocate per item vars
-      con.util_aloc.deallocate(m_bufs); m_bufs = nullptr;
-      con.util_aloc.deallocate(m_idxs); m_idxs = nullptr;
-      con.util_aloc.deallocate(m_lens); m_lens = nullptr;
-
-      // reset pos
-      m_pos = 0;
-    }
+    this->deallocate_fused_vars();
   }
+
 };
 
 template < typename exec_policy >
@@ -592,14 +539,6 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, exec_policy>
   using group_type        = typename base::group_type;
   using component_type    = typename base::component_type;
 
-  // fused loop vars
-  DataT**       m_dsts = nullptr;
-
-  DataT const** m_bufs = nullptr;
-  LidxT const** m_idxs = nullptr;
-  IdxT*         m_lens = nullptr;
-  IdxT m_pos = 0;
-
   // use the base class constructor
   using base::base;
 
@@ -610,32 +549,15 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       msg->buf = this->m_aloc.allocate(nbytes);
     }
 
-    if (comb_allow_pack_loop_fusion() && m_dsts == nullptr) {
-
-      // allocate per variable vars
-      IdxT num_vars = this->m_variables.size();
-      m_dsts = (DataT**)con.util_aloc.allocate(num_vars*sizeof(DataT*));
-
-      // variable vars initialized here
-      for (IdxT i = 0; i < num_vars; ++i) {
-        m_dsts[i] = this->m_variables[i];
-      }
-
-      // allocate per item vars
-      IdxT num_items = this->m_items.size();
-      m_bufs = (DataT const**)con.util_aloc.allocate(num_items*sizeof(DataT const*));
-      m_idxs = (LidxT const**)con.util_aloc.allocate(num_items*sizeof(LidxT const*));
-      m_lens = (IdxT*)        con.util_aloc.allocate(num_items*sizeof(IdxT));
-
-      // item vars initialized in pack
-    }
+    this->allocate_fused_vars(con);
   }
 
   void Irecv(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
@@ -648,7 +570,7 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, exec_policy>
       assert(buf != nullptr);
       // const int partner_rank = msg->partner_rank;
       // const int tag = msg->msg_tag;
-      // const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      // const IdxT nbytes = msg->nbytes();
       // FGPRINTF(FileGroup::proc, "%p Irecv %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
       requests[i] = -1;
     }
@@ -667,25 +589,14 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, exec_policy>
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          for (DataT* dst : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p unpack %p[%p] = %p nitems %d\n", this, dst, indices, buf, nitems);
-            this->m_contexts[msg->idx].for_all(0, nitems, make_copy_idxr_idxr(static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{},
-                                               dst, detail::indexer_list_idx{indices}));
-            buf += nbytes;
-          }
+          unpack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
         }
         this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
       }
     }
     else {
-      IdxT num_vars = this->m_variables.size();
-      DataT**       dsts = m_dsts;
-      DataT const** bufs = m_bufs + m_pos;
-      LidxT const** idxs = m_idxs + m_pos;
-      IdxT*         lens = m_lens + m_pos;
       IdxT total_items = 0;
       IdxT num_fused = 0;
       for (IdxT i = 0; i < len; ++i) {
@@ -694,22 +605,18 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, exec_policy>
         assert(buf != nullptr);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT const*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
       }
       // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, dst, indices, nitems);
       IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-      con.fused(num_fused, num_vars, avg_items, fused_unpacker(dsts, bufs, idxs, lens));
-      m_pos += num_fused;
+      fused_unpack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      this->m_fused.pos += num_fused;
     }
     con.finish_group(this->m_groups[len-1]);
   }
@@ -720,6 +627,7 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
       assert(msg->buf != nullptr);
 
       this->m_aloc.deallocate(msg->buf);
@@ -727,20 +635,9 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, exec_policy>
       msg->buf = nullptr;
     }
 
-    if (comb_allow_pack_loop_fusion() && m_dsts != nullptr && m_pos == static_cast<IdxT>(this->m_items.size())) {
-
-      // deallocate per variable vars
-      con.util_aloc.deallocate(m_dsts); m_dsts = nullptr;
-
-      // deallocate per item vars
-      con.util_aloc.deallocate(m_bufs); m_bufs = nullptr;
-      con.util_aloc.deallocate(m_idxs); m_idxs = nullptr;
-      con.util_aloc.deallocate(m_lens); m_lens = nullptr;
-
-      // reset pos
-      m_pos = 0;
-    }
+    this->deallocate_fused_vars();
   }
+
 };
 
 
@@ -774,12 +671,13 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, mpi_type_pol>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
         // no buffer needed
       } else {
-        IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        IdxT nbytes = msg->nbytes();
 
         msg->buf = this->m_aloc.allocate(nbytes);
       }
@@ -799,16 +697,18 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, mpi_type_pol>
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
         int pos = 0;
-        const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        const IdxT nbytes = msg->nbytes();
         for (MessageItemBase* msg_item : msg->message_items) {
           message_item_type* item = static_cast<message_item_type*>(msg_item);
           const IdxT nitems = 1;
-          MPI_Datatype mpi_type = item->mpi_type;
           int old_pos = pos;
-          for (DataT const* src : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p pack %p[%i] = %p\n", this, buf, pos, src);
-            detail::MPI::Pack(src, nitems, mpi_type,
-                              buf, nbytes, &pos, con_comm.comm);
+          for (IdxT s = 0; s < static_cast<IdxT>(this->m_sections.size()); ++s) {
+            var_section const& sec = this->m_sections[s];
+            for (IdxT j = sec.first; j < sec.first + sec.num_vars; ++j) {
+              void const* src = this->m_variables[j];
+              detail::MPI::Pack(src, nitems, item->mpi_types[s],
+                                buf, nbytes, &pos, con_comm.comm);
+            }
           }
           item->packed_nbytes = pos - old_pos;
         }
@@ -854,10 +754,10 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, mpi_type_pol>
       // const int partner_rank = msg->partner_rank;
       // const int tag = msg->msg_tag;
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
-        // const DataT* src = this->m_variables.front();
+        // void const* src = this->m_variables.front();
         // const IdxT nitems = 1;
         // const message_item_type* item = static_cast<const message_item_type*>(msg->message_items.front());
-        // MPI_Datatype mpi_type = item->mpi_type;
+        // MPI_Datatype mpi_type = item->mpi_types.front();
         // FGPRINTF(FileGroup::proc, "%p Isend %p to %i tag %i\n", this, src, partner_rank, tag);
         requests[i] = 1;
       } else {
@@ -886,6 +786,7 @@ struct MessageGroup<MessageBase::Kind::send, mock_pol, mpi_type_pol>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
         // buf not allocated
         assert(msg->buf == nullptr);
@@ -926,12 +827,13 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, mpi_type_pol>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
         // no buffer needed
       } else {
-        IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        IdxT nbytes = msg->nbytes();
 
         msg->buf = this->m_aloc.allocate(nbytes);
       }
@@ -949,17 +851,17 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, mpi_type_pol>
       // const int partner_rank = msg->partner_rank;
       // const int tag = msg->msg_tag;
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
-        DataT* dst = m_variables.front();
+        void* dst = this->m_variables.front();
         assert(dst != nullptr);
         // IdxT nitems = 1;
         // const message_item_type* item = static_cast<const message_item_type*>(msg->message_items.front());
-        // MPI_Datatype mpi_type = item.mpi_type;
+        // MPI_Datatype mpi_type = item.mpi_types.front();
         // FGPRINTF(FileGroup::proc, "%p Irecv %p to %i tag %i\n", this, dst, partner_rank, tag);
         requests[i] = -1;
       } else {
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
-        // const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        // const IdxT nbytes = msg->nbytes();
         // FGPRINTF(FileGroup::proc, "%p Irecv %p maxnbytes %i to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
         requests[i] = -1;
       }
@@ -979,17 +881,19 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, mpi_type_pol>
       } else {
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
-        const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        const IdxT nbytes = msg->nbytes();
         int pos = 0;
         for (MessageItemBase* msg_item : msg->message_items) {
           message_item_type* item = static_cast<message_item_type*>(msg_item);
           const IdxT nitems = 1;
-          MPI_Datatype mpi_type = item->mpi_type;
           int old_pos = pos;
-          for (DataT* dst : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p unpack %p = %p[%i]\n", this, dst, buf, pos);
-            detail::MPI::Unpack(buf, nbytes, &pos,
-                                dst, nitems, mpi_type, con_comm.comm);
+          for (IdxT s = 0; s < static_cast<IdxT>(this->m_sections.size()); ++s) {
+            var_section const& sec = this->m_sections[s];
+            for (IdxT j = sec.first; j < sec.first + sec.num_vars; ++j) {
+              void* dst = this->m_variables[j];
+              detail::MPI::Unpack(buf, nbytes, &pos,
+                                  dst, nitems, item->mpi_types[s], con_comm.comm);
+            }
           }
           item->packed_nbytes = pos - old_pos;
         }
@@ -1005,6 +909,7 @@ struct MessageGroup<MessageBase::Kind::recv, mock_pol, mpi_type_pol>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
         // buf not allocated
         assert(msg->buf == nullptr);
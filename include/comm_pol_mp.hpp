@@ -314,6 +314,12 @@ struct mp_pol {
   static const bool mock = false;
   // compile mpi_type packing/unpacking tests for this comm policy
   static const bool use_mpi_type = false;
+  // message buffers come from the comm mempool every cycle
+  static const bool persistent_buffers = false;
+  // packs without fused pack arrays
+  static const bool util_arena = false;
+  // message buffers are placed per message group
+  static const bool slab_buffers = false;
   static const char* get_name() { return "mp"; }
   using send_request_type = detail::mp::Request*;
   using recv_request_type = detail::mp::Request*;
@@ -904,7 +910,7 @@ struct MessageGroup<MessageBase::Kind::send, mp_pol, exec_policy>
       message_type* msg = msgs[i];
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       message_request_type& msg_request = m_msg_requests[msg->idx];
       msg_request.region = con_comm.get_mempool().allocate(con_comm.g, this->m_aloc, nbytes);
@@ -925,15 +931,9 @@ struct MessageGroup<MessageBase::Kind::send, mp_pol, exec_policy>
       this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
       for (const MessageItemBase* msg_item : msg->message_items) {
         const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-        const IdxT len = item->size;
         const IdxT nbytes = item->nbytes;
-        LidxT const* indices = item->indices;
-        for (DataT const* src : this->m_variables) {
-          // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] len %d\n", this, buf, src, indices, len);
-          this->m_contexts[msg->idx].for_all(0, len, make_copy_idxr_idxr(src, detail::indexer_list_idx{indices},
-                                             static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{}));
-          buf += nbytes;
-        }
+        pack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+        buf += nbytes;
       }
       if (async == detail::Async::no) {
         this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
@@ -969,7 +969,7 @@ struct MessageGroup<MessageBase::Kind::send, mp_pol, exec_policy>
       assert(buf != nullptr);
       const int partner_rank = msg->partner_rank;
       // const int tag = msg->msg_tag;
-      const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      const IdxT nbytes = msg->nbytes();
 
       // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
       message_request_type& msg_request = m_msg_requests[msg->idx];
@@ -1095,7 +1095,7 @@ struct MessageGroup<MessageBase::Kind::recv, mp_pol, exec_policy>
       message_type* msg = msgs[i];
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       message_request_type& msg_request = m_msg_requests[msg->idx];
       msg_request.region = con_comm.get_mempool().allocate(con_comm.g, this->m_aloc, nbytes);
@@ -1114,7 +1114,7 @@ struct MessageGroup<MessageBase::Kind::recv, mp_pol, exec_policy>
       assert(buf != nullptr);
       const int partner_rank = msg->partner_rank;
       // const int tag = msg->msg_tag;
-      const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      const IdxT nbytes = msg->nbytes();
       // FGPRINTF(FileGroup::proc, "%p Irecv %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
       message_request_type& msg_request = m_msg_requests[msg->idx];
       detail::mp::receive(con_comm.g, partner_rank, msg_request.region.mr, msg_request.region.offset, nbytes);
@@ -1139,15 +1139,9 @@ struct MessageGroup<MessageBase::Kind::recv, mp_pol, exec_policy>
       this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
       for (const MessageItemBase* msg_item : msg->message_items) {
         const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-        const IdxT len = item->size;
         const IdxT nbytes = item->nbytes;
-        LidxT const* indices = item->indices;
-        for (DataT* dst : this->m_variables) {
-          // FGPRINTF(FileGroup::proc, "%p unpack %p[%p] = %p len %d\n", this, dst, indices, buf, len);
-          this->m_contexts[msg->idx].for_all(0, len, make_copy_idxr_idxr(static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{},
-                                             dst, detail::indexer_list_idx{indices}));
-          buf += nbytes;
-        }
+        unpack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+        buf += nbytes;
       }
       this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
     }
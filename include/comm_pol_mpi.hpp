@@ -24,6 +24,7 @@
 #include "utils.hpp"
 #include "utils_mpi.hpp"
 #include "MessageBase.hpp"
+#include "compress.hpp"
 #include "ExecContext.hpp"
 
 struct mpi_pol {
@@ -31,6 +32,12 @@ struct mpi_pol {
   static const bool mock = false;
   // compile mpi_type packing/unpacking tests for this comm policy
   static const bool use_mpi_type = true;
+  // message buffers may be kept across cycles
+  static const bool persistent_buffers = true;
+  // fused pack arrays may come from the comm util arena
+  static const bool util_arena = true;
+  // message buffers are placed per message group
+  static const bool slab_buffers = false;
   static const char* get_name() { return "mpi"; }
   using send_request_type = MPI_Request;
   using recv_request_type = MPI_Request;
@@ -120,6 +127,23 @@ struct Message<MessageBase::Kind::send, mpi_pol>
   using request_type      = typename base::request_type;
   using status_type       = typename base::status_type;
 
+  // compressed message buffer, nullptr when not compressing
+  void* zbuf = nullptr;
+
+  // set when the message is sent in place in the mesh instead of buf,
+  // as in_place_count elements of in_place_type at in_place_buf
+  bool in_place = false;
+  void* in_place_buf = nullptr;
+  int in_place_count = 0;
+  MPI_Datatype in_place_type = MPI_DATATYPE_NULL;
+
+  // request created once by groups using persistent requests
+  MPI_Request persistent_request = MPI_REQUEST_NULL;
+
+  // set when the partner is on the node and the buffer is in the shared
+  // window of the receiving rank, no data is sent with the message
+  bool on_node = false;
+
   // use the base class constructor
   using base::base;
 
@@ -179,6 +203,23 @@ struct Message<MessageBase::Kind::recv, mpi_pol>
   using request_type      = typename base::request_type;
   using status_type       = typename base::status_type;
 
+  // compressed message buffer, nullptr when not compressing
+  void* zbuf = nullptr;
+
+  // set when the message is received in place in the mesh instead of buf,
+  // as in_place_count elements of in_place_type at in_place_buf
+  bool in_place = false;
+  void* in_place_buf = nullptr;
+  int in_place_count = 0;
+  MPI_Datatype in_place_type = MPI_DATATYPE_NULL;
+
+  // request created once by groups using persistent requests
+  MPI_Request persistent_request = MPI_REQUEST_NULL;
+
+  // set when the partner is on the node and the buffer is in the shared
+  // window of the receiving rank, no data is sent with the message
+  bool on_node = false;
+
   // use the base class constructor
   using base::base;
 
@@ -227,6 +268,125 @@ struct Message<MessageBase::Kind::recv, mpi_pol>
 };
 
 
+inline bool message_has_buffer(Message<MessageBase::Kind::send, mpi_pol> const& msg)
+{
+  return !msg.in_place;
+}
+
+inline bool message_has_buffer(Message<MessageBase::Kind::recv, mpi_pol> const& msg)
+{
+  return !msg.in_place;
+}
+
+// posts a send of a message, with persistent requests the request of the
+// message is created on its first post and only copied into request after,
+// the caller starts the requests of all the messages it posted together
+inline void post_send(Message<MessageBase::Kind::send, mpi_pol>& msg, bool persistent,
+                      void const* buf, int count, MPI_Datatype mpi_type,
+                      MPI_Comm comm, MPI_Request* request)
+{
+  if (!persistent) {
+    detail::MPI::Isend(buf, count, mpi_type, msg.partner_rank, msg.msg_tag, comm, request);
+  } else {
+    if (msg.persistent_request == MPI_REQUEST_NULL) {
+      detail::MPI::Send_init(buf, count, mpi_type, msg.partner_rank, msg.msg_tag, comm, &msg.persistent_request);
+    }
+    *request = msg.persistent_request;
+  }
+}
+
+inline void post_recv(Message<MessageBase::Kind::recv, mpi_pol>& msg, bool persistent,
+                      void* buf, int count, MPI_Datatype mpi_type,
+                      MPI_Comm comm, MPI_Request* request)
+{
+  if (!persistent) {
+    detail::MPI::Irecv(buf, count, mpi_type, msg.partner_rank, msg.msg_tag, comm, request);
+  } else {
+    if (msg.persistent_request == MPI_REQUEST_NULL) {
+      detail::MPI::Recv_init(buf, count, mpi_type, msg.partner_rank, msg.msg_tag, comm, &msg.persistent_request);
+    }
+    *request = msg.persistent_request;
+  }
+}
+
+template < typename message_type >
+inline void free_persistent_requests(std::vector<message_type>& messages)
+{
+  for (message_type& msg : messages) {
+    if (msg.persistent_request != MPI_REQUEST_NULL) {
+      detail::MPI::Request_free(&msg.persistent_request);
+    }
+  }
+}
+
+
+// messages with a single strided item are sent or received in place when
+// allowed, the data matches the buffer the partner packs or unpacks
+template < typename message_group_type >
+inline void setup_in_place_messages(MessageBase::Kind kind, message_group_type& group, bool allow)
+{
+  IdxT num_vars = group.m_variables.size();
+  for (var_section const& sec : group.m_sections) {
+    allow = allow && (wire_elem_size(sec.type, sec.wire) == elem_type_size(sec.type));
+  }
+  allow = allow && (num_vars == 1 || group.m_layout == BufferLayout::variable);
+
+  for (auto& msg : group.messages) {
+    const char* path = "no";
+    MessageItemBase const* item = (msg.message_items.size() == 1) ? msg.message_items.front() : nullptr;
+    if (allow && item != nullptr && item->strided &&
+        item->nbytes == item->size * group.m_zone_nbytes) {
+      box_runs const& box = item->strided_box;
+      if (num_vars == 1 && box.row_runs == 1 && box.num_rows == 1) {
+        ElemType type = group.m_var_types.front();
+        msg.in_place_buf = static_cast<char*>(group.m_variables.front()) + box.offset * elem_type_size(type);
+        msg.in_place_count = item->nbytes;
+        msg.in_place_type = MPI_BYTE;
+        path = "contiguous";
+      } else {
+        // a vector of runs in each variable in buffer order
+        IdxT count  = (box.row_runs == 1) ? box.num_rows   : box.row_runs;
+        IdxT stride = (box.row_runs == 1) ? box.row_stride : box.run_stride;
+        std::vector<int> blocklengths(num_vars, 1);
+        std::vector<MPI_Aint> displacements;
+        std::vector<MPI_Datatype> types;
+        for (var_section const& sec : group.m_sections) {
+          for (IdxT v = sec.first; v < sec.first + sec.num_vars; ++v) {
+            char* var = static_cast<char*>(group.m_variables[v]) + box.offset * elem_type_size(sec.type);
+            displacements.emplace_back(detail::MPI::Get_address(var));
+            types.emplace_back(detail::MPI::Type_vector(count, box.run_len, stride, detail::MPI::elem_mpi_type(sec.type)));
+          }
+        }
+        msg.in_place_buf = MPI_BOTTOM;
+        msg.in_place_count = 1;
+        msg.in_place_type = detail::MPI::Type_create_struct(num_vars, blocklengths.data(), displacements.data(), types.data());
+        detail::MPI::Type_commit(&msg.in_place_type);
+        for (MPI_Datatype& type : types) {
+          detail::MPI::Type_free(&type);
+        }
+        path = "strided";
+      }
+      msg.in_place = true;
+    }
+    if (comb_allow_zero_copy()) {
+      fgprintf(FileGroup::proc, "Message %s partner %i tag %i zero-copy %s\n",
+                                (kind == MessageBase::Kind::send) ? "send" : "recv",
+                                msg.partner_rank, msg.msg_tag, path);
+    }
+  }
+}
+
+template < typename message_type >
+inline void free_in_place_messages(std::vector<message_type>& messages)
+{
+  for (message_type& msg : messages) {
+    if (msg.in_place_type != MPI_DATATYPE_NULL && msg.in_place_type != MPI_BYTE) {
+      detail::MPI::Type_free(&msg.in_place_type);
+    }
+    msg.in_place = false;
+  }
+}
+
 template < typename exec_policy >
 struct MessageGroup<MessageBase::Kind::send, mpi_pol, exec_policy>
   : detail::MessageGroupInterface<MessageBase::Kind::send, mpi_pol, exec_policy>
@@ -245,50 +405,73 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, exec_policy>
   using group_type        = typename base::group_type;
   using component_type    = typename base::component_type;
 
-  // vars for fused loops
-  DataT const** m_srcs = nullptr;
+  // codec for message buffers, created in allocate
+  Compression m_compression = detail::packs_on_host<exec_policy>::value ? comb_compression() : Compression::none;
+  std::unique_ptr<COMB::Codec> m_codec;
 
-  DataT**       m_bufs = nullptr;
-  LidxT const** m_idxs = nullptr;
-  IdxT*         m_lens = nullptr;
-  IdxT m_pos = 0;
+  // requests are created once and started every cycle
+  bool m_persistent_requests = false;
 
   // use the base class constructor
   using base::base;
 
+  ~MessageGroup()
+  {
+    free_persistent_requests(this->messages);
+    free_in_place_messages(this->messages);
+    for (message_type& msg : this->messages) {
+      if (msg.zbuf != nullptr) {
+        this->m_aloc.deallocate(msg.zbuf);
+        msg.zbuf = nullptr;
+      }
+    }
+  }
+
+  void finalize()
+  {
+    base::finalize();
+    setup_in_place_messages(MessageBase::Kind::send, *this,
+        comb_allow_zero_copy() && detail::packs_on_host<exec_policy>::value &&
+        m_compression == Compression::none);
+  }
+
+  // persistent requests need buffers at fixed addresses and messages of
+  // fixed size, so buffers are kept and not compressed
+  void use_persistent_requests()
+  {
+    m_persistent_requests = true;
+    this->m_persistent_buffers = true;
+    m_compression = Compression::none;
+  }
+
 
   void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
   {
     COMB::ignore_unused(con, con_comm);
     if (len <= 0) return;
+    if (m_compression != Compression::none && !m_codec) {
+      // shuffle by the largest element size, sections are sorted by it
+      IdxT elem_size = this->m_sections.empty() ? 1
+                     : wire_elem_size(this->m_sections.front().type, this->m_sections.front().wire);
+      m_codec = COMB::make_codec(m_compression, elem_size);
+    }
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (msg->in_place) continue;
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       msg->buf = this->m_aloc.allocate(nbytes);
-    }
 
-    if (comb_allow_pack_loop_fusion() && m_srcs == nullptr) {
-
-      // allocate per variable vars
-      IdxT num_vars = this->m_variables.size();
-      m_srcs = (DataT const**)con.util_aloc.allocate(num_vars*sizeof(DataT const*));
-
-      // variable vars initialized here
-      for (IdxT i = 0; i < num_vars; ++i) {
-        m_srcs[i] = this->m_variables[i];
+      if (m_codec) {
+        assert(msg->zbuf == nullptr);
+        msg->zbuf = this->m_aloc.allocate(COMB::compressed_message_max_nbytes(*m_codec, nbytes));
       }
-
-      // allocate per item vars
-      IdxT num_items = this->m_items.size();
-      m_bufs = (DataT**)      con.util_aloc.allocate(num_items*sizeof(DataT*));
-      m_idxs = (LidxT const**)con.util_aloc.allocate(num_items*sizeof(LidxT const*));
-      m_lens = (IdxT*)        con.util_aloc.allocate(num_items*sizeof(IdxT));
-
-      // item vars initialized in pack
     }
+
+    this->allocate_fused_vars(con);
   }
 
   void pack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
@@ -299,20 +482,15 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, exec_policy>
     if (!comb_allow_pack_loop_fusion()) {
       for (IdxT i = 0; i < len; ++i) {
         const message_type* msg = msgs[i];
+        if (msg->in_place) continue;
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT len = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          for (DataT const* src : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] len %d\n", this, buf, src, indices, len);
-            this->m_contexts[msg->idx].for_all(0, len, make_copy_idxr_idxr(src, detail::indexer_list_idx{indices},
-                                               static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{}));
-            buf += nbytes;
-          }
+          pack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
         }
         if (async == detail::Async::no) {
           this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
@@ -322,65 +500,58 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, exec_policy>
       }
     }
     else if (async == detail::Async::no) {
-      IdxT num_vars = this->m_variables.size();
-      DataT const** srcs = m_srcs;
-      DataT**       bufs = m_bufs + m_pos;
-      LidxT const** idxs = m_idxs + m_pos;
-      IdxT*         lens = m_lens + m_pos;
       IdxT total_items = 0;
       IdxT num_fused = 0;
+      IdxT num_in_place = 0;
       for (IdxT i = 0; i < len; ++i) {
         const message_type* msg = msgs[i];
+        if (msg->in_place) {
+          num_in_place += msg->message_items.size();
+          continue;
+        }
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
       }
       // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
-      IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-      con.fused(num_fused, num_vars, avg_items, fused_packer(srcs, bufs, idxs, lens));
-      m_pos += num_fused;
+      if (num_fused > 0) {
+        IdxT avg_items = (total_items + num_fused - 1) / num_fused;
+        fused_pack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      }
+      this->m_fused.pos += num_fused + num_in_place;
     } else {
-      IdxT num_vars = this->m_variables.size();
       for (IdxT i = 0; i < len; ++i) {
         const message_type* msg = msgs[i];
+        if (msg->in_place) {
+          this->m_fused.pos += msg->message_items.size();
+          continue;
+        }
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
-        DataT const** srcs = m_srcs;
-        DataT**       bufs = m_bufs + m_pos;
-        LidxT const** idxs = m_idxs + m_pos;
-        IdxT*         lens = m_lens + m_pos;
         IdxT total_items = 0;
         IdxT num_fused = 0;
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
         // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
         IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-        this->m_contexts[msg->idx].fused(num_fused, num_vars, avg_items, fused_packer(srcs, bufs, idxs, lens));
-        m_pos += num_fused;
+        fused_pack(this->m_contexts[msg->idx], this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+        this->m_fused.pos += num_fused;
         this->m_contexts[msg->idx].finish_component_recordEvent(this->m_groups[len-1], this->m_components[msg->idx], this->m_events[msg->idx]);
       }
     }
@@ -415,15 +586,25 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, exec_policy>
     if (len <= 0) return;
     start_Isends(con, con_comm);
     for (IdxT i = 0; i < len; ++i) {
-      const message_type* msg = msgs[i];
+      message_type* msg = msgs[i];
+      if (msg->in_place) {
+        post_send(*msg, m_persistent_requests, msg->in_place_buf, msg->in_place_count, msg->in_place_type,
+                  con_comm.comm, &requests[i]);
+        continue;
+      }
       char* buf = static_cast<char*>(msg->buf);
       assert(buf != nullptr);
-      const int partner_rank = msg->partner_rank;
-      const int tag = msg->msg_tag;
-      const IdxT nbytes = msg->nbytes() * this->m_variables.size();
-      // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
-      detail::MPI::Isend(buf, nbytes, MPI_BYTE,
-                         partner_rank, tag, con_comm.comm, &requests[i]);
+      IdxT nbytes = msg->nbytes();
+      if (msg->zbuf != nullptr) {
+        nbytes = COMB::compress_message(*m_codec, buf, nbytes, msg->zbuf);
+        buf = static_cast<char*>(msg->zbuf);
+      }
+      // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %d to %i tag %i\n", this, buf, nbytes, msg->partner_rank, msg->msg_tag);
+      post_send(*msg, m_persistent_requests, buf, nbytes, MPI_BYTE,
+                con_comm.comm, &requests[i]);
+    }
+    if (m_persistent_requests) {
+      detail::MPI::Startall(len, requests);
     }
     finish_Isends(con, con_comm);
   }
@@ -440,27 +621,23 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
+      if (msg->in_place) continue;
       assert(msg->buf != nullptr);
 
       this->m_aloc.deallocate(msg->buf);
 
       msg->buf = nullptr;
-    }
-
-    if (comb_allow_pack_loop_fusion() && m_srcs != nullptr && m_pos == static_cast<IdxT>(this->m_items.size())) {
 
-      // deallocate per variable vars
-      con.util_aloc.deallocate(m_srcs); m_srcs = nullptr;
-
-      // deallocate per item vars
-      con.util_aloc.deallocate(m_bufs); m_bufs = nullptr;
-      con.util_aloc.deallocate(m_idxs); m_idxs = nullptr;
-      con.util_aloc.deallocate(m_lens); m_lens = nullptr;
-
-      // reset pos
-      m_pos = 0;
+      if (msg->zbuf != nullptr) {
+        this->m_aloc.deallocate(msg->zbuf);
+        msg->zbuf = nullptr;
+      }
     }
+
+    this->deallocate_fused_vars();
   }
+
 };
 
 template < typename exec_policy >
@@ -481,50 +658,73 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, exec_policy>
   using group_type        = typename base::group_type;
   using component_type    = typename base::component_type;
 
-  // fused loop vars
-  DataT**       m_dsts = nullptr;
+  // codec for message buffers, created in allocate
+  Compression m_compression = detail::packs_on_host<exec_policy>::value ? comb_compression() : Compression::none;
+  std::unique_ptr<COMB::Codec> m_codec;
 
-  DataT const** m_bufs = nullptr;
-  LidxT const** m_idxs = nullptr;
-  IdxT*         m_lens = nullptr;
-  IdxT m_pos = 0;
+  // requests are created once and started every cycle
+  bool m_persistent_requests = false;
 
   // use the base class constructor
   using base::base;
 
+  ~MessageGroup()
+  {
+    free_persistent_requests(this->messages);
+    free_in_place_messages(this->messages);
+    for (message_type& msg : this->messages) {
+      if (msg.zbuf != nullptr) {
+        this->m_aloc.deallocate(msg.zbuf);
+        msg.zbuf = nullptr;
+      }
+    }
+  }
+
+  void finalize()
+  {
+    base::finalize();
+    setup_in_place_messages(MessageBase::Kind::recv, *this,
+        comb_allow_zero_copy() && detail::packs_on_host<exec_policy>::value &&
+        m_compression == Compression::none);
+  }
+
+  // persistent requests need buffers at fixed addresses and messages of
+  // fixed size, so buffers are kept and not compressed
+  void use_persistent_requests()
+  {
+    m_persistent_requests = true;
+    this->m_persistent_buffers = true;
+    m_compression = Compression::none;
+  }
+
 
   void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
   {
     COMB::ignore_unused(con, con_comm);
     if (len <= 0) return;
+    if (m_compression != Compression::none && !m_codec) {
+      // shuffle by the largest element size, sections are sorted by it
+      IdxT elem_size = this->m_sections.empty() ? 1
+                     : wire_elem_size(this->m_sections.front().type, this->m_sections.front().wire);
+      m_codec = COMB::make_codec(m_compression, elem_size);
+    }
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (msg->in_place) continue;
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       msg->buf = this->m_aloc.allocate(nbytes);
-    }
-
-    if (comb_allow_pack_loop_fusion() && m_dsts == nullptr) {
-
-      // allocate per variable vars
-      IdxT num_vars = this->m_variables.size();
-      m_dsts = (DataT**)con.util_aloc.allocate(num_vars*sizeof(DataT*));
 
-      // variable vars initialized here
-      for (IdxT i = 0; i < num_vars; ++i) {
-        m_dsts[i] = this->m_variables[i];
+      if (m_codec) {
+        assert(msg->zbuf == nullptr);
+        msg->zbuf = this->m_aloc.allocate(COMB::compressed_message_max_nbytes(*m_codec, nbytes));
       }
-
-      // allocate per item vars
-      IdxT num_items = this->m_items.size();
-      m_bufs = (DataT const**)con.util_aloc.allocate(num_items*sizeof(DataT const*));
-      m_idxs = (LidxT const**)con.util_aloc.allocate(num_items*sizeof(LidxT const*));
-      m_lens = (IdxT*)        con.util_aloc.allocate(num_items*sizeof(IdxT));
-
-      // item vars initialized in pack
     }
+
+    this->allocate_fused_vars(con);
   }
 
   void Irecv(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
@@ -532,15 +732,25 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, exec_policy>
     COMB::ignore_unused(con, con_comm);
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
-      const message_type* msg = msgs[i];
+      message_type* msg = msgs[i];
+      if (msg->in_place) {
+        post_recv(*msg, m_persistent_requests, msg->in_place_buf, msg->in_place_count, msg->in_place_type,
+                  con_comm.comm, &requests[i]);
+        continue;
+      }
       char* buf = static_cast<char*>(msg->buf);
       assert(buf != nullptr);
-      const int partner_rank = msg->partner_rank;
-      const int tag = msg->msg_tag;
-      const IdxT nbytes = msg->nbytes() * this->m_variables.size();
-      // FGPRINTF(FileGroup::proc, "%p Irecv %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
-      detail::MPI::Irecv(buf, nbytes, MPI_BYTE,
-                         partner_rank, tag, con_comm.comm, &requests[i]);
+      IdxT nbytes = msg->nbytes();
+      if (msg->zbuf != nullptr) {
+        nbytes = COMB::compressed_message_max_nbytes(*m_codec, nbytes);
+        buf = static_cast<char*>(msg->zbuf);
+      }
+      // FGPRINTF(FileGroup::proc, "%p Irecv %p nbytes %d to %i tag %i\n", this, buf, nbytes, msg->partner_rank, msg->msg_tag);
+      post_recv(*msg, m_persistent_requests, buf, nbytes, MPI_BYTE,
+                con_comm.comm, &requests[i]);
+    }
+    if (m_persistent_requests) {
+      detail::MPI::Startall(len, requests);
     }
   }
 
@@ -548,58 +758,57 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, exec_policy>
   {
     COMB::ignore_unused(con_comm);
     if (len <= 0) return;
+    if (m_codec) {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        COMB::decompress_message(*m_codec, msg->zbuf, msg->buf, msg->nbytes());
+      }
+    }
     con.start_group(this->m_groups[len-1]);
     if (!comb_allow_pack_loop_fusion()) {
       for (IdxT i = 0; i < len; ++i) {
         const message_type* msg = msgs[i];
+        if (msg->in_place) continue;
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
         this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT len = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          for (DataT* dst : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p unpack %p[%p] = %p len %d\n", this, dst, indices, buf, len);
-            this->m_contexts[msg->idx].for_all(0, len, make_copy_idxr_idxr(static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{},
-                                               dst, detail::indexer_list_idx{indices}));
-            buf += nbytes;
-          }
+          unpack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
         }
         this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
       }
     }
     else {
-      IdxT num_vars = this->m_variables.size();
-      DataT**       dsts = m_dsts;
-      DataT const** bufs = m_bufs + m_pos;
-      LidxT const** idxs = m_idxs + m_pos;
-      IdxT*         lens = m_lens + m_pos;
       IdxT total_items = 0;
       IdxT num_fused = 0;
+      IdxT num_in_place = 0;
       for (IdxT i = 0; i < len; ++i) {
         const message_type* msg = msgs[i];
+        if (msg->in_place) {
+          num_in_place += msg->message_items.size();
+          continue;
+        }
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
         for (const MessageItemBase* msg_item : msg->message_items) {
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-          const IdxT nitems = item->size;
           const IdxT nbytes = item->nbytes;
-          LidxT const* indices = item->indices;
-          bufs[num_fused] = (DataT const*)buf;
-          idxs[num_fused] = indices;
-          lens[num_fused] = nitems;
-          total_items += nitems;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
           num_fused += 1;
-          buf += nbytes * num_vars;
-          assert(static_cast<IdxT>(nitems*sizeof(DataT)) == nbytes);
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
         }
       }
       // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, dst, indices, nitems);
-      IdxT avg_items = (total_items + num_fused - 1) / num_fused;
-      con.fused(num_fused, num_vars, avg_items, fused_unpacker(dsts, bufs, idxs, lens));
-      m_pos += num_fused;
+      if (num_fused > 0) {
+        IdxT avg_items = (total_items + num_fused - 1) / num_fused;
+        fused_unpack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      }
+      this->m_fused.pos += num_fused + num_in_place;
     }
     con.finish_group(this->m_groups[len-1]);
   }
@@ -610,27 +819,23 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
+      if (msg->in_place) continue;
       assert(msg->buf != nullptr);
 
       this->m_aloc.deallocate(msg->buf);
 
       msg->buf = nullptr;
-    }
 
-    if (comb_allow_pack_loop_fusion() && m_dsts != nullptr && m_pos == static_cast<IdxT>(this->m_items.size())) {
-
-      // deallocate per variable vars
-      con.util_aloc.deallocate(m_dsts); m_dsts = nullptr;
-
-      // deallocate per item vars
-      con.util_aloc.deallocate(m_bufs); m_bufs = nullptr;
-      con.util_aloc.deallocate(m_idxs); m_idxs = nullptr;
-      con.util_aloc.deallocate(m_lens); m_lens = nullptr;
-
-      // reset pos
-      m_pos = 0;
+      if (msg->zbuf != nullptr) {
+        this->m_aloc.deallocate(msg->zbuf);
+        msg->zbuf = nullptr;
+      }
     }
+
+    this->deallocate_fused_vars();
   }
+
 };
 
 
@@ -652,9 +857,24 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, mpi_type_pol>
   using group_type        = typename base::group_type;
   using component_type    = typename base::component_type;
 
+  // requests are created once and started every cycle
+  bool m_persistent_requests = false;
+
   // use the base class constructor
   using base::base;
 
+  ~MessageGroup()
+  {
+    free_persistent_requests(this->messages);
+  }
+
+  // persistent requests need buffers at fixed addresses
+  void use_persistent_requests()
+  {
+    m_persistent_requests = true;
+    this->m_persistent_buffers = true;
+  }
+
 
   void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
   {
@@ -662,12 +882,13 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, mpi_type_pol>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
         // no buffer needed
       } else {
-        IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        IdxT nbytes = msg->nbytes();
 
         msg->buf = this->m_aloc.allocate(nbytes);
       }
@@ -687,16 +908,18 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, mpi_type_pol>
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
         int pos = 0;
-        const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        const IdxT nbytes = msg->nbytes();
         for (MessageItemBase* msg_item : msg->message_items) {
           message_item_type* item = static_cast<message_item_type*>(msg_item);
           const IdxT len = 1;
-          MPI_Datatype mpi_type = item->mpi_type;
           int old_pos = pos;
-          for (DataT const* src : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p pack %p[%i] = %p\n", this, buf, pos, src);
-            detail::MPI::Pack(src, len, mpi_type,
-                              buf, nbytes, &pos, con_comm.comm);
+          for (IdxT s = 0; s < static_cast<IdxT>(this->m_sections.size()); ++s) {
+            var_section const& sec = this->m_sections[s];
+            for (IdxT j = sec.first; j < sec.first + sec.num_vars; ++j) {
+              void const* src = this->m_variables[j];
+              detail::MPI::Pack(src, len, item->mpi_types[s],
+                                buf, nbytes, &pos, con_comm.comm);
+            }
           }
           item->packed_nbytes = pos - old_pos;
         }
@@ -738,17 +961,15 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, mpi_type_pol>
     if (len <= 0) return;
     start_Isends(con, con_comm);
     for (IdxT i = 0; i < len; ++i) {
-      const message_type* msg = msgs[i];
-      const int partner_rank = msg->partner_rank;
-      const int tag = msg->msg_tag;
+      message_type* msg = msgs[i];
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
-        const DataT* src = this->m_variables.front();
+        void const* src = this->m_variables.front();
         const IdxT len = 1;
         const message_item_type* item = static_cast<const message_item_type*>(msg->message_items.front());
-        MPI_Datatype mpi_type = item->mpi_type;
-        // FGPRINTF(FileGroup::proc, "%p Isend %p to %i tag %i\n", this, src, partner_rank, tag);
-        detail::MPI::Isend(src, len, mpi_type,
-                           partner_rank, tag, con_comm.comm, &requests[i]);
+        MPI_Datatype mpi_type = item->mpi_types.front();
+        // FGPRINTF(FileGroup::proc, "%p Isend %p to %i tag %i\n", this, src, msg->partner_rank, msg->msg_tag);
+        post_send(*msg, m_persistent_requests, src, len, mpi_type,
+                  con_comm.comm, &requests[i]);
       } else {
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
@@ -757,11 +978,14 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, mpi_type_pol>
           const message_item_type* item = static_cast<const message_item_type*>(msg_item);
           packed_nbytes += item->packed_nbytes;
         }
-        // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %i to %i tag %i\n", this, buf, packed_nbytes, partner_rank, tag);
-        detail::MPI::Isend(buf, packed_nbytes, MPI_PACKED,
-                           partner_rank, tag, con_comm.comm, &requests[i]);
+        // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %i to %i tag %i\n", this, buf, packed_nbytes, msg->partner_rank, msg->msg_tag);
+        post_send(*msg, m_persistent_requests, buf, packed_nbytes, MPI_PACKED,
+                  con_comm.comm, &requests[i]);
       }
     }
+    if (m_persistent_requests) {
+      detail::MPI::Startall(len, requests);
+    }
     finish_Isends(con, con_comm);
   }
 
@@ -777,6 +1001,7 @@ struct MessageGroup<MessageBase::Kind::send, mpi_pol, mpi_type_pol>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
         // buf not allocated
         assert(msg->buf == nullptr);
@@ -807,9 +1032,24 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, mpi_type_pol>
   using group_type        = typename base::group_type;
   using component_type    = typename base::component_type;
 
+  // requests are created once and started every cycle
+  bool m_persistent_requests = false;
+
   // use the base class constructor
   using base::base;
 
+  ~MessageGroup()
+  {
+    free_persistent_requests(this->messages);
+  }
+
+  // persistent requests need buffers at fixed addresses
+  void use_persistent_requests()
+  {
+    m_persistent_requests = true;
+    this->m_persistent_buffers = true;
+  }
+
 
   void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
   {
@@ -817,12 +1057,13 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, mpi_type_pol>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
         // no buffer needed
       } else {
-        IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        IdxT nbytes = msg->nbytes();
 
         msg->buf = this->m_aloc.allocate(nbytes);
       }
@@ -834,29 +1075,30 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, mpi_type_pol>
     COMB::ignore_unused(con, con_comm);
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
-      const message_type* msg = msgs[i];
+      message_type* msg = msgs[i];
       char* buf = static_cast<char*>(msg->buf);
       assert(buf != nullptr);
-      const int partner_rank = msg->partner_rank;
-      const int tag = msg->msg_tag;
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
-        DataT* dst = m_variables.front();
+        void* dst = this->m_variables.front();
         assert(dst != nullptr);
         IdxT len = 1;
         const message_item_type* item = static_cast<const message_item_type*>(msg->message_items.front());
-        MPI_Datatype mpi_type = item->mpi_type;
-        // FGPRINTF(FileGroup::proc, "%p Irecv %p to %i tag %i\n", this, dst, partner_rank, tag);
-        detail::MPI::Irecv(dst, len, mpi_type,
-                           partner_rank, tag, con_comm.comm, &requests[i]);
+        MPI_Datatype mpi_type = item->mpi_types.front();
+        // FGPRINTF(FileGroup::proc, "%p Irecv %p to %i tag %i\n", this, dst, msg->partner_rank, msg->msg_tag);
+        post_recv(*msg, m_persistent_requests, dst, len, mpi_type,
+                  con_comm.comm, &requests[i]);
       } else {
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
-        const IdxT nbytes = msg->nbytes() * this->m_variables.size();
-        // FGPRINTF(FileGroup::proc, "%p Irecv %p maxnbytes %i to %i tag %i\n", this, dst, nbytes, partner_rank, tag);
-        detail::MPI::Irecv(buf, nbytes, MPI_PACKED,
-                           partner_rank, tag, con_comm.comm, &requests[i]);
+        const IdxT nbytes = msg->nbytes();
+        // FGPRINTF(FileGroup::proc, "%p Irecv %p maxnbytes %i to %i tag %i\n", this, dst, nbytes, msg->partner_rank, msg->msg_tag);
+        post_recv(*msg, m_persistent_requests, buf, nbytes, MPI_PACKED,
+                  con_comm.comm, &requests[i]);
       }
     }
+    if (m_persistent_requests) {
+      detail::MPI::Startall(len, requests);
+    }
   }
 
   void unpack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
@@ -872,17 +1114,19 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, mpi_type_pol>
       } else {
         char* buf = static_cast<char*>(msg->buf);
         assert(buf != nullptr);
-        const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+        const IdxT nbytes = msg->nbytes();
         int pos = 0;
         for (MessageItemBase* msg_item : msg->message_items) {
           message_item_type* item = static_cast<message_item_type*>(msg_item);
           const IdxT len = 1;
-          MPI_Datatype mpi_type = item->mpi_type;
           int old_pos = pos;
-          for (DataT* dst : this->m_variables) {
-            // FGPRINTF(FileGroup::proc, "%p unpack %p = %p[%i]\n", this, dst, buf, pos);
-            detail::MPI::Unpack(buf, nbytes, &pos,
-                                dst, len, mpi_type, con_comm.comm);
+          for (IdxT s = 0; s < static_cast<IdxT>(this->m_sections.size()); ++s) {
+            var_section const& sec = this->m_sections[s];
+            for (IdxT j = sec.first; j < sec.first + sec.num_vars; ++j) {
+              void* dst = this->m_variables[j];
+              detail::MPI::Unpack(buf, nbytes, &pos,
+                                  dst, len, item->mpi_types[s], con_comm.comm);
+            }
           }
           item->packed_nbytes = pos - old_pos;
         }
@@ -898,6 +1142,7 @@ struct MessageGroup<MessageBase::Kind::recv, mpi_pol, mpi_type_pol>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
       if (msg->message_items.size() == 1 && this->m_variables.size() == 1) {
         // buf not allocated
         assert(msg->buf == nullptr);
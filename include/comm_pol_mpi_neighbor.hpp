@@ -0,0 +1,995 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _COMM_POL_MPI_NEIGHBOR_HPP
+#define _COMM_POL_MPI_NEIGHBOR_HPP
+
+#include "config.hpp"
+
+#ifdef COMB_ENABLE_MPI
+
+#include <climits>
+#include <unordered_map>
+
+#include "for_all.hpp"
+#include "utils.hpp"
+#include "utils_mpi.hpp"
+#include "MessageBase.hpp"
+#include "ExecContext.hpp"
+
+// mpi communication with neighborhood collectives, the partners of the comm
+// form a distributed graph communicator and every message of a cycle is
+// exchanged by one nonblocking collective started when the last send is
+// posted, packed buffers go through MPI_Ineighbor_alltoallv and mpi_type
+// messages through MPI_Ineighbor_alltoallw with their datatypes
+struct mpi_neighbor_pol {
+  // static const bool async = false;
+  static const bool mock = false;
+  // compile mpi_type packing/unpacking tests for this comm policy
+  static const bool use_mpi_type = true;
+  // message buffers may be kept across cycles
+  static const bool persistent_buffers = true;
+  // fused pack arrays may come from the comm util arena
+  static const bool util_arena = true;
+  // messages stay in the many group with the buffers of each direction in
+  // one slab the collective addresses from one base
+  static const bool slab_buffers = true;
+  static const char* get_name() { return "mpi_neighbor"; }
+  using send_request_type = int;
+  using recv_request_type = int;
+  using send_status_type = int;
+  using recv_status_type = int;
+};
+
+template < >
+struct CommContext<mpi_neighbor_pol> : MPIContext
+{
+  using base = MPIContext;
+
+  using pol = mpi_neighbor_pol;
+
+  using send_request_type = typename pol::send_request_type;
+  using recv_request_type = typename pol::recv_request_type;
+  using send_status_type = typename pol::send_status_type;
+  using recv_status_type = typename pol::recv_status_type;
+
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  // graph communicator over the partners, built in connect_ranks
+  MPI_Comm graph_comm = MPI_COMM_NULL;
+
+  // neighbor index of each partner rank in the graph
+  std::unordered_map<int, int> send_neighbors;
+  std::unordered_map<int, int> recv_neighbors;
+
+  // collective arguments in neighbor order, filled as messages are posted
+  std::vector<void const*> send_bufs;
+  std::vector<void*> recv_bufs;
+  std::vector<int> send_counts;
+  std::vector<int> recv_counts;
+  std::vector<MPI_Datatype> send_types;
+  std::vector<MPI_Datatype> recv_types;
+  int num_sends_posted = 0;
+  int num_recvs_posted = 0;
+  // set when a message is posted with a datatype other than MPI_BYTE
+  bool typed = false;
+
+  // collective of the current cycle, shared by every message
+  MPI_Request request = MPI_REQUEST_NULL;
+
+  CommContext()
+    : base()
+  { }
+
+  CommContext(base const& b)
+    : base(b)
+  { }
+
+  CommContext(CommContext const& a_, MPI_Comm comm_)
+    : base(a_)
+    , comm(comm_)
+  { }
+
+  void ensure_waitable()
+  {
+
+  }
+
+  template < typename context >
+  void waitOn(context& con)
+  {
+    con.ensure_waitable();
+    base::waitOn(con);
+  }
+
+  send_request_type send_request_null() { return 0; }
+  recv_request_type recv_request_null() { return 0; }
+  send_status_type send_status_null() { return 0; }
+  recv_status_type recv_status_null() { return 0; }
+
+  void connect_ranks(std::vector<int> const& send_ranks,
+                     std::vector<int> const& recv_ranks)
+  {
+    int num_sends = send_ranks.size();
+    int num_recvs = recv_ranks.size();
+    for (int i = 0; i < num_sends; ++i) {
+      send_neighbors.emplace(send_ranks[i], i);
+    }
+    for (int i = 0; i < num_recvs; ++i) {
+      recv_neighbors.emplace(recv_ranks[i], i);
+    }
+    // keep the ranks of comm, the partners are given in comm
+    graph_comm = detail::MPI::Dist_graph_create_adjacent(comm,
+        num_recvs, recv_ranks.data(), num_sends, send_ranks.data(), 0);
+
+    send_bufs.assign(num_sends, nullptr);
+    send_counts.assign(num_sends, 0);
+    send_types.assign(num_sends, MPI_BYTE);
+    recv_bufs.assign(num_recvs, nullptr);
+    recv_counts.assign(num_recvs, 0);
+    recv_types.assign(num_recvs, MPI_BYTE);
+  }
+
+  void disconnect_ranks(std::vector<int> const& send_ranks,
+                        std::vector<int> const& recv_ranks)
+  {
+    COMB::ignore_unused(send_ranks, recv_ranks);
+    assert(request == MPI_REQUEST_NULL);
+    if (graph_comm != MPI_COMM_NULL) {
+      detail::MPI::Comm_free(&graph_comm);
+    }
+    send_neighbors.clear();
+    recv_neighbors.clear();
+  }
+
+
+  void setup_mempool(COMB::Allocator& many_aloc,
+                     COMB::Allocator& few_aloc)
+  {
+    COMB::ignore_unused(many_aloc, few_aloc);
+  }
+
+  void teardown_mempool()
+  {
+  }
+
+  void post_send(int partner_rank, void const* buf, IdxT count, MPI_Datatype mpi_type)
+  {
+    int n = send_neighbors.at(partner_rank);
+    send_bufs[n] = buf;
+    send_counts[n] = static_cast<int>(count);
+    send_types[n] = mpi_type;
+    typed = typed || (mpi_type != MPI_BYTE);
+    num_sends_posted += 1;
+    start_if_posted();
+  }
+
+  void post_recv(int partner_rank, void* buf, IdxT count, MPI_Datatype mpi_type)
+  {
+    int n = recv_neighbors.at(partner_rank);
+    recv_bufs[n] = buf;
+    recv_counts[n] = static_cast<int>(count);
+    recv_types[n] = mpi_type;
+    typed = typed || (mpi_type != MPI_BYTE);
+    num_recvs_posted += 1;
+    start_if_posted();
+  }
+
+  void wait()
+  {
+    detail::MPI::Wait(&request, MPI_STATUS_IGNORE);
+  }
+
+  bool test()
+  {
+    return detail::MPI::Test(&request, MPI_STATUS_IGNORE);
+  }
+
+private:
+  // starts the collective once every message of the cycle is posted
+  void start_if_posted()
+  {
+    if (num_sends_posted < static_cast<int>(send_bufs.size()) ||
+        num_recvs_posted < static_cast<int>(recv_bufs.size())) {
+      return;
+    }
+    assert(request == MPI_REQUEST_NULL);
+    if (!typed) {
+      // buffers of a direction share one slab, displacements are from its start
+      std::vector<int> send_displs;
+      std::vector<int> recv_displs;
+      char const* send_base = byte_displacements(send_bufs, send_displs);
+      char const* recv_base = byte_displacements(recv_bufs, recv_displs);
+      detail::MPI::Ineighbor_alltoallv(send_base, send_counts.data(), send_displs.data(), MPI_BYTE,
+                                       const_cast<char*>(recv_base), recv_counts.data(), recv_displs.data(), MPI_BYTE,
+                                       graph_comm, &request);
+    } else {
+      // absolute addresses from MPI_BOTTOM
+      std::vector<MPI_Aint> send_displs;
+      std::vector<MPI_Aint> recv_displs;
+      for (void const* buf : send_bufs) {
+        send_displs.emplace_back(detail::MPI::Get_address(buf));
+      }
+      for (void* buf : recv_bufs) {
+        recv_displs.emplace_back(detail::MPI::Get_address(buf));
+      }
+      detail::MPI::Ineighbor_alltoallw(MPI_BOTTOM, send_counts.data(), send_displs.data(), send_types.data(),
+                                       MPI_BOTTOM, recv_counts.data(), recv_displs.data(), recv_types.data(),
+                                       graph_comm, &request);
+    }
+    num_sends_posted = 0;
+    num_recvs_posted = 0;
+    typed = false;
+  }
+
+  template < typename buf_type >
+  static char const* byte_displacements(std::vector<buf_type> const& bufs, std::vector<int>& displs)
+  {
+    char const* base = nullptr;
+    for (buf_type buf : bufs) {
+      char const* ptr = static_cast<char const*>(buf);
+      if (base == nullptr || ptr < base) base = ptr;
+    }
+    for (buf_type buf : bufs) {
+      std::ptrdiff_t displ = static_cast<char const*>(buf) - base;
+      assert(displ <= INT_MAX);
+      displs.emplace_back(static_cast<int>(displ));
+    }
+    return base;
+  }
+};
+
+
+namespace detail {
+
+template < >
+struct Message<MessageBase::Kind::send, mpi_neighbor_pol>
+  : MessageInterface<MessageBase::Kind::send, mpi_neighbor_pol>
+{
+  using base = MessageInterface<MessageBase::Kind::send, mpi_neighbor_pol>;
+
+  using policy_comm = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  // datatype of the message in the mesh, used by mpi_type groups
+  MPI_Datatype mpi_type = MPI_DATATYPE_NULL;
+
+  // use the base class constructor
+  using base::base;
+
+
+  // every request completes with the collective
+
+  static int wait_send_any(communicator_type& con_comm,
+                           int count, request_type* requests,
+                           status_type* statuses)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 2) {
+        assert(requests[i] == 1);
+        con_comm.wait();
+        requests[i] = 2;
+        statuses[i] = 1;
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  static int test_send_any(communicator_type& con_comm,
+                           int count, request_type* requests,
+                           status_type* statuses)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 2) {
+        assert(requests[i] == 1);
+        if (!con_comm.test()) return -1;
+        requests[i] = 2;
+        statuses[i] = 1;
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  static int wait_send_some(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            int* indices, status_type* statuses)
+  {
+    int done = 0;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 2) {
+        assert(requests[i] == 1);
+        if (done == 0) con_comm.wait();
+        requests[i] = 2;
+        statuses[i] = 1;
+        indices[done++] = i;
+      }
+    }
+    return done;
+  }
+
+  static int test_send_some(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            int* indices, status_type* statuses)
+  {
+    int done = 0;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 2) {
+        assert(requests[i] == 1);
+        if (done == 0 && !con_comm.test()) return 0;
+        requests[i] = 2;
+        statuses[i] = 1;
+        indices[done++] = i;
+      }
+    }
+    return done;
+  }
+
+  static void wait_send_all(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            status_type* statuses)
+  {
+    con_comm.wait();
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 2) {
+        assert(requests[i] == 1);
+        requests[i] = 2;
+        statuses[i] = 1;
+      }
+    }
+  }
+
+  static bool test_send_all(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            status_type* statuses)
+  {
+    if (!con_comm.test()) return false;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 2) {
+        assert(requests[i] == 1);
+        requests[i] = 2;
+        statuses[i] = 1;
+      }
+    }
+    return true;
+  }
+};
+
+
+template < >
+struct Message<MessageBase::Kind::recv, mpi_neighbor_pol>
+  : MessageInterface<MessageBase::Kind::recv, mpi_neighbor_pol>
+{
+  using base = MessageInterface<MessageBase::Kind::recv, mpi_neighbor_pol>;
+
+  using policy_comm = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  // datatype of the message in the mesh, used by mpi_type groups
+  MPI_Datatype mpi_type = MPI_DATATYPE_NULL;
+
+  // use the base class constructor
+  using base::base;
+
+
+  // every request completes with the collective
+
+  static int wait_recv_any(communicator_type& con_comm,
+                           int count, request_type* requests,
+                           status_type* statuses)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != -2) {
+        assert(requests[i] == -1);
+        con_comm.wait();
+        requests[i] = -2;
+        statuses[i] = 1;
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  static int test_recv_any(communicator_type& con_comm,
+                           int count, request_type* requests,
+                           status_type* statuses)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != -2) {
+        assert(requests[i] == -1);
+        if (!con_comm.test()) return -1;
+        requests[i] = -2;
+        statuses[i] = 1;
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  static int wait_recv_some(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            int* indices, status_type* statuses)
+  {
+    int done = 0;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != -2) {
+        assert(requests[i] == -1);
+        if (done == 0) con_comm.wait();
+        requests[i] = -2;
+        statuses[i] = 1;
+        indices[done++] = i;
+      }
+    }
+    return done;
+  }
+
+  static int test_recv_some(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            int* indices, status_type* statuses)
+  {
+    int done = 0;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != -2) {
+        assert(requests[i] == -1);
+        if (done == 0 && !con_comm.test()) return 0;
+        requests[i] = -2;
+        statuses[i] = 1;
+        indices[done++] = i;
+      }
+    }
+    return done;
+  }
+
+  static void wait_recv_all(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            status_type* statuses)
+  {
+    con_comm.wait();
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != -2) {
+        assert(requests[i] == -1);
+        requests[i] = -2;
+        statuses[i] = 1;
+      }
+    }
+  }
+
+  static bool test_recv_all(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            status_type* statuses)
+  {
+    if (!con_comm.test()) return false;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != -2) {
+        assert(requests[i] == -1);
+        requests[i] = -2;
+        statuses[i] = 1;
+      }
+    }
+    return true;
+  }
+};
+
+template < typename exec_policy >
+struct MessageGroup<MessageBase::Kind::send, mpi_neighbor_pol, exec_policy>
+  : detail::MessageGroupInterface<MessageBase::Kind::send, mpi_neighbor_pol, exec_policy>
+{
+  using base = detail::MessageGroupInterface<MessageBase::Kind::send, mpi_neighbor_pol, exec_policy>;
+
+  using policy_comm       = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using message_type      = typename base::message_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  using message_item_type = typename base::message_item_type;
+  using context_type      = typename base::context_type;
+  using event_type        = typename base::event_type;
+  using group_type        = typename base::group_type;
+  using component_type    = typename base::component_type;
+
+  // use the base class constructor
+  using base::base;
+
+
+  void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
+      assert(msg->buf == nullptr);
+
+      IdxT nbytes = msg->nbytes();
+
+      msg->buf = this->m_aloc.allocate(nbytes);
+    }
+
+    this->allocate_fused_vars(con);
+  }
+
+  void pack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
+  {
+    COMB::ignore_unused(con_comm);
+    if (len <= 0) return;
+    con.start_group(this->m_groups[len-1]);
+    if (!comb_allow_pack_loop_fusion()) {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          pack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
+        }
+        if (async == detail::Async::no) {
+          this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
+        } else {
+          this->m_contexts[msg->idx].finish_component_recordEvent(this->m_groups[len-1], this->m_components[msg->idx], this->m_events[msg->idx]);
+        }
+      }
+    }
+    else if (async == detail::Async::no) {
+      IdxT total_items = 0;
+      IdxT num_fused = 0;
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
+          num_fused += 1;
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
+        }
+      }
+      // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
+      IdxT avg_items = (total_items + num_fused - 1) / num_fused;
+      fused_pack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      this->m_fused.pos += num_fused;
+    } else {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        IdxT total_items = 0;
+        IdxT num_fused = 0;
+        this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
+          num_fused += 1;
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
+        }
+        // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
+        IdxT avg_items = (total_items + num_fused - 1) / num_fused;
+        fused_pack(this->m_contexts[msg->idx], this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+        this->m_fused.pos += num_fused;
+        this->m_contexts[msg->idx].finish_component_recordEvent(this->m_groups[len-1], this->m_components[msg->idx], this->m_events[msg->idx]);
+      }
+    }
+    con.finish_group(this->m_groups[len-1]);
+  }
+
+  IdxT wait_pack_complete(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
+  {
+    // FGPRINTF(FileGroup::proc, "wait_pack_complete\n");
+    if (len <= 0) return 0;
+    if (async == detail::Async::no) {
+      con_comm.waitOn(con);
+    } else {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        if (!this->m_contexts[msg->idx].queryEvent(this->m_events[msg->idx])) {
+          return i;
+        }
+      }
+    }
+    return len;
+  }
+
+  static void start_Isends(context_type& con, communicator_type& con_comm)
+  {
+    // FGPRINTF(FileGroup::proc, "start_Isends\n");
+    COMB::ignore_unused(con, con_comm);
+  }
+
+  void Isend(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
+  {
+    if (len <= 0) return;
+    start_Isends(con, con_comm);
+    for (IdxT i = 0; i < len; ++i) {
+      const message_type* msg = msgs[i];
+      char* buf = static_cast<char*>(msg->buf);
+      assert(buf != nullptr);
+      const int partner_rank = msg->partner_rank;
+      const IdxT nbytes = msg->nbytes();
+      // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %d to %i\n", this, buf, nbytes, partner_rank);
+      con_comm.post_send(partner_rank, buf, nbytes, MPI_BYTE);
+      requests[i] = 1;
+    }
+    finish_Isends(con, con_comm);
+  }
+
+  static void finish_Isends(context_type& con, communicator_type& con_comm)
+  {
+    // FGPRINTF(FileGroup::proc, "finish_Isends\n");
+    COMB::ignore_unused(con, con_comm);
+  }
+
+  void deallocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
+      assert(msg->buf != nullptr);
+
+      this->m_aloc.deallocate(msg->buf);
+
+      msg->buf = nullptr;
+    }
+
+    this->deallocate_fused_vars();
+  }
+
+};
+
+template < typename exec_policy >
+struct MessageGroup<MessageBase::Kind::recv, mpi_neighbor_pol, exec_policy>
+  : detail::MessageGroupInterface<MessageBase::Kind::recv, mpi_neighbor_pol, exec_policy>
+{
+  using base = detail::MessageGroupInterface<MessageBase::Kind::recv, mpi_neighbor_pol, exec_policy>;
+
+  using policy_comm       = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using message_type      = typename base::message_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  using message_item_type = typename base::message_item_type;
+  using context_type      = typename base::context_type;
+  using event_type        = typename base::event_type;
+  using group_type        = typename base::group_type;
+  using component_type    = typename base::component_type;
+
+  // use the base class constructor
+  using base::base;
+
+
+  void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
+      assert(msg->buf == nullptr);
+
+      IdxT nbytes = msg->nbytes();
+
+      msg->buf = this->m_aloc.allocate(nbytes);
+    }
+
+    this->allocate_fused_vars(con);
+  }
+
+  void Irecv(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
+  {
+    COMB::ignore_unused(con);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      const message_type* msg = msgs[i];
+      char* buf = static_cast<char*>(msg->buf);
+      assert(buf != nullptr);
+      const int partner_rank = msg->partner_rank;
+      const IdxT nbytes = msg->nbytes();
+      // FGPRINTF(FileGroup::proc, "%p Irecv %p nbytes %d to %i\n", this, buf, nbytes, partner_rank);
+      con_comm.post_recv(partner_rank, buf, nbytes, MPI_BYTE);
+      requests[i] = -1;
+    }
+  }
+
+  void unpack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con_comm);
+    if (len <= 0) return;
+    con.start_group(this->m_groups[len-1]);
+    if (!comb_allow_pack_loop_fusion()) {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          unpack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
+        }
+        this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
+      }
+    }
+    else {
+      IdxT total_items = 0;
+      IdxT num_fused = 0;
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
+          num_fused += 1;
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
+        }
+      }
+      // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, dst, indices, nitems);
+      IdxT avg_items = (total_items + num_fused - 1) / num_fused;
+      fused_unpack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      this->m_fused.pos += num_fused;
+    }
+    con.finish_group(this->m_groups[len-1]);
+  }
+
+  void deallocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
+      assert(msg->buf != nullptr);
+
+      this->m_aloc.deallocate(msg->buf);
+
+      msg->buf = nullptr;
+    }
+
+    this->deallocate_fused_vars();
+  }
+
+};
+
+
+// mpi_type messages need no buffers, each is one struct datatype over the
+// subarray types of its items in every variable, created once
+template < typename message_group_type >
+inline void setup_neighbor_types(message_group_type& group)
+{
+  using message_item_type = typename message_group_type::message_item_type;
+  for (auto& msg : group.messages) {
+    if (msg.mpi_type != MPI_DATATYPE_NULL) continue;
+    std::vector<int> blocklengths;
+    std::vector<MPI_Aint> displacements;
+    std::vector<MPI_Datatype> types;
+    for (MessageItemBase* msg_item : msg.message_items) {
+      message_item_type* item = static_cast<message_item_type*>(msg_item);
+      for (IdxT s = 0; s < static_cast<IdxT>(group.m_sections.size()); ++s) {
+        var_section const& sec = group.m_sections[s];
+        for (IdxT j = sec.first; j < sec.first + sec.num_vars; ++j) {
+          blocklengths.emplace_back(1);
+          displacements.emplace_back(detail::MPI::Get_address(group.m_variables[j]));
+          types.emplace_back(item->mpi_types[s]);
+        }
+      }
+    }
+    msg.mpi_type = detail::MPI::Type_create_struct(types.size(), blocklengths.data(), displacements.data(), types.data());
+    detail::MPI::Type_commit(&msg.mpi_type);
+  }
+}
+
+template < typename message_type >
+inline void free_neighbor_types(std::vector<message_type>& messages)
+{
+  for (message_type& msg : messages) {
+    if (msg.mpi_type != MPI_DATATYPE_NULL) {
+      detail::MPI::Type_free(&msg.mpi_type);
+    }
+  }
+}
+
+template < >
+struct MessageGroup<MessageBase::Kind::send, mpi_neighbor_pol, mpi_type_pol>
+  : detail::MessageGroupInterface<MessageBase::Kind::send, mpi_neighbor_pol, mpi_type_pol>
+{
+  using base = detail::MessageGroupInterface<MessageBase::Kind::send, mpi_neighbor_pol, mpi_type_pol>;
+
+  using policy_comm       = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using message_type      = typename base::message_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  using message_item_type = typename base::message_item_type;
+  using context_type      = typename base::context_type;
+  using event_type        = typename base::event_type;
+  using group_type        = typename base::group_type;
+  using component_type    = typename base::component_type;
+
+  // use the base class constructor
+  using base::base;
+
+  ~MessageGroup()
+  {
+    free_neighbor_types(this->messages);
+  }
+
+
+  void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm, msgs);
+    if (len <= 0) return;
+    setup_neighbor_types(*this);
+  }
+
+  void pack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
+  {
+    COMB::ignore_unused(con_comm);
+    if (len <= 0) return;
+    con.start_group(this->m_groups[len-1]);
+    for (IdxT i = 0; i < len; ++i) {
+      const message_type* msg = msgs[i];
+      this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
+      // packed by the collective via the message datatype
+      if (async == detail::Async::no) {
+        this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
+      } else {
+        this->m_contexts[msg->idx].finish_component_recordEvent(this->m_groups[len-1], this->m_components[msg->idx], this->m_events[msg->idx]);
+      }
+    }
+    con.finish_group(this->m_groups[len-1]);
+  }
+
+  IdxT wait_pack_complete(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
+  {
+    // FGPRINTF(FileGroup::proc, "wait_pack_complete\n");
+    if (len <= 0) return 0;
+    if (async == detail::Async::no) {
+      con_comm.waitOn(con);
+    } else {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        if (!this->m_contexts[msg->idx].queryEvent(this->m_events[msg->idx])) {
+          return i;
+        }
+      }
+    }
+    return len;
+  }
+
+  static void start_Isends(context_type& con, communicator_type& con_comm)
+  {
+    // FGPRINTF(FileGroup::proc, "start_Isends\n");
+    COMB::ignore_unused(con, con_comm);
+  }
+
+  void Isend(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
+  {
+    if (len <= 0) return;
+    start_Isends(con, con_comm);
+    for (IdxT i = 0; i < len; ++i) {
+      const message_type* msg = msgs[i];
+      assert(msg->mpi_type != MPI_DATATYPE_NULL);
+      // FGPRINTF(FileGroup::proc, "%p Isend type to %i\n", this, msg->partner_rank);
+      con_comm.post_send(msg->partner_rank, MPI_BOTTOM, 1, msg->mpi_type);
+      requests[i] = 1;
+    }
+    finish_Isends(con, con_comm);
+  }
+
+  static void finish_Isends(context_type& con, communicator_type& con_comm)
+  {
+    // FGPRINTF(FileGroup::proc, "finish_Isends\n");
+    COMB::ignore_unused(con, con_comm);
+  }
+
+  void deallocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm, msgs, len);
+  }
+};
+
+template < >
+struct MessageGroup<MessageBase::Kind::recv, mpi_neighbor_pol, mpi_type_pol>
+  : detail::MessageGroupInterface<MessageBase::Kind::recv, mpi_neighbor_pol, mpi_type_pol>
+{
+  using base = detail::MessageGroupInterface<MessageBase::Kind::recv, mpi_neighbor_pol, mpi_type_pol>;
+
+  using policy_comm       = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using message_type      = typename base::message_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  using message_item_type = typename base::message_item_type;
+  using context_type      = typename base::context_type;
+  using event_type        = typename base::event_type;
+  using group_type        = typename base::group_type;
+  using component_type    = typename base::component_type;
+
+  // use the base class constructor
+  using base::base;
+
+  ~MessageGroup()
+  {
+    free_neighbor_types(this->messages);
+  }
+
+
+  void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm, msgs);
+    if (len <= 0) return;
+    setup_neighbor_types(*this);
+  }
+
+  void Irecv(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
+  {
+    COMB::ignore_unused(con);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      const message_type* msg = msgs[i];
+      assert(msg->mpi_type != MPI_DATATYPE_NULL);
+      // FGPRINTF(FileGroup::proc, "%p Irecv type to %i\n", this, msg->partner_rank);
+      con_comm.post_recv(msg->partner_rank, MPI_BOTTOM, 1, msg->mpi_type);
+      requests[i] = -1;
+    }
+  }
+
+  void unpack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con_comm);
+    if (len <= 0) return;
+    con.start_group(this->m_groups[len-1]);
+    for (IdxT i = 0; i < len; ++i) {
+      const message_type* msg = msgs[i];
+      this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
+      // unpacked by the collective via the message datatype
+      this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
+    }
+    con.finish_group(this->m_groups[len-1]);
+  }
+
+  void deallocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm, msgs, len);
+  }
+};
+
+} // namespace detail
+
+#endif
+
+#endif // _COMM_POL_MPI_NEIGHBOR_HPP
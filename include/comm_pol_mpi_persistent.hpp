@@ -0,0 +1,87 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _COMM_POL_MPI_PERSISTENT_HPP
+#define _COMM_POL_MPI_PERSISTENT_HPP
+
+#include "config.hpp"
+
+#ifdef COMB_ENABLE_MPI
+
+#include "comm_pol_mpi.hpp"
+
+// mpi communication with persistent requests, the requests of each message
+// are created once with MPI_Send_init and MPI_Recv_init on the first cycle
+// and started with MPI_Startall every cycle, messages are otherwise
+// handled by the mpi message groups
+struct mpi_persistent_pol {
+  // static const bool async = false;
+  static const bool mock = false;
+  // compile mpi_type packing/unpacking tests for this comm policy
+  static const bool use_mpi_type = true;
+  // message buffers may be kept across cycles
+  static const bool persistent_buffers = true;
+  // fused pack arrays may come from the comm util arena
+  static const bool util_arena = true;
+  // message buffers are placed per message group
+  static const bool slab_buffers = false;
+  static const char* get_name() { return "mpi_persistent"; }
+  using send_request_type = MPI_Request;
+  using recv_request_type = MPI_Request;
+  using send_status_type = MPI_Status;
+  using recv_status_type = MPI_Status;
+};
+
+template < >
+struct CommContext<mpi_persistent_pol> : CommContext<mpi_pol>
+{
+  using base = CommContext<mpi_pol>;
+
+  using pol = mpi_persistent_pol;
+
+  CommContext()
+    : base()
+  { }
+
+  CommContext(MPIContext const& b)
+    : base(b)
+  { }
+
+  CommContext(CommContext const& a_, MPI_Comm comm_)
+    : base(a_, comm_)
+  { }
+};
+
+
+namespace detail {
+
+template < MessageBase::Kind kind, typename exec_policy >
+struct MessageGroup<kind, mpi_persistent_pol, exec_policy>
+  : MessageGroup<kind, mpi_pol, exec_policy>
+{
+  using base = MessageGroup<kind, mpi_pol, exec_policy>;
+
+  MessageGroup(COMB::Allocator& aloc_)
+    : base(aloc_)
+  {
+    this->use_persistent_requests();
+  }
+};
+
+} // namespace detail
+
+#endif
+
+#endif // _COMM_POL_MPI_PERSISTENT_HPP
@@ -0,0 +1,969 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _COMM_POL_MPI_RMA_HPP
+#define _COMM_POL_MPI_RMA_HPP
+
+#include "config.hpp"
+
+#ifdef COMB_ENABLE_MPI
+
+#include <unordered_map>
+
+#include "for_all.hpp"
+#include "utils.hpp"
+#include "utils_mpi.hpp"
+#include "MessageBase.hpp"
+#include "ExecContext.hpp"
+
+// mpi one-sided communication, the recv buffers of each rank are kept in one
+// slab allocated as a window once, sends put their packed buffers into the
+// slabs of their partners, windows are synchronized as set by comb_rma_sync,
+// every rank opening an epoch when an exchange starts and closing it once
+// its sends are posted
+struct mpi_rma_pol {
+  // static const bool async = false;
+  static const bool mock = false;
+  // compile mpi_type packing/unpacking tests for this comm policy
+  static const bool use_mpi_type = false;
+  // message buffers may be kept across cycles
+  static const bool persistent_buffers = true;
+  // fused pack arrays may come from the comm util arena
+  static const bool util_arena = true;
+  // messages stay in the many group with the recv buffers in one slab the
+  // window exposes
+  static const bool slab_buffers = true;
+  static const char* get_name() { return "mpi_rma"; }
+  using send_request_type = int;
+  using recv_request_type = int;
+  using send_status_type = int;
+  using recv_status_type = int;
+};
+
+template < >
+struct CommContext<mpi_rma_pol> : MPIContext
+{
+  using base = MPIContext;
+
+  using pol = mpi_rma_pol;
+
+  using send_request_type = typename pol::send_request_type;
+  using recv_request_type = typename pol::recv_request_type;
+  using send_status_type = typename pol::send_status_type;
+  using recv_status_type = typename pol::recv_status_type;
+
+  MPI_Comm comm = MPI_COMM_NULL;
+
+  // partners in message order and the neighbor index of each partner rank
+  std::vector<int> send_ranks;
+  std::vector<int> recv_ranks;
+  std::unordered_map<int, int> send_neighbors;
+  std::unordered_map<int, int> recv_neighbors;
+
+  RmaSync sync = RmaSync::fence;
+
+  // window holding the slab of recv buffers, allocated by recv_slab
+  MPI_Win win = MPI_WIN_NULL;
+  char* win_base = nullptr;
+  IdxT win_nbytes = 0;
+  // displacement of the recv buffer for this rank in the window of each
+  // send partner
+  std::vector<MPI_Aint> send_displs;
+
+  // pscw groups of the recv partners that put into this window and of the
+  // send partners whose windows this rank puts into
+  MPI_Group recv_group = MPI_GROUP_NULL;
+  MPI_Group send_group = MPI_GROUP_NULL;
+
+  // passive notification flags holding exchange numbers, one per recv
+  // partner set when its puts are flushed followed by one per send partner
+  // set when its recv buffer may be overwritten
+  MPI_Win flag_win = MPI_WIN_NULL;
+  int* flags = nullptr;
+  // index of the flag for this rank at each send and recv partner
+  std::vector<MPI_Aint> send_flag_idxs;
+  std::vector<MPI_Aint> recv_flag_idxs;
+  int rank = -1;
+
+  int num_sends_posted = 0;
+  int num_recvs_posted = 0;
+  int exchange = 0;
+  // fence or pscw exposure epoch opened when the exchange starts
+  bool recv_epoch = false;
+
+  CommContext()
+    : base()
+  { }
+
+  CommContext(base const& b)
+    : base(b)
+  { }
+
+  CommContext(CommContext const& a_, MPI_Comm comm_)
+    : base(a_)
+    , comm(comm_)
+  { }
+
+  void ensure_waitable()
+  {
+
+  }
+
+  template < typename context >
+  void waitOn(context& con)
+  {
+    con.ensure_waitable();
+    base::waitOn(con);
+  }
+
+  send_request_type send_request_null() { return 0; }
+  recv_request_type recv_request_null() { return 0; }
+  send_status_type send_status_null() { return 0; }
+  recv_status_type recv_status_null() { return 0; }
+
+  void connect_ranks(std::vector<int> const& send_ranks_,
+                     std::vector<int> const& recv_ranks_)
+  {
+    send_ranks = send_ranks_;
+    recv_ranks = recv_ranks_;
+    for (int i = 0; i < static_cast<int>(send_ranks.size()); ++i) {
+      send_neighbors.emplace(send_ranks[i], i);
+    }
+    for (int i = 0; i < static_cast<int>(recv_ranks.size()); ++i) {
+      recv_neighbors.emplace(recv_ranks[i], i);
+    }
+  }
+
+  void disconnect_ranks(std::vector<int> const& send_ranks_,
+                        std::vector<int> const& recv_ranks_)
+  {
+    COMB::ignore_unused(send_ranks_, recv_ranks_);
+    if (flag_win != MPI_WIN_NULL) {
+      detail::MPI::Win_unlock_all(flag_win);
+      detail::MPI::Win_free(&flag_win);
+      flags = nullptr;
+    }
+    if (recv_group != MPI_GROUP_NULL && recv_group != MPI_GROUP_EMPTY) {
+      detail::MPI::Group_free(&recv_group);
+    }
+    if (send_group != MPI_GROUP_NULL && send_group != MPI_GROUP_EMPTY) {
+      detail::MPI::Group_free(&send_group);
+    }
+    send_neighbors.clear();
+    recv_neighbors.clear();
+  }
+
+
+  void setup_mempool(COMB::Allocator& many_aloc,
+                     COMB::Allocator& few_aloc)
+  {
+    COMB::ignore_unused(many_aloc, few_aloc);
+  }
+
+  void teardown_mempool()
+  {
+  }
+
+  // the slab of recv buffers, collective over comm
+  void* allocate_window(IdxT nbytes)
+  {
+    assert(win == MPI_WIN_NULL);
+    sync = comb_rma_sync();
+    rank = detail::MPI::Comm_rank(comm);
+    // a rank whose messages are all self copies has no recv buffers, keep
+    // the window from being empty as every rank takes part in its epochs
+    win = detail::MPI::Win_allocate(std::max(nbytes, IdxT(1)), 1, comm, &win_base);
+    win_nbytes = nbytes;
+    return win_base;
+  }
+
+  void free_window(void* ptr)
+  {
+    COMB::ignore_unused(ptr);
+    assert(ptr == win_base);
+    if (sync == RmaSync::passive) {
+      detail::MPI::Win_unlock_all(win);
+    }
+    detail::MPI::Win_free(&win);
+    win_base = nullptr;
+    win_nbytes = 0;
+  }
+
+  // tells each partner where its puts and flags go, collective over comm
+  void create_windows(std::vector<int> const& ranks,
+                      std::vector<char*> const& bufs)
+  {
+    assert(win != MPI_WIN_NULL);
+
+    int num_sends = send_ranks.size();
+    int num_recvs = recv_ranks.size();
+
+    // recv partners get the displacement of their buffer and the index of
+    // their recv flag, send partners get the index of their ready flag
+    std::vector<MPI_Aint> to_recv_partners(2*num_recvs, 0);
+    std::vector<MPI_Aint> to_send_partners(num_sends, 0);
+    std::vector<MPI_Aint> from_send_partners(2*num_sends, 0);
+    std::vector<MPI_Aint> from_recv_partners(num_recvs, 0);
+    for (IdxT i = 0; i < static_cast<IdxT>(bufs.size()); ++i) {
+      int n = recv_neighbors.at(ranks[i]);
+      to_recv_partners[2*n]   = bufs[i] - win_base;
+      to_recv_partners[2*n+1] = n;
+    }
+    for (int j = 0; j < num_sends; ++j) {
+      to_send_partners[j] = num_recvs + j;
+    }
+    std::vector<MPI_Request> requests(2*(num_sends + num_recvs), MPI_REQUEST_NULL);
+    MPI_Request* request = requests.data();
+    for (int j = 0; j < num_sends; ++j) {
+      detail::MPI::Irecv(&from_send_partners[2*j], 2, MPI_AINT, send_ranks[j], 0, comm, request++);
+    }
+    for (int n = 0; n < num_recvs; ++n) {
+      detail::MPI::Irecv(&from_recv_partners[n], 1, MPI_AINT, recv_ranks[n], 1, comm, request++);
+    }
+    for (int n = 0; n < num_recvs; ++n) {
+      detail::MPI::Isend(&to_recv_partners[2*n], 2, MPI_AINT, recv_ranks[n], 0, comm, request++);
+    }
+    for (int j = 0; j < num_sends; ++j) {
+      detail::MPI::Isend(&to_send_partners[j], 1, MPI_AINT, send_ranks[j], 1, comm, request++);
+    }
+    detail::MPI::Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+    send_displs.resize(num_sends);
+    send_flag_idxs.resize(num_sends);
+    for (int j = 0; j < num_sends; ++j) {
+      send_displs[j]    = from_send_partners[2*j];
+      send_flag_idxs[j] = from_send_partners[2*j+1];
+    }
+    recv_flag_idxs = from_recv_partners;
+
+    switch (sync) {
+      case RmaSync::fence:
+      {
+      } break;
+      case RmaSync::pscw:
+      {
+        MPI_Group comm_group = detail::MPI::Comm_group(comm);
+        recv_group = detail::MPI::Group_incl(comm_group, num_recvs, recv_ranks.data());
+        send_group = detail::MPI::Group_incl(comm_group, num_sends, send_ranks.data());
+        detail::MPI::Group_free(&comm_group);
+      } break;
+      case RmaSync::passive:
+      {
+        flag_win = detail::MPI::Win_allocate((num_recvs + num_sends)*sizeof(int), sizeof(int), comm, &flags);
+        detail::MPI::Win_lock_all(MPI_MODE_NOCHECK, flag_win);
+        for (int i = 0; i < num_recvs + num_sends; ++i) {
+          flags[i] = 0;
+        }
+        detail::MPI::Win_sync(flag_win);
+        detail::MPI::Win_lock_all(MPI_MODE_NOCHECK, win);
+        detail::MPI::Barrier(comm);
+      } break;
+    }
+  }
+
+  // called by every rank before its recvs are posted, fences are collective
+  // over comm so ranks without messages take part too
+  void open_exchange()
+  {
+    exchange += 1;
+    if (sync == RmaSync::fence) {
+      detail::MPI::Win_fence(MPI_MODE_NOPRECEDE, win);
+      recv_epoch = true;
+    } else if (sync == RmaSync::pscw && !recv_ranks.empty()) {
+      detail::MPI::Win_post(recv_group, 0, win);
+      recv_epoch = true;
+    }
+  }
+
+  // called by every rank once its sends are posted
+  void close_exchange()
+  {
+    if (sync == RmaSync::fence) {
+      close_fence();
+    }
+  }
+
+  // returns the neighbor index of the message
+  int post_recv(int partner_rank, char* buf, IdxT nbytes)
+  {
+    COMB::ignore_unused(buf, nbytes);
+    assert(buf >= win_base && buf + nbytes <= win_base + win_nbytes);
+    int n = recv_neighbors.at(partner_rank);
+    if (sync == RmaSync::passive) {
+      // the partner may overwrite the buffer
+      detail::MPI::Accumulate(&exchange, 1, MPI_INT, partner_rank, recv_flag_idxs[n], MPI_REPLACE, flag_win);
+      detail::MPI::Win_flush(partner_rank, flag_win);
+    }
+    if (++num_recvs_posted == static_cast<int>(recv_ranks.size())) {
+      num_recvs_posted = 0;
+    }
+    return n;
+  }
+
+  // returns the neighbor index of the message
+  int post_send(int partner_rank, char const* buf, IdxT nbytes)
+  {
+    int j = send_neighbors.at(partner_rank);
+    if (num_sends_posted == 0 && sync == RmaSync::pscw) {
+      detail::MPI::Win_start(send_group, 0, win);
+    }
+    if (sync == RmaSync::passive) {
+      // wait until the partner may have its buffer overwritten
+      while (read_flag(recv_ranks.size() + j) < exchange);
+    }
+    detail::MPI::Put(buf, nbytes, MPI_BYTE, partner_rank, send_displs[j], win);
+    if (sync == RmaSync::passive) {
+      detail::MPI::Win_flush(partner_rank, win);
+      detail::MPI::Accumulate(&exchange, 1, MPI_INT, partner_rank, send_flag_idxs[j], MPI_REPLACE, flag_win);
+      detail::MPI::Win_flush(partner_rank, flag_win);
+    }
+    if (++num_sends_posted == static_cast<int>(send_ranks.size())) {
+      num_sends_posted = 0;
+      if (sync == RmaSync::pscw) {
+        detail::MPI::Win_complete(win);
+      }
+    }
+    return j;
+  }
+
+  bool test_recv(int n)
+  {
+    switch (sync) {
+      case RmaSync::fence:
+      {
+        // closed by close_exchange as a fence can not be tested
+        close_fence();
+      } break;
+      case RmaSync::pscw:
+      {
+        if (recv_epoch) {
+          if (!detail::MPI::Win_test(win)) return false;
+          recv_epoch = false;
+        }
+      } break;
+      case RmaSync::passive:
+      {
+        if (read_flag(n) < exchange) return false;
+        detail::MPI::Win_sync(win);
+      } break;
+    }
+    return true;
+  }
+
+  void wait_recv(int n)
+  {
+    switch (sync) {
+      case RmaSync::fence:
+      {
+        close_fence();
+      } break;
+      case RmaSync::pscw:
+      {
+        if (recv_epoch) {
+          detail::MPI::Win_wait(win);
+          recv_epoch = false;
+        }
+      } break;
+      case RmaSync::passive:
+      {
+        while (read_flag(n) < exchange);
+        detail::MPI::Win_sync(win);
+      } break;
+    }
+  }
+
+  // puts complete when posted except in a fence epoch
+  void wait_send(int j)
+  {
+    COMB::ignore_unused(j);
+    if (sync == RmaSync::fence) {
+      close_fence();
+    }
+  }
+
+private:
+  void close_fence()
+  {
+    if (recv_epoch) {
+      detail::MPI::Win_fence(MPI_MODE_NOSUCCEED, win);
+      recv_epoch = false;
+    }
+  }
+
+  int read_flag(IdxT idx)
+  {
+    int value = 0;
+    detail::MPI::Fetch_and_op(nullptr, &value, MPI_INT, rank, idx, MPI_NO_OP, flag_win);
+    detail::MPI::Win_flush(rank, flag_win);
+    return value;
+  }
+};
+
+
+namespace detail {
+
+template < >
+struct recv_slab<mpi_rma_pol>
+{
+  // the slab is the memory of the window whatever the allocator
+  static void* allocate(CommContext<mpi_rma_pol>& con_comm, COMB::Allocator&, IdxT nbytes)
+  {
+    return con_comm.allocate_window(nbytes);
+  }
+
+  static void deallocate(CommContext<mpi_rma_pol>& con_comm, COMB::Allocator&, void* ptr)
+  {
+    con_comm.free_window(ptr);
+  }
+};
+
+template < >
+struct exchange_epoch<mpi_rma_pol>
+{
+  static void open(CommContext<mpi_rma_pol>& con_comm)
+  {
+    con_comm.open_exchange();
+  }
+
+  static void close(CommContext<mpi_rma_pol>& con_comm)
+  {
+    con_comm.close_exchange();
+  }
+};
+
+template < >
+struct Message<MessageBase::Kind::send, mpi_rma_pol>
+  : MessageInterface<MessageBase::Kind::send, mpi_rma_pol>
+{
+  using base = MessageInterface<MessageBase::Kind::send, mpi_rma_pol>;
+
+  using policy_comm = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  // use the base class constructor
+  using base::base;
+
+
+  // a pending request holds the neighbor index plus one, a done request 0
+
+  static int wait_send_any(communicator_type& con_comm,
+                           int count, request_type* requests,
+                           status_type* statuses)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 0) {
+        con_comm.wait_send(requests[i]-1);
+        requests[i] = 0;
+        statuses[i] = 1;
+        return i;
+      }
+    }
+    return -1;
+  }
+
+  static int test_send_any(communicator_type& con_comm,
+                           int count, request_type* requests,
+                           status_type* statuses)
+  {
+    return wait_send_any(con_comm, count, requests, statuses);
+  }
+
+  static int wait_send_some(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            int* indices, status_type* statuses)
+  {
+    int done = 0;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 0) {
+        con_comm.wait_send(requests[i]-1);
+        requests[i] = 0;
+        statuses[i] = 1;
+        indices[done++] = i;
+      }
+    }
+    return done;
+  }
+
+  static int test_send_some(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            int* indices, status_type* statuses)
+  {
+    return wait_send_some(con_comm, count, requests, indices, statuses);
+  }
+
+  static void wait_send_all(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            status_type* statuses)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 0) {
+        con_comm.wait_send(requests[i]-1);
+        requests[i] = 0;
+        statuses[i] = 1;
+      }
+    }
+  }
+
+  static bool test_send_all(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            status_type* statuses)
+  {
+    wait_send_all(con_comm, count, requests, statuses);
+    return true;
+  }
+};
+
+
+template < >
+struct Message<MessageBase::Kind::recv, mpi_rma_pol>
+  : MessageInterface<MessageBase::Kind::recv, mpi_rma_pol>
+{
+  using base = MessageInterface<MessageBase::Kind::recv, mpi_rma_pol>;
+
+  using policy_comm = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  // use the base class constructor
+  using base::base;
+
+
+  // a pending request holds the neighbor index plus one, a done request 0
+
+  static int wait_recv_any(communicator_type& con_comm,
+                           int count, request_type* requests,
+                           status_type* statuses)
+  {
+    bool pending = true;
+    while (pending) {
+      pending = false;
+      for (int i = 0; i < count; ++i) {
+        if (requests[i] != 0) {
+          pending = true;
+          if (con_comm.test_recv(requests[i]-1)) {
+            requests[i] = 0;
+            statuses[i] = 1;
+            return i;
+          }
+        }
+      }
+    }
+    return -1;
+  }
+
+  static int test_recv_any(communicator_type& con_comm,
+                           int count, request_type* requests,
+                           status_type* statuses)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 0) {
+        if (con_comm.test_recv(requests[i]-1)) {
+          requests[i] = 0;
+          statuses[i] = 1;
+          return i;
+        }
+      }
+    }
+    return -1;
+  }
+
+  static int wait_recv_some(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            int* indices, status_type* statuses)
+  {
+    bool pending = true;
+    while (pending) {
+      pending = false;
+      int done = 0;
+      for (int i = 0; i < count; ++i) {
+        if (requests[i] != 0) {
+          pending = true;
+          if (con_comm.test_recv(requests[i]-1)) {
+            requests[i] = 0;
+            statuses[i] = 1;
+            indices[done++] = i;
+          }
+        }
+      }
+      if (done > 0) return done;
+    }
+    return 0;
+  }
+
+  static int test_recv_some(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            int* indices, status_type* statuses)
+  {
+    int done = 0;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 0) {
+        if (con_comm.test_recv(requests[i]-1)) {
+          requests[i] = 0;
+          statuses[i] = 1;
+          indices[done++] = i;
+        }
+      }
+    }
+    return done;
+  }
+
+  static void wait_recv_all(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            status_type* statuses)
+  {
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 0) {
+        con_comm.wait_recv(requests[i]-1);
+        requests[i] = 0;
+        statuses[i] = 1;
+      }
+    }
+  }
+
+  static bool test_recv_all(communicator_type& con_comm,
+                            int count, request_type* requests,
+                            status_type* statuses)
+  {
+    bool done = true;
+    for (int i = 0; i < count; ++i) {
+      if (requests[i] != 0) {
+        if (con_comm.test_recv(requests[i]-1)) {
+          requests[i] = 0;
+          statuses[i] = 1;
+        } else {
+          done = false;
+        }
+      }
+    }
+    return done;
+  }
+};
+
+// partners learn where the recv buffers are once they are placed in the window
+inline void connect_buffers(CommContext<mpi_rma_pol>& con_comm,
+                            std::vector<Message<MessageBase::Kind::send, mpi_rma_pol>*> const&,
+                            std::vector<Message<MessageBase::Kind::recv, mpi_rma_pol>*> const& msgs)
+{
+  std::vector<int> ranks;
+  std::vector<char*> bufs;
+  for (Message<MessageBase::Kind::recv, mpi_rma_pol>* msg : msgs) {
+    assert(msg->buf != nullptr);
+    ranks.emplace_back(msg->partner_rank);
+    bufs.emplace_back(static_cast<char*>(msg->buf));
+  }
+  con_comm.create_windows(ranks, bufs);
+}
+
+template < typename exec_policy >
+struct MessageGroup<MessageBase::Kind::send, mpi_rma_pol, exec_policy>
+  : detail::MessageGroupInterface<MessageBase::Kind::send, mpi_rma_pol, exec_policy>
+{
+  using base = detail::MessageGroupInterface<MessageBase::Kind::send, mpi_rma_pol, exec_policy>;
+
+  using policy_comm       = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using message_type      = typename base::message_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  using message_item_type = typename base::message_item_type;
+  using context_type      = typename base::context_type;
+  using event_type        = typename base::event_type;
+  using group_type        = typename base::group_type;
+  using component_type    = typename base::component_type;
+
+  // use the base class constructor
+  using base::base;
+
+
+  void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
+      assert(msg->buf == nullptr);
+
+      IdxT nbytes = msg->nbytes();
+
+      msg->buf = this->m_aloc.allocate(nbytes);
+    }
+
+    this->allocate_fused_vars(con);
+  }
+
+  void pack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
+  {
+    COMB::ignore_unused(con_comm);
+    if (len <= 0) return;
+    con.start_group(this->m_groups[len-1]);
+    if (!comb_allow_pack_loop_fusion()) {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          pack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
+        }
+        if (async == detail::Async::no) {
+          this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
+        } else {
+          this->m_contexts[msg->idx].finish_component_recordEvent(this->m_groups[len-1], this->m_components[msg->idx], this->m_events[msg->idx]);
+        }
+      }
+    }
+    else if (async == detail::Async::no) {
+      IdxT total_items = 0;
+      IdxT num_fused = 0;
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
+          num_fused += 1;
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
+        }
+      }
+      // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
+      IdxT avg_items = (total_items + num_fused - 1) / num_fused;
+      fused_pack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      this->m_fused.pos += num_fused;
+    } else {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        IdxT total_items = 0;
+        IdxT num_fused = 0;
+        this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
+          num_fused += 1;
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
+        }
+        // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, src, indices, nitems);
+        IdxT avg_items = (total_items + num_fused - 1) / num_fused;
+        fused_pack(this->m_contexts[msg->idx], this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+        this->m_fused.pos += num_fused;
+        this->m_contexts[msg->idx].finish_component_recordEvent(this->m_groups[len-1], this->m_components[msg->idx], this->m_events[msg->idx]);
+      }
+    }
+    con.finish_group(this->m_groups[len-1]);
+  }
+
+  IdxT wait_pack_complete(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, detail::Async async)
+  {
+    // FGPRINTF(FileGroup::proc, "wait_pack_complete\n");
+    if (len <= 0) return 0;
+    if (async == detail::Async::no) {
+      con_comm.waitOn(con);
+    } else {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        if (!this->m_contexts[msg->idx].queryEvent(this->m_events[msg->idx])) {
+          return i;
+        }
+      }
+    }
+    return len;
+  }
+
+  static void start_Isends(context_type& con, communicator_type& con_comm)
+  {
+    // FGPRINTF(FileGroup::proc, "start_Isends\n");
+    COMB::ignore_unused(con, con_comm);
+  }
+
+  void Isend(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
+  {
+    if (len <= 0) return;
+    start_Isends(con, con_comm);
+    for (IdxT i = 0; i < len; ++i) {
+      const message_type* msg = msgs[i];
+      char* buf = static_cast<char*>(msg->buf);
+      assert(buf != nullptr);
+      const int partner_rank = msg->partner_rank;
+      const IdxT nbytes = msg->nbytes();
+      // FGPRINTF(FileGroup::proc, "%p Put %p nbytes %d to %i\n", this, buf, nbytes, partner_rank);
+      requests[i] = con_comm.post_send(partner_rank, buf, nbytes) + 1;
+    }
+    finish_Isends(con, con_comm);
+  }
+
+  static void finish_Isends(context_type& con, communicator_type& con_comm)
+  {
+    // FGPRINTF(FileGroup::proc, "finish_Isends\n");
+    COMB::ignore_unused(con, con_comm);
+  }
+
+  void deallocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
+      assert(msg->buf != nullptr);
+
+      this->m_aloc.deallocate(msg->buf);
+
+      msg->buf = nullptr;
+    }
+
+    this->deallocate_fused_vars();
+  }
+
+};
+
+template < typename exec_policy >
+struct MessageGroup<MessageBase::Kind::recv, mpi_rma_pol, exec_policy>
+  : detail::MessageGroupInterface<MessageBase::Kind::recv, mpi_rma_pol, exec_policy>
+{
+  using base = detail::MessageGroupInterface<MessageBase::Kind::recv, mpi_rma_pol, exec_policy>;
+
+  using policy_comm       = typename base::policy_comm;
+  using communicator_type = typename base::communicator_type;
+  using message_type      = typename base::message_type;
+  using request_type      = typename base::request_type;
+  using status_type       = typename base::status_type;
+
+  using message_item_type = typename base::message_item_type;
+  using context_type      = typename base::context_type;
+  using event_type        = typename base::event_type;
+  using group_type        = typename base::group_type;
+  using component_type    = typename base::component_type;
+
+  // use the base class constructor
+  using base::base;
+
+
+  void allocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
+      assert(msg->buf == nullptr);
+
+      IdxT nbytes = msg->nbytes();
+
+      msg->buf = this->m_aloc.allocate(nbytes);
+    }
+
+    this->allocate_fused_vars(con);
+  }
+
+  void Irecv(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len, request_type* requests)
+  {
+    COMB::ignore_unused(con);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      const message_type* msg = msgs[i];
+      char* buf = static_cast<char*>(msg->buf);
+      assert(buf != nullptr);
+      const int partner_rank = msg->partner_rank;
+      const IdxT nbytes = msg->nbytes();
+      // FGPRINTF(FileGroup::proc, "%p Irecv %p nbytes %d to %i\n", this, buf, nbytes, partner_rank);
+      requests[i] = con_comm.post_recv(partner_rank, buf, nbytes) + 1;
+    }
+  }
+
+  void unpack(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con_comm);
+    if (len <= 0) return;
+    con.start_group(this->m_groups[len-1]);
+    if (!comb_allow_pack_loop_fusion()) {
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          unpack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+          buf += nbytes;
+        }
+        this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
+      }
+    }
+    else {
+      IdxT total_items = 0;
+      IdxT num_fused = 0;
+      for (IdxT i = 0; i < len; ++i) {
+        const message_type* msg = msgs[i];
+        char* buf = static_cast<char*>(msg->buf);
+        assert(buf != nullptr);
+        for (const MessageItemBase* msg_item : msg->message_items) {
+          const message_item_type* item = static_cast<const message_item_type*>(msg_item);
+          const IdxT nbytes = item->nbytes;
+          this->m_fused.set_item(num_fused, buf, item);
+          total_items += item->loop_len();
+          num_fused += 1;
+          buf += nbytes;
+          assert(item_nbytes(item->size, this->m_zone_nbytes) == nbytes);
+        }
+      }
+      // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] nitems %d\n", this, buf, dst, indices, nitems);
+      IdxT avg_items = (total_items + num_fused - 1) / num_fused;
+      fused_unpack(con, this->m_fused, num_fused, this->m_sections, avg_items, this->m_layout);
+      this->m_fused.pos += num_fused;
+    }
+    con.finish_group(this->m_groups[len-1]);
+  }
+
+  void deallocate(context_type& con, communicator_type& con_comm, message_type** msgs, IdxT len)
+  {
+    COMB::ignore_unused(con, con_comm);
+    if (len <= 0) return;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
+      assert(msg->buf != nullptr);
+
+      this->m_aloc.deallocate(msg->buf);
+
+      msg->buf = nullptr;
+    }
+
+    this->deallocate_fused_vars();
+  }
+
+};
+
+} // namespace detail
+
+#endif
+
+#endif // _COMM_POL_MPI_RMA_HPP
@@ -0,0 +1,370 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _COMM_POL_MPI_SHM_HPP
+#define _COMM_POL_MPI_SHM_HPP
+
+#include "config.hpp"
+
+#ifdef COMB_ENABLE_MPI
+
+#include <algorithm>
+
+#include "comm_pol_mpi.hpp"
+
+// mpi communication through a node shared window, the recv buffers of each
+// rank are kept in one slab allocated with MPI_Win_allocate_shared, senders
+// on the node pack directly into the buffers of their partners and send a
+// message without data when done, messages to partners off the node are
+// handled by the mpi message groups
+struct mpi_shm_pol {
+  // static const bool async = false;
+  static const bool mock = false;
+  // compile mpi_type packing/unpacking tests for this comm policy
+  static const bool use_mpi_type = false;
+  // message buffers may be kept across cycles
+  static const bool persistent_buffers = true;
+  // fused pack arrays may come from the comm util arena
+  static const bool util_arena = true;
+  // messages stay in the many group with the recv buffers in one slab in
+  // the shared window
+  static const bool slab_buffers = true;
+  static const char* get_name() { return "mpi_shm"; }
+  using send_request_type = MPI_Request;
+  using recv_request_type = MPI_Request;
+  using send_status_type = MPI_Status;
+  using recv_status_type = MPI_Status;
+};
+
+template < >
+struct CommContext<mpi_shm_pol> : CommContext<mpi_pol>
+{
+  using base = CommContext<mpi_pol>;
+
+  using pol = mpi_shm_pol;
+
+  // ranks of comm on this node
+  MPI_Comm node_comm = MPI_COMM_NULL;
+  // carries the notifications that a recv buffer may be overwritten apart
+  // from the messages on comm
+  MPI_Comm ready_comm = MPI_COMM_NULL;
+  // rank in node_comm of each rank in comm, MPI_UNDEFINED if off the node
+  std::vector<int> node_ranks;
+
+  // shared window holding the slab of recv buffers
+  MPI_Win win = MPI_WIN_NULL;
+  char* win_base = nullptr;
+
+  // notifications sent this exchange and the number expected, one per recv
+  // partner on the node
+  std::vector<MPI_Request> ready_requests;
+  int num_ready_posted = 0;
+  int num_on_node_recvs = 0;
+
+  CommContext()
+    : base()
+  { }
+
+  CommContext(MPIContext const& b)
+    : base(b)
+  { }
+
+  CommContext(CommContext const& a_, MPI_Comm comm_)
+    : base(a_, comm_)
+  { }
+
+  void connect_ranks(std::vector<int> const& send_ranks,
+                     std::vector<int> const& recv_ranks)
+  {
+    COMB::ignore_unused(send_ranks, recv_ranks);
+    node_comm = detail::MPI::Comm_split_type(comm, MPI_COMM_TYPE_SHARED, detail::MPI::Comm_rank(comm));
+    ready_comm = detail::MPI::Comm_dup(comm);
+
+    int size = detail::MPI::Comm_size(comm);
+    std::vector<int> ranks(size);
+    for (int r = 0; r < size; ++r) {
+      ranks[r] = r;
+    }
+    node_ranks.assign(size, MPI_UNDEFINED);
+    MPI_Group comm_group = detail::MPI::Comm_group(comm);
+    MPI_Group node_group = detail::MPI::Comm_group(node_comm);
+    detail::MPI::Group_translate_ranks(comm_group, size, ranks.data(), node_group, node_ranks.data());
+    detail::MPI::Group_free(&node_group);
+    detail::MPI::Group_free(&comm_group);
+  }
+
+  void disconnect_ranks(std::vector<int> const& send_ranks,
+                        std::vector<int> const& recv_ranks)
+  {
+    COMB::ignore_unused(send_ranks, recv_ranks);
+    finish_ready();
+    detail::MPI::Comm_free(&ready_comm);
+    detail::MPI::Comm_free(&node_comm);
+    node_ranks.clear();
+  }
+
+  bool on_node(int rank) const
+  {
+    return node_ranks[rank] != MPI_UNDEFINED;
+  }
+
+  // allocates the shared window, collective over node_comm
+  void* allocate_window(IdxT nbytes)
+  {
+    assert(win == MPI_WIN_NULL);
+    // a rank whose messages are all self copies has no recv buffers, keep
+    // the window from being empty on every rank of the node
+    win = detail::MPI::Win_allocate_shared(std::max(nbytes, IdxT(1)), 1, node_comm, &win_base);
+    // a passive epoch lets Win_sync order the accesses to the window
+    detail::MPI::Win_lock_all(MPI_MODE_NOCHECK, win);
+    return win_base;
+  }
+
+  void free_window(void* ptr)
+  {
+    COMB::ignore_unused(ptr);
+    assert(ptr == win_base);
+    detail::MPI::Win_unlock_all(win);
+    detail::MPI::Win_free(&win);
+    win_base = nullptr;
+  }
+
+  // start of the window of a rank on the node
+  char* window_base(int rank)
+  {
+    MPI_Aint size = 0;
+    int disp_unit = 1;
+    char* ptr = nullptr;
+    detail::MPI::Win_shared_query(win, node_ranks[rank], &size, &disp_unit, &ptr);
+    return ptr;
+  }
+
+  // makes the stores to the window visible to the ranks on the node
+  void sync()
+  {
+    detail::MPI::Win_sync(win);
+  }
+
+  // tells a send partner on the node its recv buffer may be overwritten,
+  // the notifications of the last exchange completed before the partners
+  // sent their messages
+  void post_ready(int partner_rank, int tag)
+  {
+    if (num_ready_posted == 0) {
+      finish_ready();
+      sync();
+    }
+    ready_requests.emplace_back(MPI_REQUEST_NULL);
+    detail::MPI::Isend(nullptr, 0, MPI_BYTE, partner_rank, tag, ready_comm, &ready_requests.back());
+    if (++num_ready_posted == num_on_node_recvs) {
+      num_ready_posted = 0;
+    }
+  }
+
+  // waits until the buffer of a recv partner on the node may be overwritten
+  void wait_ready(int partner_rank, int tag)
+  {
+    MPI_Request request = MPI_REQUEST_NULL;
+    detail::MPI::Irecv(nullptr, 0, MPI_BYTE, partner_rank, tag, ready_comm, &request);
+    detail::MPI::Wait(&request, MPI_STATUS_IGNORE);
+  }
+
+  void finish_ready()
+  {
+    detail::MPI::Waitall(ready_requests.size(), ready_requests.data(), MPI_STATUSES_IGNORE);
+    ready_requests.clear();
+  }
+};
+
+
+namespace detail {
+
+template < >
+struct recv_slab<mpi_shm_pol>
+{
+  // the slab is in the shared window whatever the allocator
+  static void* allocate(CommContext<mpi_shm_pol>& con_comm, COMB::Allocator&, IdxT nbytes)
+  {
+    return con_comm.allocate_window(nbytes);
+  }
+
+  static void deallocate(CommContext<mpi_shm_pol>& con_comm, COMB::Allocator&, void* ptr)
+  {
+    con_comm.free_window(ptr);
+  }
+};
+
+// recv partners on the node tell their send partners where their buffer is
+// in their window, the send buffers of those messages in the planned slab
+// are left unused
+inline void connect_buffers(CommContext<mpi_shm_pol>& con_comm,
+                            std::vector<Message<MessageBase::Kind::send, mpi_pol>*> const& send_msgs,
+                            std::vector<Message<MessageBase::Kind::recv, mpi_pol>*> const& recv_msgs)
+{
+  int send_on_node = 0;
+  int recv_on_node = 0;
+  std::vector<MPI_Aint> send_displs(send_msgs.size(), 0);
+  std::vector<MPI_Aint> recv_displs(recv_msgs.size(), 0);
+  std::vector<MPI_Request> requests;
+  requests.reserve(send_msgs.size() + recv_msgs.size());
+  for (IdxT i = 0; i < static_cast<IdxT>(send_msgs.size()); ++i) {
+    Message<MessageBase::Kind::send, mpi_pol>* msg = send_msgs[i];
+    if (!con_comm.on_node(msg->partner_rank)) continue;
+    requests.emplace_back(MPI_REQUEST_NULL);
+    detail::MPI::Irecv(&send_displs[i], 1, MPI_AINT, msg->partner_rank, msg->msg_tag, con_comm.ready_comm, &requests.back());
+  }
+  for (IdxT i = 0; i < static_cast<IdxT>(recv_msgs.size()); ++i) {
+    Message<MessageBase::Kind::recv, mpi_pol>* msg = recv_msgs[i];
+    if (!con_comm.on_node(msg->partner_rank)) continue;
+    assert(msg->buf != nullptr);
+    recv_displs[i] = static_cast<char*>(msg->buf) - con_comm.win_base;
+    requests.emplace_back(MPI_REQUEST_NULL);
+    detail::MPI::Isend(&recv_displs[i], 1, MPI_AINT, msg->partner_rank, msg->msg_tag, con_comm.ready_comm, &requests.back());
+  }
+  detail::MPI::Waitall(requests.size(), requests.data(), MPI_STATUSES_IGNORE);
+
+  for (IdxT i = 0; i < static_cast<IdxT>(send_msgs.size()); ++i) {
+    Message<MessageBase::Kind::send, mpi_pol>* msg = send_msgs[i];
+    if (!con_comm.on_node(msg->partner_rank)) continue;
+    msg->buf = con_comm.window_base(msg->partner_rank) + send_displs[i];
+    msg->on_node = true;
+    send_on_node += 1;
+  }
+  for (Message<MessageBase::Kind::recv, mpi_pol>* msg : recv_msgs) {
+    if (!con_comm.on_node(msg->partner_rank)) continue;
+    msg->on_node = true;
+    recv_on_node += 1;
+  }
+  con_comm.num_on_node_recvs = recv_on_node;
+
+  fgprintf(FileGroup::proc, "Messages on-node send %i recv %i off-node send %i recv %i\n",
+                            send_on_node, recv_on_node,
+                            static_cast<int>(send_msgs.size()) - send_on_node,
+                            static_cast<int>(recv_msgs.size()) - recv_on_node);
+}
+
+template < typename exec_policy >
+struct MessageGroup<MessageBase::Kind::send, mpi_shm_pol, exec_policy>
+  : MessageGroup<MessageBase::Kind::send, mpi_pol, exec_policy>
+{
+  using base = MessageGroup<MessageBase::Kind::send, mpi_pol, exec_policy>;
+
+  using message_type      = typename base::message_type;
+  using request_type      = typename base::request_type;
+  using context_type      = typename base::context_type;
+
+  MessageGroup(COMB::Allocator& aloc_)
+    : base(aloc_)
+  {
+    // messages on the node are packed into the buffers of their partners
+    this->m_compression = Compression::none;
+  }
+
+  // messages are not sent in place as the partner on the node must find
+  // the packed data in its buffer
+  void finalize()
+  {
+    base::base::finalize();
+  }
+
+  void pack(context_type& con, CommContext<mpi_shm_pol>& con_comm, message_type** msgs, IdxT len, detail::Async async)
+  {
+    bool synced = true;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (!msg->on_node) continue;
+      con_comm.wait_ready(msg->partner_rank, msg->msg_tag);
+      synced = false;
+    }
+    if (!synced) {
+      con_comm.sync();
+    }
+    base::pack(con, con_comm, msgs, len, async);
+  }
+
+  void Isend(context_type& con, CommContext<mpi_shm_pol>& con_comm, message_type** msgs, IdxT len, request_type* requests)
+  {
+    bool synced = false;
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (!msg->on_node) {
+        base::Isend(con, con_comm, &msgs[i], 1, &requests[i]);
+        continue;
+      }
+      if (!synced) {
+        con_comm.sync();
+        synced = true;
+      }
+      // the data is already in the buffer of the partner
+      detail::MPI::Isend(nullptr, 0, MPI_BYTE, msg->partner_rank, msg->msg_tag, con_comm.comm, &requests[i]);
+    }
+  }
+};
+
+template < typename exec_policy >
+struct MessageGroup<MessageBase::Kind::recv, mpi_shm_pol, exec_policy>
+  : MessageGroup<MessageBase::Kind::recv, mpi_pol, exec_policy>
+{
+  using base = MessageGroup<MessageBase::Kind::recv, mpi_pol, exec_policy>;
+
+  using message_type      = typename base::message_type;
+  using request_type      = typename base::request_type;
+  using context_type      = typename base::context_type;
+
+  MessageGroup(COMB::Allocator& aloc_)
+    : base(aloc_)
+  {
+    // messages on the node are unpacked from the buffers their partners
+    // packed into
+    this->m_compression = Compression::none;
+  }
+
+  // messages are not received in place as the partner on the node packs
+  // into the buffer
+  void finalize()
+  {
+    base::base::finalize();
+  }
+
+  void Irecv(context_type& con, CommContext<mpi_shm_pol>& con_comm, message_type** msgs, IdxT len, request_type* requests)
+  {
+    for (IdxT i = 0; i < len; ++i) {
+      message_type* msg = msgs[i];
+      if (!msg->on_node) {
+        base::Irecv(con, con_comm, &msgs[i], 1, &requests[i]);
+        continue;
+      }
+      con_comm.post_ready(msg->partner_rank, msg->msg_tag);
+      detail::MPI::Irecv(nullptr, 0, MPI_BYTE, msg->partner_rank, msg->msg_tag, con_comm.comm, &requests[i]);
+    }
+  }
+
+  void unpack(context_type& con, CommContext<mpi_shm_pol>& con_comm, message_type** msgs, IdxT len)
+  {
+    for (IdxT i = 0; i < len; ++i) {
+      if (msgs[i]->on_node) {
+        con_comm.sync();
+        break;
+      }
+    }
+    base::unpack(con, con_comm, msgs, len);
+  }
+};
+
+} // namespace detail
+
+#endif
+
+#endif // _COMM_POL_MPI_SHM_HPP
@@ -31,6 +31,12 @@ struct umr_pol {
   static const bool mock = false;
   // compile mpi_type packing/unpacking tests for this comm policy
   static const bool use_mpi_type = false;
+  // message buffers may be kept across cycles
+  static const bool persistent_buffers = true;
+  // packs without fused pack arrays
+  static const bool util_arena = false;
+  // message buffers are placed per message group
+  static const bool slab_buffers = false;
   static const char* get_name() { return "umr"; }
   using send_request_type = UMR_Request;
   using recv_request_type = UMR_Request;
@@ -257,9 +263,10 @@ struct MessageGroup<MessageBase::Kind::send, umr_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       msg->buf = this->m_aloc.allocate(nbytes);
     }
@@ -277,15 +284,9 @@ struct MessageGroup<MessageBase::Kind::send, umr_pol, exec_policy>
       this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
       for (const MessageItemBase* msg_item : msg->message_items) {
         const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-        const IdxT len = item->size;
         const IdxT nbytes = item->nbytes;
-        LidxT const* indices = item->indices;
-        for (DataT const* src : this->m_variables) {
-          // FGPRINTF(FileGroup::proc, "%p pack %p = %p[%p] len %d\n", this, buf, src, indices, len);
-          this->m_contexts[msg->idx].for_all(0, len, make_copy_idxr_idxr(src, detail::indexer_list_idx{indices},
-                                             static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{}));
-          buf += nbytes;
-        }
+        pack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+        buf += nbytes;
       }
       if (async == detail::Async::no) {
         this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
@@ -329,7 +330,7 @@ struct MessageGroup<MessageBase::Kind::send, umr_pol, exec_policy>
       assert(buf != nullptr);
       const int partner_rank = msg->partner_rank;
       const int tag = msg->msg_tag;
-      const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      const IdxT nbytes = msg->nbytes();
       // FGPRINTF(FileGroup::proc, "%p Isend %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
       detail::UMR::Isend(buf, nbytes, UMR_BYTE,
                          partner_rank, tag, con_comm.comm, &requests[i]);
@@ -349,6 +350,7 @@ struct MessageGroup<MessageBase::Kind::send, umr_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
       assert(msg->buf != nullptr);
 
       this->m_aloc.deallocate(msg->buf);
@@ -386,9 +388,10 @@ struct MessageGroup<MessageBase::Kind::recv, umr_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers && msg->buf != nullptr) continue;
       assert(msg->buf == nullptr);
 
-      IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      IdxT nbytes = msg->nbytes();
 
       msg->buf = this->m_aloc.allocate(nbytes);
     }
@@ -404,7 +407,7 @@ struct MessageGroup<MessageBase::Kind::recv, umr_pol, exec_policy>
       assert(buf != nullptr);
       const int partner_rank = msg->partner_rank;
       const int tag = msg->msg_tag;
-      const IdxT nbytes = msg->nbytes() * this->m_variables.size();
+      const IdxT nbytes = msg->nbytes();
       // FGPRINTF(FileGroup::proc, "%p Irecv %p nbytes %d to %i tag %i\n", this, buf, nbytes, partner_rank, tag);
       detail::UMR::Irecv(buf, nbytes, UMR_BYTE,
                          partner_rank, tag, con_comm.comm, &requests[i]);
@@ -423,15 +426,9 @@ struct MessageGroup<MessageBase::Kind::recv, umr_pol, exec_policy>
       this->m_contexts[msg->idx].start_component(this->m_groups[len-1], this->m_components[msg->idx]);
       for (const MessageItemBase* msg_item : msg->message_items) {
         const message_item_type* item = static_cast<const message_item_type*>(msg_item);
-        const IdxT len = item->size;
         const IdxT nbytes = item->nbytes;
-        LidxT const* indices = item->indices;
-        for (DataT* dst : this->m_variables) {
-          // FGPRINTF(FileGroup::proc, "%p unpack %p[%p] = %p len %d\n", this, dst, indices, buf, len);
-          this->m_contexts[msg->idx].for_all(0, len, make_copy_idxr_idxr(static_cast<DataT*>(static_cast<void*>(buf)), detail::indexer_idx{},
-                                             dst, detail::indexer_list_idx{indices}));
-          buf += nbytes;
-        }
+        unpack_item_vars(this->m_contexts[msg->idx], item, this->m_sections, this->m_variables, buf, this->m_layout);
+        buf += nbytes;
       }
       this->m_contexts[msg->idx].finish_component(this->m_groups[len-1], this->m_components[msg->idx]);
     }
@@ -444,6 +441,7 @@ struct MessageGroup<MessageBase::Kind::recv, umr_pol, exec_policy>
     if (len <= 0) return;
     for (IdxT i = 0; i < len; ++i) {
       message_type* msg = msgs[i];
+      if (this->m_persistent_buffers) continue;
       assert(msg->buf != nullptr);
 
       this->m_aloc.deallocate(msg->buf);
@@ -0,0 +1,103 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _COMPRESS_HPP
+#define _COMPRESS_HPP
+
+#include "config.hpp"
+
+#include <memory>
+#include <vector>
+
+#include "utils.hpp"
+
+// codec used to compress message buffers between packing and sending
+enum struct Compression
+{
+  none
+ ,shuffle_rle // byte shuffle then run-length encoding
+ ,lz          // LZ77 style matching of repeated byte sequences
+};
+
+inline const char* compression_str(Compression compression)
+{
+  const char* str = "unknown";
+  switch (compression) {
+    case Compression::none:        str = "none";        break;
+    case Compression::shuffle_rle: str = "shuffle_rle"; break;
+    case Compression::lz:          str = "lz";          break;
+  }
+  return str;
+}
+
+inline Compression& comb_compression()
+{
+  static Compression compression = Compression::none;
+  return compression;
+}
+
+// fraction of zones set to a constant value when initializing the mesh,
+// the other zones get pseudo-random values
+inline double& comb_compressibility()
+{
+  static double compressibility = 1.0;
+  return compressibility;
+}
+
+namespace COMB {
+
+struct Codec
+{
+  virtual ~Codec() { }
+  virtual const char* name() = 0;
+  // upper bound on the output of compress
+  virtual IdxT max_compressed_nbytes(IdxT nbytes) = 0;
+  // returns the number of bytes written to dst
+  virtual IdxT compress(const char* src, IdxT nbytes, char* dst) = 0;
+  virtual void decompress(const char* src, IdxT compressed_nbytes, char* dst, IdxT nbytes) = 0;
+};
+
+// elem_size is the size of the values in the buffers, used by shuffling codecs
+extern std::unique_ptr<Codec> make_codec(Compression compression, IdxT elem_size);
+
+// totals over the messages compressed and decompressed on this rank
+struct CompressionStats
+{
+  double raw_nbytes = 0.0;
+  double compressed_nbytes = 0.0;
+  double compress_time = 0.0;
+  double decompress_time = 0.0;
+  long num_compressed = 0;
+  long num_decompressed = 0;
+
+  void clear() { *this = CompressionStats{}; }
+};
+
+inline CompressionStats& comb_compression_stats()
+{
+  static CompressionStats stats;
+  return stats;
+}
+
+// compressed messages are a header followed by the codec output,
+// or by the raw buffer when the codec does not make it smaller
+extern IdxT compressed_message_max_nbytes(Codec& codec, IdxT nbytes);
+// returns the number of bytes to send
+extern IdxT compress_message(Codec& codec, const void* buf, IdxT nbytes, void* zbuf);
+extern void decompress_message(Codec& codec, const void* zbuf, void* buf, IdxT nbytes);
+
+} // namespace COMB
+
+#endif // _COMPRESS_HPP
@@ -97,6 +97,11 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
       }
     }
 
+    // policies with one buffer slab per direction keep every message in one group
+    if (pol_comm::slab_buffers) {
+      comminfo.cutoff = 0;
+    }
+
     // make communicator object
     comm_type comm(con_comm, comminfo, aloc_mesh, aloc_many, aloc_few);
 
@@ -112,11 +117,11 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        vars.push_back(MeshData(info, aloc_mesh));
+        vars.push_back(MeshData(info, aloc_mesh, comb_var_type(i)));
 
         vars[i].allocate();
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
         IdxT totallen = info.totallen;
 
         con_mesh.for_all(0, totallen,
@@ -130,6 +135,14 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
       factory.populate(comm, con_many, con_few);
     }
 
+    if (comb_allow_low_footprint()) {
+      CommFootprint fp = comm.footprint();
+      for (MeshData const& var : vars) {
+        fp.mesh_nbytes += var.nbytes();
+      }
+      print_footprint(comminfo, fp);
+    }
+
     tm_total.stop(tm_con);
 
     comm.barrier();
@@ -144,6 +157,8 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
       Range r2("cycle", Range::cyan);
 
       bool mock_communication = comm.mock_communication();
+      // double values sent at reduced precision are compared with a tolerance
+      DataT tolerance = wire_precision_tolerance(comb_wire_precision());
       IdxT imin = info.min[0];
       IdxT jmin = info.min[1];
       IdxT kmin = info.min[2];
@@ -165,6 +180,7 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
       IdxT ighost_width = info.ghost_widths[0];
       IdxT jghost_width = info.ghost_widths[1];
       IdxT kghost_width = info.ghost_widths[2];
+      IdxT jstride = info.stride[1];
       IdxT ijlen = info.stride[2];
       IdxT ijlen_global = ilen_global * jlen_global;
 
@@ -174,7 +190,7 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
         IdxT var_i = i + 1;
 
         con_mesh.for_all_3d(0, klen,
@@ -182,7 +198,7 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
                                0, ilen,
                                [=] COMB_HOST COMB_DEVICE (IdxT k, IdxT j, IdxT i, IdxT idx) {
           COMB::ignore_unused(idx);
-          IdxT zone = i + j * ilen + k * ijlen;
+          IdxT zone = i + j * jstride + k * ijlen;
           IdxT iglobal = i + iglobal_offset;
           if (iperiodic) {
             iglobal = iglobal % ilen_global;
@@ -205,13 +221,13 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
               j >= jmin+jghost_width && j < jmax-jghost_width &&
               i >= imin+ighost_width && i < imax-ighost_width) {
             // interior non-communicated zones
-            expected = -1.0; found = data[zone]; next =-(zone_global+var_i);
+            expected = -1.0; found = data.load(zone); next =-(zone_global+var_i);
             branchid = 0;
           } else if (k >= kmin && k < kmax &&
                      j >= jmin && j < jmax &&
                      i >= imin && i < imax) {
             // interior communicated zones
-            expected = -1.0; found = data[zone]; next = zone_global + var_i;
+            expected = -1.0; found = data.load(zone); next = zone_global + var_i;
             branchid = 1;
           } else if (iglobal < 0 || iglobal >= ilen_global ||
                      jglobal < 0 || jglobal >= jlen_global ||
@@ -219,21 +235,21 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
             // out of global bounds exterior zones, some may be owned others not
             // some may be communicated if at least one dimension is periodic
             // and another is non-periodic
-            expected = -1.0; found = data[zone]; next = zone_global + var_i;
+            expected = -1.0; found = data.load(zone); next = zone_global + var_i;
             branchid = 2;
           } else {
             // in global bounds exterior zones
-            expected = -1.0; found = data[zone]; next =-(zone_global+var_i);
+            expected = -1.0; found = data.load(zone); next =-(zone_global+var_i);
             branchid = 3;
           }
           if (!mock_communication) {
-            if (found != expected) {
-              FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
+            if (!values_match(found, expected, tolerance)) {
+              FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data.ptr, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
             }
             // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
-            assert(found == expected);
+            assert(values_match(found, expected, tolerance));
           }
-          data[zone] = next;
+          data.store(zone, next);
         });
       }
 
@@ -256,7 +272,7 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
 
       // for (IdxT i = 0; i < num_vars; ++i) {
 
-      //   DataT* data = vars[i].data();
+      //   ElemPtr data = vars[i].data();
       //   IdxT var_i = i + 1;
 
       //   con_mesh.for_all_3d(0, klen,
@@ -264,7 +280,7 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
       //                          0, ilen,
       //                          [=] COMB_HOST COMB_DEVICE (IdxT k, IdxT j, IdxT i, IdxT idx) {
       //     COMB::ignore_unused(idx);
-      //     IdxT zone = i + j * ilen + k * ijlen;
+      //     IdxT zone = i + j * jstride + k * ijlen;
       //     IdxT iglobal = i + iglobal_offset;
       //     if (iperiodic) {
       //       iglobal = iglobal % ilen_global;
@@ -287,11 +303,11 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
       //         j >= jmin+jghost_width && j < jmax-jghost_width &&
       //         i >= imin+ighost_width && i < imax-ighost_width) {
       //       // interior non-communicated zones should not have changed value
-      //       expected =-(zone_global+var_i); found = data[zone]; next = -1.0;
+      //       expected =-(zone_global+var_i); found = data.load(zone); next = -1.0;
       //       branchid = 0;
       //       if (!mock_communication) {
       //         if (found != expected) {
-      //           FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
+      //           FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data.ptr, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
       //         }
       //         // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
       //         assert(found == expected);
@@ -322,7 +338,7 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
         IdxT var_i = i + 1;
 
         con_mesh.for_all_3d(0, klen,
@@ -330,7 +346,7 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
                                0, ilen,
                                [=] COMB_HOST COMB_DEVICE (IdxT k, IdxT j, IdxT i, IdxT idx) {
           COMB::ignore_unused(idx);
-          IdxT zone = i + j * ilen + k * ijlen;
+          IdxT zone = i + j * jstride + k * ijlen;
           IdxT iglobal = i + iglobal_offset;
           if (iperiodic) {
             iglobal = iglobal % ilen_global;
@@ -353,35 +369,35 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
               j >= jmin+jghost_width && j < jmax-jghost_width &&
               i >= imin+ighost_width && i < imax-ighost_width) {
             // interior non-communicated zones should not have changed value
-            expected =-(zone_global+var_i); found = data[zone]; next = -1.0;
+            expected =-(zone_global+var_i); found = data.load(zone); next = -1.0;
             branchid = 0;
           } else if (k >= kmin && k < kmax &&
                      j >= jmin && j < jmax &&
                      i >= imin && i < imax) {
             // interior communicated zones should not have changed value
-            expected = zone_global + var_i; found = data[zone]; next = -1.0;
+            expected = zone_global + var_i; found = data.load(zone); next = -1.0;
             branchid = 1;
           } else if (iglobal < 0 || iglobal >= ilen_global ||
                      jglobal < 0 || jglobal >= jlen_global ||
                      kglobal < 0 || kglobal >= klen_global) {
             // out of global bounds exterior zones should not have changed value
             // some may have been communicated, but values should be the same
-            expected = zone_global + var_i; found = data[zone]; next = -1.0;
+            expected = zone_global + var_i; found = data.load(zone); next = -1.0;
             branchid = 2;
           } else {
             // in global bounds exterior zones should have changed value
             // should now be populated with data from another rank
-            expected = zone_global + var_i; found = data[zone]; next = -1.0;
+            expected = zone_global + var_i; found = data.load(zone); next = -1.0;
             branchid = 3;
           }
           if (!mock_communication) {
-            if (found != expected) {
-              FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
+            if (!values_match(found, expected, tolerance)) {
+              FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data.ptr, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
             }
             // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
-            assert(found == expected);
+            assert(values_match(found, expected, tolerance));
           }
-          data[zone] = next;
+          data.store(zone, next);
         });
       }
 
@@ -397,7 +413,18 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
 
     tm_total.stop(tm_con);
 
+    // memory spaces of the mesh, message buffers, and index lists
+    std::vector<COMB::Allocator*> alocs{&aloc_mesh, &aloc_many, &aloc_few,
+                                        &con_mesh.util_aloc, &con_many.util_aloc, &con_few.util_aloc};
+
     tm.clear();
+    COMB::comb_compression_stats().clear();
+    for (COMB::Allocator* aloc : alocs) {
+      aloc->clear_stats();
+    }
+    for (COMB::ArenaAllocator* arena : comm.util_arenas()) {
+      arena->clear_stats();
+    }
 
     r1.restart("bench comm", Range::magenta);
 
@@ -416,6 +443,7 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
       IdxT ilen = info.len[0];
       IdxT jlen = info.len[1];
       IdxT klen = info.len[2];
+      IdxT jstride = info.stride[1];
       IdxT ijlen = info.stride[2];
 
 
@@ -424,12 +452,12 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
 
         con_mesh.for_all_3d(kmin, kmax,
                                jmin, jmax,
                                imin, imax,
-                               detail::set_1(ilen, ijlen, data));
+                               detail::set_1(jstride, ijlen, data, comb_compressibility(), i));
       }
 
       con_mesh.synchronize();
@@ -452,26 +480,26 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
       /*
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
 
         con_mesh.for_all_3d(0, klen,
                                0, jlen,
                                0, ilen,
                                [=] COMB_HOST COMB_DEVICE (IdxT k, IdxT j, IdxT i, IdxT idx) {
-          IdxT zone = i + j * ilen + k * ijlen;
+          IdxT zone = i + j * jstride + k * ijlen;
           DataT expected, found, next;
           if (k >= kmin && k < kmax &&
               j >= jmin && j < jmax &&
               i >= imin && i < imax) {
-            expected = 1.0; found = data[zone]; next = 1.0;
+            expected = 1.0; found = data.load(zone); next = 1.0;
           } else {
-            expected = -1.0; found = data[zone]; next = -1.0;
+            expected = -1.0; found = data.load(zone); next = -1.0;
           }
           // if (found != expected) {
           //   FGPRINTF(FileGroup::proc, "zone %i(%i %i %i) = %f expected %f\n", zone, i, j, k, found, expected);
           // }
           //FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
-          data[zone] = next;
+          data.store(zone, next);
         });
       }
       */
@@ -493,12 +521,12 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
 
         con_mesh.for_all_3d(0, klen,
                                0, jlen,
                                0, ilen,
-                               detail::reset_1(ilen, ijlen, data, imin, jmin, kmin, imax, jmax, kmax));
+                               detail::reset_1(jstride, ijlen, data, imin, jmin, kmin, imax, jmax, kmax));
       }
 
       con_mesh.synchronize();
@@ -518,12 +546,20 @@ void do_cycles(CommContext<pol_comm>& con_comm_in,
 
     print_timer(comminfo, tm);
     print_timer(comminfo, tm_total);
+    print_compression(comminfo, tm);
+    print_memory_stats(comminfo, alocs, ncycles);
+    print_util_arenas(comminfo, comm.util_arenas(), ncycles);
+    print_numa_placement(comminfo, "mesh", aloc_mesh);
+    if (&aloc_many != &aloc_mesh) {
+      print_numa_placement(comminfo, "buffers", aloc_many);
+    }
+    if (&aloc_few != &aloc_mesh && &aloc_few != &aloc_many) {
+      print_numa_placement(comminfo, "buffers", aloc_few);
+    }
   }
 
   tm.clear();
   tm_total.clear();
-
-  // print_proc_memory_stats(comminfo);
 }
 
 
@@ -581,6 +617,9 @@ void do_cycles_allocator(CommContext<comm_pol>& con_comm,
   if (exec_avail.seq && exec_avail.seq && exec_avail.seq && should_do_cycles(con_comm, exec.seq, mesh_aloc, exec.seq, cpu_many_aloc, exec.seq, cpu_few_aloc))
     do_cycles(con_comm, comminfo, info, num_vars, ncycles, exec.seq, mesh_aloc.allocator(), exec.seq, cpu_many_aloc.allocator(), exec.seq, cpu_few_aloc.allocator(), tm, tm_total);
 
+  if (exec_avail.seq && exec_avail.simd && exec_avail.simd && should_do_cycles(con_comm, exec.seq, mesh_aloc, exec.simd, cpu_many_aloc, exec.simd, cpu_few_aloc))
+    do_cycles(con_comm, comminfo, info, num_vars, ncycles, exec.seq, mesh_aloc.allocator(), exec.simd, cpu_many_aloc.allocator(), exec.simd, cpu_few_aloc.allocator(), tm, tm_total);
+
 #ifdef COMB_ENABLE_OPENMP
   if (exec_avail.omp && exec_avail.seq && exec_avail.seq && should_do_cycles(con_comm, exec.omp, mesh_aloc, exec.seq, cpu_many_aloc, exec.seq, cpu_few_aloc))
     do_cycles(con_comm, comminfo, info, num_vars, ncycles, exec.omp, mesh_aloc.allocator(), exec.seq, cpu_many_aloc.allocator(), exec.seq, cpu_few_aloc.allocator(), tm, tm_total);
@@ -676,6 +715,60 @@ void do_cycles_allocators(CommContext<comm_pol>& con_comm,
                       exec_avail,
                       num_vars, ncycles, tm, tm_total);
 
+  do_cycles_allocator(con_comm,
+                      comminfo, info,
+                      exec,
+                      alloc.host_pool,
+                      cpu_many_aloc, cpu_few_aloc,
+                      cuda_many_aloc, cuda_few_aloc,
+                      exec_avail,
+                      num_vars, ncycles, tm, tm_total);
+
+  do_cycles_allocator(con_comm,
+                      comminfo, info,
+                      exec,
+                      alloc.host_hugepage,
+                      cpu_many_aloc, cpu_few_aloc,
+                      cuda_many_aloc, cuda_few_aloc,
+                      exec_avail,
+                      num_vars, ncycles, tm, tm_total);
+
+  do_cycles_allocator(con_comm,
+                      comminfo, info,
+                      exec,
+                      alloc.host_numa_interleave,
+                      cpu_many_aloc, cpu_few_aloc,
+                      cuda_many_aloc, cuda_few_aloc,
+                      exec_avail,
+                      num_vars, ncycles, tm, tm_total);
+
+  do_cycles_allocator(con_comm,
+                      comminfo, info,
+                      exec,
+                      alloc.host_numa_local,
+                      cpu_many_aloc, cpu_few_aloc,
+                      cuda_many_aloc, cuda_few_aloc,
+                      exec_avail,
+                      num_vars, ncycles, tm, tm_total);
+
+  do_cycles_allocator(con_comm,
+                      comminfo, info,
+                      exec,
+                      alloc.host_numa_first_touch,
+                      cpu_many_aloc, cpu_few_aloc,
+                      cuda_many_aloc, cuda_few_aloc,
+                      exec_avail,
+                      num_vars, ncycles, tm, tm_total);
+
+  do_cycles_allocator(con_comm,
+                      comminfo, info,
+                      exec,
+                      alloc.host_shm,
+                      cpu_many_aloc, cpu_few_aloc,
+                      cuda_many_aloc, cuda_few_aloc,
+                      exec_avail,
+                      num_vars, ncycles, tm, tm_total);
+
 #ifdef COMB_ENABLE_CUDA
 
   do_cycles_allocator(con_comm,
@@ -22,6 +22,7 @@
 #include <cstdlib>
 
 #include <type_traits>
+#include <vector>
 
 #include "utils.hpp"
 #include "memory.hpp"
@@ -40,6 +41,205 @@ inline bool& comb_allow_pack_loop_fusion()
   return allow;
 }
 
+// send and receive messages of one strided box in place in the mesh
+inline bool& comb_allow_zero_copy()
+{
+  static bool allow = false;
+  return allow;
+}
+
+// allocate message buffers once when the comm is populated and keep them
+// for its lifetime instead of every cycle
+inline bool& comb_allow_persistent_buffers()
+{
+  static bool allow = false;
+  return allow;
+}
+
+// take the fused pack arrays from a per comm arena that is reset at the
+// end of each exchange instead of the util allocator
+inline bool& comb_allow_util_arena()
+{
+  static bool allow = false;
+  return allow;
+}
+
+// describe message items by box instead of index lists and place the
+// message buffers in one slab per allocator planned when the comm is populated
+inline bool& comb_allow_low_footprint()
+{
+  static bool allow = false;
+  return allow;
+}
+
+// copy the zones of messages whose partner is this rank directly in the
+// mesh instead of packing, messaging, and unpacking them
+inline bool& comb_allow_self_copy()
+{
+  static bool allow = true;
+  return allow;
+}
+
+// how message items describe the zones they pack and unpack
+enum struct PackMode
+{
+  list // one index per zone
+ ,box  // box extents and strides, packed as contiguous runs
+ ,runs // (start, length) runs of contiguous zones
+};
+
+inline const char* pack_mode_str(PackMode mode)
+{
+  const char* str = "unknown";
+  switch (mode) {
+    case PackMode::list: str = "list"; break;
+    case PackMode::box:  str = "box";  break;
+    case PackMode::runs: str = "runs"; break;
+  }
+  return str;
+}
+
+inline PackMode& comb_pack_mode()
+{
+  static PackMode mode = PackMode::list;
+  return mode;
+}
+
+// how the variables of list items are laid out in message buffers
+enum struct BufferLayout
+{
+  variable // all zones of a variable are contiguous
+ ,zone     // all variables of a zone are contiguous
+};
+
+inline const char* buffer_layout_str(BufferLayout layout)
+{
+  const char* str = "unknown";
+  switch (layout) {
+    case BufferLayout::variable: str = "variable"; break;
+    case BufferLayout::zone:     str = "zone";     break;
+  }
+  return str;
+}
+
+inline BufferLayout& comb_buffer_layout()
+{
+  static BufferLayout layout = BufferLayout::variable;
+  return layout;
+}
+
+// how the simd packing kernels write message buffers
+enum struct PackStore
+{
+  cached    // regular stores
+ ,streaming // non-temporal stores to buffers, prefetch of indexed mesh zones
+};
+
+inline const char* pack_store_str(PackStore store)
+{
+  const char* str = "unknown";
+  switch (store) {
+    case PackStore::cached:    str = "cached";    break;
+    case PackStore::streaming: str = "streaming"; break;
+  }
+  return str;
+}
+
+inline PackStore& comb_pack_store()
+{
+  static PackStore store = PackStore::cached;
+  return store;
+}
+
+// how the mpi_rma comm policy synchronizes the windows of its partners
+enum struct RmaSync
+{
+  fence   // MPI_Win_fence over the comm
+ ,pscw    // post start complete wait with the partners
+ ,passive // lock_all with flushes and notification flags
+};
+
+inline const char* rma_sync_str(RmaSync sync)
+{
+  const char* str = "unknown";
+  switch (sync) {
+    case RmaSync::fence:   str = "fence";   break;
+    case RmaSync::pscw:    str = "pscw";    break;
+    case RmaSync::passive: str = "passive"; break;
+  }
+  return str;
+}
+
+inline RmaSync& comb_rma_sync()
+{
+  static RmaSync sync = RmaSync::fence;
+  return sync;
+}
+
+// precision of double variables in message buffers
+enum struct WirePrecision
+{
+  full // double
+ ,f32  // float
+ ,bf16 // bfloat16
+};
+
+inline const char* wire_precision_str(WirePrecision wire)
+{
+  const char* str = "unknown";
+  switch (wire) {
+    case WirePrecision::full: str = "full"; break;
+    case WirePrecision::f32:  str = "float"; break;
+    case WirePrecision::bf16: str = "bf16"; break;
+  }
+  return str;
+}
+
+inline WirePrecision& comb_wire_precision()
+{
+  static WirePrecision wire = WirePrecision::full;
+  return wire;
+}
+
+// bytes per zone of a variable in message buffers
+inline IdxT wire_elem_size(ElemType type, WirePrecision wire)
+{
+  IdxT size = elem_type_size(type);
+  if (type == ElemType::f64) {
+    switch (wire) {
+      case WirePrecision::full: break;
+      case WirePrecision::f32:  size = sizeof(float); break;
+      case WirePrecision::bf16: size = sizeof(detail::bf16); break;
+    }
+  }
+  return size;
+}
+
+// relative error of double values sent at the given precision
+inline DataT wire_precision_tolerance(WirePrecision wire)
+{
+  DataT tol = 0.0;
+  switch (wire) {
+    case WirePrecision::full: tol = 0.0; break;
+    case WirePrecision::f32:  tol = 1.0 / (1 << 23); break;
+    case WirePrecision::bf16: tol = 1.0 / (1 << 7);  break;
+  }
+  return tol;
+}
+
+// element types of the variables, variables without a type are double
+inline std::vector<ElemType>& comb_var_types()
+{
+  static std::vector<ElemType> types;
+  return types;
+}
+
+inline ElemType comb_var_type(IdxT i)
+{
+  std::vector<ElemType> const& types = comb_var_types();
+  return (i < static_cast<IdxT>(types.size())) ? types[i] : ElemType::f64;
+}
+
 namespace detail {
 
 template < typename body_type >
@@ -104,6 +304,7 @@ struct adapter_3d {
 
 #include "pol_seq.hpp"
 #include "pol_omp.hpp"
+#include "pol_simd.hpp"
 #include "pol_cuda.hpp"
 #include "pol_cuda_batch.hpp"
 #include "pol_cuda_persistent.hpp"
@@ -116,6 +317,7 @@ struct ExecutorsAvailable
 {
   bool seq = false;
   bool omp = false;
+  bool simd = false;
   bool cuda = false;
   bool cuda_batch = false;
   bool cuda_batch_fewgs = false;
@@ -139,6 +341,7 @@ struct ExecContexts
 #ifdef COMB_ENABLE_OPENMP
   ExecContext<omp_pol> omp;
 #endif
+  ExecContext<simd_pol> simd;
 #ifdef COMB_ENABLE_CUDA
   ExecContext<cuda_pol> cuda;
   ExecContext<cuda_batch_pol> cuda_batch;
@@ -156,6 +359,7 @@ struct ExecContexts
 #ifdef COMB_ENABLE_OPENMP
     , omp(base_cpu, alocs.host.allocator())
 #endif
+    , simd(base_cpu, alocs.host.allocator())
 #ifdef COMB_ENABLE_CUDA
     , cuda(base_cuda, (alocs.access.use_device_preferred_for_cuda_util_aloc) ? alocs.cuda_managed_device_preferred_host_accessed.allocator() : alocs.cuda_hostpinned.allocator())
     , cuda_batch(base_cuda, (alocs.access.use_device_preferred_for_cuda_util_aloc) ? alocs.cuda_managed_device_preferred_host_accessed.allocator() : alocs.cuda_hostpinned.allocator())
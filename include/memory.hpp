@@ -20,19 +20,196 @@
 
 #include <cstdio>
 #include <cstdlib>
+#include <algorithm>
+#include <chrono>
+#include <mutex>
 #include <stdexcept>
+#include <unordered_map>
+#include <vector>
 
-#include "basic_mempool.hpp"
+#if defined(__linux__)
+#include <sys/mman.h>
+#endif
+
+#include "size_class_mempool.hpp"
+#include "thread_cache_mempool.hpp"
 
 #include "ExecContext.hpp"
 #include "utils_cuda.hpp"
+#include "utils_numa.hpp"
+#include "utils_shm.hpp"
 
 namespace COMB {
 
 namespace detail {
 
 template < typename alloc >
-using mempool = RAJA::basic_mempool::MemPool<alloc>;
+using mempool = size_class_mempool::MemPool<alloc>;
+
+template < typename alloc >
+using thread_mempool = thread_cache_mempool::MemPool<alloc>;
+
+  struct host_allocator {
+    void* malloc(size_t nbytes) {
+      return std::malloc(nbytes);
+    }
+    void free(void* ptr) {
+      std::free(ptr);
+    }
+  };
+
+  // ranges mapped by the host allocators below with their lengths,
+  // allocations that fell back to malloc have length 0
+  struct page_mappings {
+    static std::mutex& mutex()
+    {
+      static std::mutex m;
+      return m;
+    }
+    static std::unordered_map<void*, size_t>& lengths()
+    {
+      static std::unordered_map<void*, size_t> l;
+      return l;
+    }
+
+    // maps at least nbytes aligned to align, returns nullptr on failure
+    static void* map(size_t nbytes, size_t align, int flags = 0)
+    {
+      void* ptr = nullptr;
+#if defined(__linux__)
+      size_t len = (nbytes + align - 1) / align * align;
+      if (flags != 0) {
+        ptr = mmap(nullptr, len, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS|flags, -1, 0);
+        if (ptr == MAP_FAILED) ptr = nullptr;
+      } else {
+        // over map so the range can be trimmed to align
+        void* map_ptr = mmap(nullptr, len + align, PROT_READ|PROT_WRITE, MAP_PRIVATE|MAP_ANONYMOUS, -1, 0);
+        if (map_ptr != MAP_FAILED) {
+          char* map_begin = static_cast<char*>(map_ptr);
+          char* begin = reinterpret_cast<char*>((reinterpret_cast<uintptr_t>(map_begin) + align - 1) / align * align);
+          char* end = begin + len;
+          if (begin != map_begin) munmap(map_begin, begin - map_begin);
+          munmap(end, map_begin + len + align - end);
+          ptr = begin;
+        }
+      }
+      if (ptr != nullptr) {
+        std::lock_guard<std::mutex> lock(mutex());
+        lengths()[ptr] = len;
+      }
+#else
+      static_cast<void>(nbytes); static_cast<void>(align); static_cast<void>(flags);
+#endif
+      return ptr;
+    }
+
+    static void* fallback_malloc(size_t nbytes)
+    {
+      void* ptr = std::malloc(nbytes);
+      if (ptr != nullptr) {
+        std::lock_guard<std::mutex> lock(mutex());
+        lengths()[ptr] = 0;
+      }
+      return ptr;
+    }
+
+    static void unmap(void* ptr)
+    {
+      size_t len = 0;
+      {
+        std::lock_guard<std::mutex> lock(mutex());
+        auto found = lengths().find(ptr);
+        assert(found != lengths().end());
+        len = found->second;
+        lengths().erase(found);
+      }
+#if defined(__linux__)
+      if (len > 0) {
+        munmap(ptr, len);
+        return;
+      }
+#endif
+      std::free(ptr);
+    }
+  };
+
+  // maps host memory with 2 MiB pages, from the reserved huge pages if
+  // possible, else as transparent huge pages, else with malloc
+  struct host_hugepage_allocator {
+    static const size_t page_nbytes = 2ull * 1024ull * 1024ull;
+
+    void* malloc(size_t nbytes) {
+      void* ptr = nullptr;
+#if defined(__linux__) && defined(MAP_HUGETLB)
+      ptr = page_mappings::map(nbytes, page_nbytes, MAP_HUGETLB);
+#endif
+#if defined(__linux__)
+      if (ptr == nullptr) {
+        ptr = page_mappings::map(nbytes, page_nbytes);
+#if defined(MADV_HUGEPAGE)
+        if (ptr != nullptr) madvise(ptr, nbytes, MADV_HUGEPAGE);
+#endif
+      }
+#endif
+      if (ptr == nullptr) {
+        ptr = page_mappings::fallback_malloc(nbytes);
+      }
+      return ptr;
+    }
+    void free(void* ptr) {
+      page_mappings::unmap(ptr);
+    }
+  };
+
+  // maps host memory with its pages interleaved across the numa nodes
+  struct host_numa_interleave_allocator {
+    void* malloc(size_t nbytes) {
+      void* ptr = page_mappings::map(nbytes, ::detail::numa::page_nbytes());
+      if (ptr != nullptr) {
+        ::detail::numa::mbind(ptr, nbytes, ::detail::numa::mpol_interleave, ::detail::numa::all_nodes_mask());
+      } else {
+        ptr = page_mappings::fallback_malloc(nbytes);
+      }
+      return ptr;
+    }
+    void free(void* ptr) {
+      page_mappings::unmap(ptr);
+    }
+  };
+
+  // maps host memory bound to the numa node of the allocating thread
+  struct host_numa_local_allocator {
+    void* malloc(size_t nbytes) {
+      void* ptr = page_mappings::map(nbytes, ::detail::numa::page_nbytes());
+      if (ptr != nullptr) {
+        ::detail::numa::mbind(ptr, nbytes, ::detail::numa::mpol_bind, 1ul << ::detail::numa::current_node());
+      } else {
+        ptr = page_mappings::fallback_malloc(nbytes);
+      }
+      return ptr;
+    }
+    void free(void* ptr) {
+      page_mappings::unmap(ptr);
+    }
+  };
+
+  // carves arenas out of the slice of this rank in the node shared memory
+  // segment, falls back to malloc when the slice is full
+  struct host_shm_allocator {
+    void* malloc(size_t nbytes) {
+      void* ptr = ::detail::shm::segment::get().bump(nbytes, 64);
+      if (ptr == nullptr) {
+        ptr = std::malloc(nbytes);
+      }
+      return ptr;
+    }
+    void free(void* ptr) {
+      // slice memory is returned when the segment is unmapped
+      if (::detail::shm::segment::get().owner(ptr) < 0) {
+        std::free(ptr);
+      }
+    }
+  };
 
 #ifdef COMB_ENABLE_CUDA
   struct cuda_host_pinned_allocator {
@@ -133,6 +310,27 @@ using mempool = RAJA::basic_mempool::MemPool<alloc>;
 
 } // end detail
 
+// usage of an allocator since the last clear, the bytes still allocated
+// at the clear count as live and start the new peak
+struct AllocatorStats
+{
+  long live_nbytes = 0;
+  long peak_nbytes = 0;
+  long num_allocate = 0;
+  long num_deallocate = 0;
+  double allocate_time = 0.0;
+  double deallocate_time = 0.0;
+
+  void clear()
+  {
+    peak_nbytes = live_nbytes;
+    num_allocate = 0;
+    num_deallocate = 0;
+    allocate_time = 0.0;
+    deallocate_time = 0.0;
+  }
+};
+
 struct Allocator
 {
   virtual const char* name() { return "Null"; }
@@ -148,6 +346,202 @@ struct Allocator
     // FGPRINTF(FileGroup::proc, "deallocating %p\n", ptr);
     assert(ptr == nullptr);
   }
+  // pages on each numa node and then pages not present of the live
+  // allocations, empty if placement is not tracked
+  virtual std::vector<long> take_node_pages()
+  {
+    return std::vector<long>();
+  }
+  // usage since the last clear_stats, num_allocate is negative if
+  // usage is not tracked
+  virtual AllocatorStats get_stats()
+  {
+    AllocatorStats stats;
+    stats.num_allocate = -1;
+    return stats;
+  }
+  virtual void clear_stats()
+  {
+  }
+};
+
+// track the usage of the memory spaces, off by default as tracking times
+// and locks every allocation and deallocation
+inline bool& comb_memory_stats()
+{
+  static bool track = false;
+  return track;
+}
+
+// counts the live bytes, high water mark, and number and time of the
+// allocations and deallocations of the wrapped allocator when
+// comb_memory_stats is set, forwards to it otherwise
+struct InstrumentedAllocator : Allocator
+{
+  explicit InstrumentedAllocator(Allocator* aloc) : m_aloc(aloc) { }
+  const char* name() override { return m_aloc->name(); }
+  void* allocate(size_t nbytes) override
+  {
+    if (!comb_memory_stats()) {
+      return m_aloc->allocate(nbytes);
+    }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    void* ptr = m_aloc->allocate(nbytes);
+    double time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.num_allocate += 1;
+    m_stats.allocate_time += time;
+    if (ptr != nullptr) {
+      m_live[ptr] = nbytes;
+      m_stats.live_nbytes += nbytes;
+      m_stats.peak_nbytes = std::max(m_stats.peak_nbytes, m_stats.live_nbytes);
+    }
+    return ptr;
+  }
+  void deallocate(void* ptr) override
+  {
+    if (!comb_memory_stats()) {
+      m_aloc->deallocate(ptr);
+      return;
+    }
+
+    auto t0 = std::chrono::high_resolution_clock::now();
+    m_aloc->deallocate(ptr);
+    double time = std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.num_deallocate += 1;
+    m_stats.deallocate_time += time;
+    // allocations made before tracking was set are not counted
+    auto found = m_live.find(ptr);
+    if (found != m_live.end()) {
+      m_stats.live_nbytes -= found->second;
+      m_live.erase(found);
+    }
+  }
+  std::vector<long> take_node_pages() override
+  {
+    return m_aloc->take_node_pages();
+  }
+  AllocatorStats get_stats() override
+  {
+    if (!comb_memory_stats()) {
+      return Allocator::get_stats();
+    }
+    std::lock_guard<std::mutex> lock(m_mutex);
+    return m_stats;
+  }
+  void clear_stats() override
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    m_stats.clear();
+  }
+private:
+  Allocator* m_aloc = nullptr;
+  std::mutex m_mutex;
+  std::unordered_map<void*, size_t> m_live;
+  AllocatorStats m_stats;
+};
+
+// bump pointer allocator for short lived arrays that are all freed by the
+// end of a comm exchange, deallocate only counts the live allocations and
+// reset rewinds the arena once none are live, memory comes from the backing
+// allocator in blocks that reset merges into one so steady state cycles make
+// no calls to the backing allocator
+struct ArenaAllocator : Allocator
+{
+  // keeps allocations in separate cache lines
+  static constexpr size_t alignment = 64;
+  static constexpr size_t min_block_nbytes = 4096;
+
+  ArenaAllocator() = default;
+  ArenaAllocator(ArenaAllocator const&) = delete;
+  ArenaAllocator& operator=(ArenaAllocator const&) = delete;
+
+  ~ArenaAllocator()
+  {
+    assert(m_num_live == 0);
+    free_blocks();
+  }
+
+  void set_backing(Allocator& aloc)
+  {
+    assert(m_blocks.empty());
+    m_aloc = &aloc;
+  }
+  bool has_backing() const { return m_aloc != nullptr; }
+
+  const char* name() override { return "Arena"; }
+  void* allocate(size_t nbytes) override
+  {
+    assert(m_aloc != nullptr);
+    nbytes = (nbytes + alignment - 1) / alignment * alignment;
+    if (m_blocks.empty() || m_block_used + nbytes > m_blocks.back().nbytes) {
+      // grow by at least the current capacity
+      size_t block_nbytes = std::max(std::max(nbytes, size_t(min_block_nbytes)), m_capacity);
+      m_blocks.push_back(block{static_cast<char*>(m_aloc->allocate(block_nbytes)), block_nbytes});
+      m_capacity += block_nbytes;
+      m_block_used = 0;
+    }
+    void* ptr = m_blocks.back().ptr + m_block_used;
+    m_block_used += nbytes;
+    m_num_live += 1;
+    return ptr;
+  }
+  void deallocate(void* ptr) override
+  {
+    if (ptr == nullptr) return;
+    assert(m_num_live > 0);
+    m_num_live -= 1;
+  }
+
+  // rewinds the arena if nothing is live, returns true if it was reset
+  bool reset()
+  {
+    if (m_num_live != 0 || m_blocks.empty()) return false;
+    if (m_blocks.size() > 1 || m_block_used != 0) {
+      if (m_blocks.size() > 1) {
+        // replace the blocks with one that fits them all
+        size_t capacity = m_capacity;
+        free_blocks();
+        m_blocks.push_back(block{static_cast<char*>(m_aloc->allocate(capacity)), capacity});
+        m_capacity = capacity;
+      }
+      m_block_used = 0;
+      m_num_resets += 1;
+    }
+    return true;
+  }
+
+  size_t capacity() const { return m_capacity; }
+  long num_resets() const { return m_num_resets; }
+  void clear_stats() override { m_num_resets = 0; }
+
+private:
+  struct block
+  {
+    char* ptr;
+    size_t nbytes;
+  };
+
+  Allocator* m_aloc = nullptr;
+  std::vector<block> m_blocks;
+  size_t m_block_used = 0;
+  size_t m_capacity = 0;
+  long m_num_live = 0;
+  long m_num_resets = 0;
+
+  void free_blocks()
+  {
+    for (block& b : m_blocks) {
+      m_aloc->deallocate(b.ptr);
+    }
+    m_blocks.clear();
+    m_block_used = 0;
+    m_capacity = 0;
+  }
 };
 
 struct HostAllocator : Allocator
@@ -166,6 +560,150 @@ struct HostAllocator : Allocator
   }
 };
 
+struct HostPoolAllocator : Allocator
+{
+  const char* name() override { return "HostPool"; }
+  void* allocate(size_t nbytes) override
+  {
+    void* ptr = detail::thread_mempool<detail::host_allocator>::getInstance().malloc<char>(nbytes);
+    return ptr;
+  }
+  void deallocate(void* ptr) override
+  {
+    detail::thread_mempool<detail::host_allocator>::getInstance().free(ptr);
+  }
+};
+
+struct HostHugePageAllocator : Allocator
+{
+  const char* name() override { return "HostHugePage"; }
+  void* allocate(size_t nbytes) override
+  {
+    void* ptr = detail::mempool<detail::host_hugepage_allocator>::getInstance().malloc<char>(nbytes);
+    return ptr;
+  }
+  void deallocate(void* ptr) override
+  {
+    detail::mempool<detail::host_hugepage_allocator>::getInstance().free(ptr);
+  }
+};
+
+// allocations other ranks on the node can map with ::detail::shm::segment
+struct HostShmAllocator : Allocator
+{
+  const char* name() override { return "HostShm"; }
+  void* allocate(size_t nbytes) override
+  {
+    void* ptr = detail::mempool<detail::host_shm_allocator>::getInstance().malloc<char>(nbytes);
+    return ptr;
+  }
+  void deallocate(void* ptr) override
+  {
+    detail::mempool<detail::host_shm_allocator>::getInstance().free(ptr);
+  }
+};
+
+// tracks the numa nodes of the pages of its allocations
+struct NumaAllocator : Allocator
+{
+  void* allocate(size_t nbytes) override
+  {
+    void* ptr = numa_allocate(nbytes);
+    if (ptr != nullptr) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_live[ptr] = nbytes;
+    }
+    return ptr;
+  }
+  void deallocate(void* ptr) override
+  {
+    {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      m_live.erase(ptr);
+    }
+    numa_deallocate(ptr);
+  }
+  // only the allocations live when called are looked up so no syscalls are
+  // made while allocating and deallocating in the timed cycles
+  std::vector<long> take_node_pages() override
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    std::vector<long> node_pages;
+    ::detail::numa::page_nodes(nullptr, 0, node_pages);
+    for (auto const& live : m_live) {
+      ::detail::numa::page_nodes(live.first, live.second, node_pages);
+    }
+    return node_pages;
+  }
+protected:
+  virtual void* numa_allocate(size_t nbytes) = 0;
+  virtual void numa_deallocate(void* ptr) = 0;
+private:
+  std::mutex m_mutex;
+  std::unordered_map<void*, size_t> m_live;
+};
+
+struct HostNumaInterleaveAllocator : NumaAllocator
+{
+  const char* name() override { return "HostNumaInterleave"; }
+protected:
+  void* numa_allocate(size_t nbytes) override
+  {
+    void* ptr = detail::mempool<detail::host_numa_interleave_allocator>::getInstance().malloc<char>(nbytes);
+    return ptr;
+  }
+  void numa_deallocate(void* ptr) override
+  {
+    detail::mempool<detail::host_numa_interleave_allocator>::getInstance().free(ptr);
+  }
+};
+
+struct HostNumaLocalAllocator : NumaAllocator
+{
+  const char* name() override { return "HostNumaLocal"; }
+protected:
+  void* numa_allocate(size_t nbytes) override
+  {
+    void* ptr = detail::mempool<detail::host_numa_local_allocator>::getInstance().malloc<char>(nbytes);
+    return ptr;
+  }
+  void numa_deallocate(void* ptr) override
+  {
+    detail::mempool<detail::host_numa_local_allocator>::getInstance().free(ptr);
+  }
+};
+
+// maps each allocation and touches its pages with the static schedule
+// used by the openmp loops so each page is placed on the node of the
+// thread that works on it
+struct HostNumaFirstTouchAllocator : NumaAllocator
+{
+  const char* name() override { return "HostNumaFirstTouch"; }
+protected:
+  void* numa_allocate(size_t nbytes) override
+  {
+    const size_t page_nbytes = ::detail::numa::page_nbytes();
+    void* ptr = detail::page_mappings::map(nbytes, page_nbytes);
+    if (ptr != nullptr) {
+      char* bytes = static_cast<char*>(ptr);
+      long num_pages = static_cast<long>((nbytes + page_nbytes - 1) / page_nbytes);
+#ifdef COMB_ENABLE_OPENMP
+#pragma omp parallel for schedule(static)
+#endif
+      for (long p = 0; p < num_pages; ++p) {
+        bytes[p * page_nbytes] = 0;
+      }
+    } else {
+      ptr = detail::page_mappings::fallback_malloc(nbytes);
+    }
+    return ptr;
+  }
+  void numa_deallocate(void* ptr) override
+  {
+    detail::page_mappings::unmap(ptr);
+  }
+};
+
 struct HostPinnedAllocator : Allocator
 {
 #ifdef COMB_ENABLE_CUDA
@@ -293,8 +831,13 @@ struct AllocatorAccessibilityFlags
 struct AllocatorInfo
 {
   bool m_available = false;
-  AllocatorInfo(AllocatorAccessibilityFlags& a) : m_accessFlags(a) { }
-  virtual Allocator& allocator() = 0;
+  // allocations through the memory space are instrumented, aloc is only
+  // kept so it may be a member of the derived class yet to be constructed
+  AllocatorInfo(AllocatorAccessibilityFlags& a, Allocator* aloc)
+    : m_accessFlags(a)
+    , m_instrumented(aloc)
+  { }
+  virtual Allocator& allocator() { return m_instrumented; }
   virtual bool available() = 0;
   virtual bool accessible(CPUContext const&) = 0;
 #ifdef COMB_ENABLE_MPI
@@ -305,11 +848,13 @@ struct AllocatorInfo
 #endif
 protected:
   AllocatorAccessibilityFlags& m_accessFlags;
+private:
+  InstrumentedAllocator m_instrumented;
 };
 
 struct InvalidAllocatorInfo : AllocatorInfo
 {
-  InvalidAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
+  InvalidAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, nullptr) { }
   Allocator& allocator() override { throw std::invalid_argument("InvalidAllocatorInfo has no allocator"); }
   bool available() override { return false; }
   bool accessible(CPUContext const&) override { return false; }
@@ -323,8 +868,7 @@ struct InvalidAllocatorInfo : AllocatorInfo
 
 struct HostAllocatorInfo : AllocatorInfo
 {
-  HostAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
-  Allocator& allocator() override { return m_allocator; }
+  HostAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
   bool available() override { return m_available; }
   bool accessible(CPUContext const&) override { return true; }
 #ifdef COMB_ENABLE_MPI
@@ -337,12 +881,102 @@ private:
   HostAllocator m_allocator;
 };
 
+struct HostPoolAllocatorInfo : AllocatorInfo
+{
+  HostPoolAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
+  bool available() override { return m_available; }
+  bool accessible(CPUContext const&) override { return true; }
+#ifdef COMB_ENABLE_MPI
+  bool accessible(MPIContext const&) override { return true; }
+#endif
+#ifdef COMB_ENABLE_CUDA
+  bool accessible(CudaContext const&) override { return m_accessFlags.cuda_host_accessible_from_device; }
+#endif
+private:
+  HostPoolAllocator m_allocator;
+};
+
+struct HostHugePageAllocatorInfo : AllocatorInfo
+{
+  HostHugePageAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
+  bool available() override { return m_available; }
+  bool accessible(CPUContext const&) override { return true; }
+#ifdef COMB_ENABLE_MPI
+  bool accessible(MPIContext const&) override { return true; }
+#endif
+#ifdef COMB_ENABLE_CUDA
+  bool accessible(CudaContext const&) override { return m_accessFlags.cuda_host_accessible_from_device; }
+#endif
+private:
+  HostHugePageAllocator m_allocator;
+};
+
+struct HostNumaInterleaveAllocatorInfo : AllocatorInfo
+{
+  HostNumaInterleaveAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
+  bool available() override { return m_available; }
+  bool accessible(CPUContext const&) override { return true; }
+#ifdef COMB_ENABLE_MPI
+  bool accessible(MPIContext const&) override { return true; }
+#endif
+#ifdef COMB_ENABLE_CUDA
+  bool accessible(CudaContext const&) override { return m_accessFlags.cuda_host_accessible_from_device; }
+#endif
+private:
+  HostNumaInterleaveAllocator m_allocator;
+};
+
+struct HostNumaLocalAllocatorInfo : AllocatorInfo
+{
+  HostNumaLocalAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
+  bool available() override { return m_available; }
+  bool accessible(CPUContext const&) override { return true; }
+#ifdef COMB_ENABLE_MPI
+  bool accessible(MPIContext const&) override { return true; }
+#endif
+#ifdef COMB_ENABLE_CUDA
+  bool accessible(CudaContext const&) override { return m_accessFlags.cuda_host_accessible_from_device; }
+#endif
+private:
+  HostNumaLocalAllocator m_allocator;
+};
+
+struct HostNumaFirstTouchAllocatorInfo : AllocatorInfo
+{
+  HostNumaFirstTouchAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
+  bool available() override { return m_available; }
+  bool accessible(CPUContext const&) override { return true; }
+#ifdef COMB_ENABLE_MPI
+  bool accessible(MPIContext const&) override { return true; }
+#endif
+#ifdef COMB_ENABLE_CUDA
+  bool accessible(CudaContext const&) override { return m_accessFlags.cuda_host_accessible_from_device; }
+#endif
+private:
+  HostNumaFirstTouchAllocator m_allocator;
+};
+
+struct HostShmAllocatorInfo : AllocatorInfo
+{
+  HostShmAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
+  // the segment is mapped in main when the memory space is enabled
+  bool available() override { return m_available && ::detail::shm::segment::get().mapped(); }
+  bool accessible(CPUContext const&) override { return true; }
+#ifdef COMB_ENABLE_MPI
+  bool accessible(MPIContext const&) override { return true; }
+#endif
+#ifdef COMB_ENABLE_CUDA
+  bool accessible(CudaContext const&) override { return m_accessFlags.cuda_host_accessible_from_device; }
+#endif
+private:
+  HostShmAllocator m_allocator;
+};
+
 #ifdef COMB_ENABLE_CUDA
 
 struct HostPinnedAllocatorInfo : AllocatorInfo
 {
-  HostPinnedAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
-  Allocator& allocator() override { return m_allocator; }
+  HostPinnedAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
   bool available() override { return m_available; }
   bool accessible(CPUContext const&) override { return true; }
 #ifdef COMB_ENABLE_MPI
@@ -355,8 +989,7 @@ private:
 
 struct DeviceAllocatorInfo : AllocatorInfo
 {
-  DeviceAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
-  Allocator& allocator() override { return m_allocator; }
+  DeviceAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
   bool available() override { return m_available; }
   bool accessible(CPUContext const&) override { return m_accessFlags.cuda_device_accessible_from_host; }
 #ifdef COMB_ENABLE_MPI
@@ -369,8 +1002,7 @@ private:
 
 struct ManagedAllocatorInfo : AllocatorInfo
 {
-  ManagedAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
-  Allocator& allocator() override { return m_allocator; }
+  ManagedAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
   bool available() override { return m_available; }
   bool accessible(CPUContext const&) override { return true; }
 #ifdef COMB_ENABLE_MPI
@@ -383,8 +1015,7 @@ private:
 
 struct ManagedHostPreferredAllocatorInfo : AllocatorInfo
 {
-  ManagedHostPreferredAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
-  Allocator& allocator() override { return m_allocator; }
+  ManagedHostPreferredAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
   bool available() override { return m_available && detail::cuda::get_concurrent_managed_access(); }
   bool accessible(CPUContext const&) override { return true; }
 #ifdef COMB_ENABLE_MPI
@@ -397,8 +1028,7 @@ private:
 
 struct ManagedHostPreferredDeviceAccessedAllocatorInfo : AllocatorInfo
 {
-  ManagedHostPreferredDeviceAccessedAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
-  Allocator& allocator() override { return m_allocator; }
+  ManagedHostPreferredDeviceAccessedAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
   bool available() override { return m_available && detail::cuda::get_concurrent_managed_access(); }
   bool accessible(CPUContext const&) override { return true; }
 #ifdef COMB_ENABLE_MPI
@@ -411,8 +1041,7 @@ private:
 
 struct ManagedDevicePreferredAllocatorInfo : AllocatorInfo
 {
-  ManagedDevicePreferredAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
-  Allocator& allocator() override { return m_allocator; }
+  ManagedDevicePreferredAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
   bool available() override { return m_available && detail::cuda::get_concurrent_managed_access(); }
   bool accessible(CPUContext const&) override { return true; }
 #ifdef COMB_ENABLE_MPI
@@ -425,8 +1054,7 @@ private:
 
 struct ManagedDevicePreferredHostAccessedAllocatorInfo : AllocatorInfo
 {
-  ManagedDevicePreferredHostAccessedAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a) { }
-  Allocator& allocator() override { return m_allocator; }
+  ManagedDevicePreferredHostAccessedAllocatorInfo(AllocatorAccessibilityFlags& a) : AllocatorInfo(a, &m_allocator) { }
   bool available() override { return m_available && detail::cuda::get_concurrent_managed_access(); }
   bool accessible(CPUContext const&) override { return true; }
 #ifdef COMB_ENABLE_MPI
@@ -445,6 +1073,12 @@ struct Allocators
 
   InvalidAllocatorInfo                            invalid{access};
   HostAllocatorInfo                               host{access};
+  HostPoolAllocatorInfo                           host_pool{access};
+  HostHugePageAllocatorInfo                       host_hugepage{access};
+  HostNumaInterleaveAllocatorInfo                 host_numa_interleave{access};
+  HostNumaLocalAllocatorInfo                      host_numa_local{access};
+  HostNumaFirstTouchAllocatorInfo                 host_numa_first_touch{access};
+  HostShmAllocatorInfo                            host_shm{access};
 #ifdef COMB_ENABLE_CUDA
   HostPinnedAllocatorInfo                         cuda_hostpinned{access};
   DeviceAllocatorInfo                             cuda_device{access};
@@ -0,0 +1,424 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _POL_SIMD_HPP
+#define _POL_SIMD_HPP
+
+#include "config.hpp"
+
+#include "utils.hpp"
+#include "memory.hpp"
+
+namespace detail {
+
+namespace simd {
+
+// name of the instruction set chosen at runtime, avx512, avx2, or scalar
+extern const char* isa_name();
+
+// dst[i] = src[idx[i]] for i in [0, len)
+extern void gather(DataT* dst, DataT const* src, LidxT const* idx, IdxT len);
+// dst[idx[i]] = src[i] for i in [0, len)
+extern void scatter(DataT* dst, LidxT const* idx, DataT const* src, IdxT len);
+// dst[i] = src[i] for i in [0, len)
+extern void copy(DataT* dst, DataT const* src, IdxT len);
+
+// versions for pack_store streaming, buffers are written with non-temporal
+// stores so packing does not evict the mesh, the indexed mesh zones are
+// prefetched ahead of the gather and scatter
+extern void gather_stream(DataT* dst, DataT const* src, LidxT const* idx, IdxT len);
+extern void scatter_prefetch(DataT* dst, LidxT const* idx, DataT const* src, IdxT len);
+extern void copy_stream(DataT* dst, DataT const* src, IdxT len);
+// orders the non-temporal stores before later stores, used when packing finishes
+extern void store_fence();
+
+} // namespace simd
+
+} // namespace detail
+
+struct simd_component
+{
+  void* ptr = nullptr;
+};
+
+struct simd_group
+{
+  void* ptr = nullptr;
+};
+
+struct simd_pol {
+  static const bool async = false;
+  static const char* get_name() { return "simd"; }
+  using event_type = int;
+  using component_type = simd_component;
+  using group_type = simd_group;
+};
+
+// sequential execution that packs and unpacks with explicit
+// vector gather, scatter, and copy kernels
+template < >
+struct ExecContext<simd_pol> : CPUContext
+{
+  using pol = simd_pol;
+  using event_type = typename pol::event_type;
+  using component_type = typename pol::component_type;
+  using group_type = typename pol::group_type;
+
+  using base = CPUContext;
+
+  COMB::Allocator& util_aloc;
+
+
+  ExecContext(base const& b, COMB::Allocator& util_aloc_)
+    : base(b)
+    , util_aloc(util_aloc_)
+  { }
+
+  void ensure_waitable()
+  {
+
+  }
+
+  template < typename context >
+  void waitOn(context& con)
+  {
+    con.ensure_waitable();
+    base::waitOn(con);
+  }
+
+  // synchronization functions
+  void synchronize()
+  {
+    if (stream_stores()) detail::simd::store_fence();
+  }
+
+  group_type create_group()
+  {
+    return group_type{};
+  }
+
+  void start_group(group_type)
+  {
+  }
+
+  void finish_group(group_type)
+  {
+    if (stream_stores()) detail::simd::store_fence();
+  }
+
+  void destroy_group(group_type)
+  {
+
+  }
+
+  component_type create_component()
+  {
+    return component_type{};
+  }
+
+  void start_component(group_type, component_type)
+  {
+
+  }
+
+  void finish_component(group_type, component_type)
+  {
+
+  }
+
+  void destroy_component(component_type)
+  {
+
+  }
+
+  // event creation functions
+  event_type createEvent()
+  {
+    return event_type{};
+  }
+
+  // event record functions
+  void recordEvent(event_type)
+  {
+  }
+
+  void finish_component_recordEvent(group_type group, component_type component, event_type event)
+  {
+    finish_component(group, component);
+    recordEvent(event);
+  }
+
+  // event query functions
+  bool queryEvent(event_type)
+  {
+    return true;
+  }
+
+  // event wait functions
+  void waitEvent(event_type)
+  {
+  }
+
+  // event destroy functions
+  void destroyEvent(event_type)
+  {
+  }
+
+  // for_all functions
+  template < typename body_type >
+  void for_all(IdxT begin, IdxT end, body_type&& body)
+  {
+    for_all_impl(begin, end, body);
+    // base::synchronize();
+  }
+
+  template < typename body_type >
+  void for_all_2d(IdxT begin0, IdxT end0, IdxT begin1, IdxT end1, body_type&& body)
+  {
+    IdxT i = 0;
+    for(IdxT i0 = begin0; i0 < end0; ++i0) {
+      for(IdxT i1 = begin1; i1 < end1; ++i1) {
+        body(i0, i1, i++);
+      }
+    }
+    // base::synchronize();
+  }
+
+  template < typename body_type >
+  void for_all_3d(IdxT begin0, IdxT end0, IdxT begin1, IdxT end1, IdxT begin2, IdxT end2, body_type&& body)
+  {
+    IdxT i = 0;
+    for(IdxT i0 = begin0; i0 < end0; ++i0) {
+      for(IdxT i1 = begin1; i1 < end1; ++i1) {
+        for(IdxT i2 = begin2; i2 < end2; ++i2) {
+          body(i0, i1, i2, i++);
+        }
+      }
+    }
+    // base::synchronize();
+  }
+
+  template < typename body_type >
+  void fused(IdxT len_outer, IdxT len_inner, IdxT len_hint, body_type&& body_in)
+  {
+    COMB::ignore_unused(len_hint);
+    for (IdxT i_outer = 0; i_outer < len_outer; ++i_outer) {
+      auto body = body_in;
+      body.set_outer(i_outer);
+      for (IdxT i_inner = 0; i_inner < len_inner; ++i_inner) {
+        body.set_inner(i_inner);
+        fused_impl(body);
+      }
+    }
+    // base::synchronize();
+  }
+
+private:
+  using list_packer_type   = detail::copy_idxr_idxr<DataT const, detail::indexer_list_idx, DataT, detail::indexer_idx>;
+  using list_unpacker_type = detail::copy_idxr_idxr<DataT const, detail::indexer_idx, DataT, detail::indexer_list_idx>;
+
+  template < typename body_type >
+  void for_all_impl(IdxT begin, IdxT end, body_type& body)
+  {
+    IdxT i = 0;
+    for(IdxT i0 = begin; i0 < end; ++i0) {
+      body(i0, i++);
+    }
+  }
+
+  void for_all_impl(IdxT begin, IdxT end, list_packer_type& body)
+  {
+    pack_gather(body.ptr_dst, body.ptr_src, body.idxr_src.indices, end - begin);
+  }
+
+  void for_all_impl(IdxT begin, IdxT end, list_unpacker_type& body)
+  {
+    unpack_scatter(body.ptr_dst, body.idxr_dst.indices, body.ptr_src, end - begin);
+  }
+
+  void for_all_impl(IdxT begin, IdxT end, detail::box_packer<DataT>& body)
+  {
+    for (IdxT r = begin; r < end; ++r) {
+      pack_box_row(body.src, body.box, body.buf, r);
+    }
+  }
+
+  void for_all_impl(IdxT begin, IdxT end, detail::box_unpacker<DataT>& body)
+  {
+    for (IdxT r = begin; r < end; ++r) {
+      unpack_box_row(body.dst, body.box, body.buf, r);
+    }
+  }
+
+  void for_all_impl(IdxT begin, IdxT end, detail::runs_packer<DataT>& body)
+  {
+    for (IdxT r = begin; r < end; ++r) {
+      pack_run(body.src, body.runs, body.buf, r);
+    }
+  }
+
+  void for_all_impl(IdxT begin, IdxT end, detail::runs_unpacker<DataT>& body)
+  {
+    for (IdxT r = begin; r < end; ++r) {
+      unpack_run(body.dst, body.runs, body.buf, r);
+    }
+  }
+
+  // called after set_outer and set_inner
+  template < typename body_type >
+  void fused_impl(body_type& body)
+  {
+    for (IdxT i = 0; i < body.len; ++i) {
+      body(i, i);
+    }
+  }
+
+  void fused_impl(detail::fused_packer<DataT>& body)
+  {
+    pack_gather(body.buf, body.src, body.idx, body.len);
+  }
+
+  void fused_impl(detail::fused_unpacker<DataT>& body)
+  {
+    unpack_scatter(body.dst, body.idx, body.buf, body.len);
+  }
+
+  // interleaved buffers are not contiguous per variable so use the zone loop
+  template < IdxT num_vars, bool whole_items >
+  void fused_impl(detail::fused_packer_vars<DataT, num_vars, whole_items>& body)
+  {
+    if (body.interleaved) {
+      for (IdxT i = 0; i < body.len; ++i) {
+        body(i, i);
+      }
+      return;
+    }
+    for (IdxT j = 0; j < num_vars; ++j) {
+      pack_gather(body.buf + j*body.item_len, body.srcs[j], body.idx, body.item_len);
+    }
+  }
+
+  template < IdxT num_vars, bool whole_items >
+  void fused_impl(detail::fused_unpacker_vars<DataT, num_vars, whole_items>& body)
+  {
+    if (body.interleaved) {
+      for (IdxT i = 0; i < body.len; ++i) {
+        body(i, i);
+      }
+      return;
+    }
+    for (IdxT j = 0; j < num_vars; ++j) {
+      unpack_scatter(body.dsts[j], body.idx, body.buf + j*body.item_len, body.item_len);
+    }
+  }
+
+  void fused_impl(detail::fused_box_packer<DataT>& body)
+  {
+    for (IdxT r = 0; r < body.len; ++r) {
+      pack_box_row(body.src, body.box, body.buf, r);
+    }
+  }
+
+  void fused_impl(detail::fused_box_unpacker<DataT>& body)
+  {
+    for (IdxT r = 0; r < body.len; ++r) {
+      unpack_box_row(body.dst, body.box, body.buf, r);
+    }
+  }
+
+  void fused_impl(detail::fused_runs_packer<DataT>& body)
+  {
+    for (IdxT r = 0; r < body.len; ++r) {
+      pack_run(body.src, body.runs, body.buf, r);
+    }
+  }
+
+  void fused_impl(detail::fused_runs_unpacker<DataT>& body)
+  {
+    for (IdxT r = 0; r < body.len; ++r) {
+      unpack_run(body.dst, body.runs, body.buf, r);
+    }
+  }
+
+  // only packing streams, unpacked zones are used again soon
+  static bool stream_stores()
+  {
+    return comb_pack_store() == PackStore::streaming;
+  }
+
+  static void pack_gather(DataT* buf, DataT const* src, LidxT const* idx, IdxT len)
+  {
+    if (stream_stores()) {
+      detail::simd::gather_stream(buf, src, idx, len);
+    } else {
+      detail::simd::gather(buf, src, idx, len);
+    }
+  }
+
+  static void unpack_scatter(DataT* dst, LidxT const* idx, DataT const* buf, IdxT len)
+  {
+    if (stream_stores()) {
+      detail::simd::scatter_prefetch(dst, idx, buf, len);
+    } else {
+      detail::simd::scatter(dst, idx, buf, len);
+    }
+  }
+
+  // short runs are copied inline as a call to a vector kernel costs more than it saves
+  static void copy_run(DataT* dst, DataT const* src, IdxT len, bool stream = false)
+  {
+    if (len < 8) {
+      for (IdxT i = 0; i < len; ++i) {
+        dst[i] = src[i];
+      }
+    } else if (stream) {
+      detail::simd::copy_stream(dst, src, len);
+    } else {
+      detail::simd::copy(dst, src, len);
+    }
+  }
+
+  static void pack_box_row(DataT const* src, detail::box_runs const& box, DataT* buf, IdxT r)
+  {
+    DataT const* row_src = src + box.offset + r * box.row_stride;
+    DataT* row_buf = buf + r * box.row_buf_stride;
+    for (IdxT q = 0; q < box.row_runs; ++q) {
+      copy_run(row_buf + q * box.run_buf_stride, row_src + q * box.run_stride, box.run_len, stream_stores());
+    }
+  }
+
+  static void unpack_box_row(DataT* dst, detail::box_runs const& box, DataT const* buf, IdxT r)
+  {
+    DataT* row_dst = dst + box.offset + r * box.row_stride;
+    DataT const* row_buf = buf + r * box.row_buf_stride;
+    for (IdxT q = 0; q < box.row_runs; ++q) {
+      copy_run(row_dst + q * box.run_stride, row_buf + q * box.run_buf_stride, box.run_len);
+    }
+  }
+
+  static void pack_run(DataT const* src, detail::index_runs const& runs, DataT* buf, IdxT r)
+  {
+    IdxT run_begin = runs.offsets[r];
+    copy_run(buf + run_begin, src + runs.starts[r], runs.offsets[r+1] - run_begin, stream_stores());
+  }
+
+  static void unpack_run(DataT* dst, detail::index_runs const& runs, DataT const* buf, IdxT r)
+  {
+    IdxT run_begin = runs.offsets[r];
+    copy_run(dst + runs.starts[r], buf + run_begin, runs.offsets[r+1] - run_begin);
+  }
+};
+
+#endif // _POL_SIMD_HPP
@@ -44,7 +44,6 @@ extern void comb_setup_files();
 extern void comb_teardown_files();
 
 extern void fgprintf(FileGroup fg, const char* fmt, ...);
-extern void print_proc_memory_stats();
 
 #ifdef __CUDA_ARCH__
 #define FFLUSH(f) static_cast<void>(0)
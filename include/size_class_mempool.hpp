@@ -0,0 +1,232 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _SIZE_CLASS_MEMPOOL_HPP
+#define _SIZE_CLASS_MEMPOOL_HPP
+
+#include "align.hpp"
+#include "mutex.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <algorithm>
+#include <unordered_map>
+#include <vector>
+
+namespace COMB {
+
+namespace size_class_mempool {
+
+// Memory pool with the malloc/free interface of RAJA::basic_mempool::MemPool
+// that keeps a free list per size class instead of first-fit searching
+// free chunks. Blocks are carved off the end of the current arena and keep
+// their size class for the life of the pool, freed blocks go on the free
+// list of their class and are reused last in first out, so the same sizes
+// allocated every cycle get the same blocks back in constant time.
+// Block bookkeeping is kept on the host so arenas may be device memory.
+template <typename allocator_t>
+class MemPool
+{
+public:
+  using allocator_type = allocator_t;
+
+  static inline MemPool<allocator_t>& getInstance()
+  {
+    static MemPool<allocator_t> pool{};
+    return pool;
+  }
+
+  static const size_t default_default_arena_size = 32ull * 1024ull * 1024ull;
+
+  // blocks are multiples of and aligned to block_alignment
+  static const size_t block_alignment = 64;
+
+  // sizes up to small_max_nbytes have a class per block_alignment bytes,
+  // larger sizes have four classes per power of two
+  static const size_t small_max_log2 = 10;
+  static const size_t small_max_nbytes = size_t(1) << small_max_log2;
+  static const size_t num_small_classes = small_max_nbytes / block_alignment;
+  static const size_t num_classes = num_small_classes + 4 * (8 * sizeof(size_t) - small_max_log2);
+
+  MemPool()
+      : m_arenas(), m_free_lists(num_classes), m_block_classes(),
+        m_bump_ptr(nullptr), m_bump_space(0),
+        m_default_arena_size(default_default_arena_size), m_alloc()
+  {
+  }
+
+  ~MemPool()
+  {
+    // With static objects like MemPool, cudaErrorCudartUnloading is a possible
+    // error with cudaFree
+    // So no more cuda calls here
+  }
+
+  MemPool(MemPool const&) = delete;
+  MemPool& operator=(MemPool const&) = delete;
+
+  static size_t size_class(size_t nbytes)
+  {
+    if (nbytes <= small_max_nbytes) {
+      return (std::max(nbytes, size_t(1)) + block_alignment - 1) / block_alignment - 1;
+    }
+    size_t pow2 = floor_log2(nbytes - 1);
+    size_t quarter = ((nbytes - 1) >> (pow2 - 2)) & 3;
+    return num_small_classes + 4 * (pow2 - small_max_log2) + quarter;
+  }
+
+  static size_t class_nbytes(size_t cls)
+  {
+    if (cls < num_small_classes) {
+      return (cls + 1) * block_alignment;
+    }
+    size_t pow2 = small_max_log2 + (cls - num_small_classes) / 4;
+    size_t quarter = (cls - num_small_classes) % 4;
+    return (size_t(1) << pow2) + (quarter + 1) * (size_t(1) << (pow2 - 2));
+  }
+
+  void free_chunks()
+  {
+#if defined(RAJA_ENABLE_OPENMP)
+    RAJA::lock_guard<RAJA::omp::mutex> lock(m_mutex);
+#endif
+
+    for (void* arena : m_arenas) {
+      m_alloc.free(arena);
+    }
+    m_arenas.clear();
+    for (std::vector<void*>& free_list : m_free_lists) {
+      free_list.clear();
+    }
+    m_block_classes.clear();
+    m_bump_ptr = nullptr;
+    m_bump_space = 0;
+  }
+
+  size_t arena_size()
+  {
+#if defined(RAJA_ENABLE_OPENMP)
+    RAJA::lock_guard<RAJA::omp::mutex> lock(m_mutex);
+#endif
+
+    return m_default_arena_size;
+  }
+
+  size_t arena_size(size_t new_size)
+  {
+#if defined(RAJA_ENABLE_OPENMP)
+    RAJA::lock_guard<RAJA::omp::mutex> lock(m_mutex);
+#endif
+
+    size_t prev_size = m_default_arena_size;
+    m_default_arena_size = new_size;
+    return prev_size;
+  }
+
+  template <typename T>
+  T* malloc(size_t nTs, size_t alignment = std::max(alignof(T), alignof(std::max_align_t)))
+  {
+#if defined(RAJA_ENABLE_OPENMP)
+    RAJA::lock_guard<RAJA::omp::mutex> lock(m_mutex);
+#endif
+
+    assert(alignment <= block_alignment);
+    static_cast<void>(alignment);
+
+    const size_t cls = size_class(nTs * sizeof(T));
+    std::vector<void*>& free_list = m_free_lists[cls];
+
+    void* ptr = nullptr;
+    if (!free_list.empty()) {
+      ptr = free_list.back();
+      free_list.pop_back();
+    } else {
+      ptr = bump(class_nbytes(cls));
+      if (ptr != nullptr) {
+        m_block_classes.emplace(ptr, cls);
+      }
+    }
+
+    return static_cast<T*>(ptr);
+  }
+
+  void free(const void* cptr)
+  {
+#if defined(RAJA_ENABLE_OPENMP)
+    RAJA::lock_guard<RAJA::omp::mutex> lock(m_mutex);
+#endif
+
+    void* ptr = const_cast<void*>(cptr);
+    auto found = m_block_classes.find(ptr);
+    if (found != m_block_classes.end()) {
+      m_free_lists[found->second].push_back(ptr);
+    } else {
+      fprintf(stderr, "Unknown pointer %p", ptr);
+    }
+  }
+
+private:
+  static size_t floor_log2(size_t n)
+  {
+#if defined(__GNUC__)
+    return 8 * sizeof(unsigned long long) - 1 - __builtin_clzll(n);
+#else
+    size_t log2 = 0;
+    while (n >>= 1) ++log2;
+    return log2;
+#endif
+  }
+
+  // carves nbytes off the current arena, starting a new arena when it
+  // does not fit, the rest of the old arena is left unused
+  void* bump(size_t nbytes)
+  {
+    void* ptr = m_bump_ptr;
+    if (ptr == nullptr || !::RAJA::align(block_alignment, nbytes, ptr, m_bump_space)) {
+      const size_t alloc_size = std::max(nbytes + block_alignment, m_default_arena_size);
+      void* arena_ptr = m_alloc.malloc(alloc_size);
+      if (arena_ptr == nullptr) {
+        return nullptr;
+      }
+      m_arenas.emplace_back(arena_ptr);
+      ptr = arena_ptr;
+      m_bump_space = alloc_size;
+      ::RAJA::align(block_alignment, nbytes, ptr, m_bump_space);
+    }
+    m_bump_ptr = static_cast<char*>(ptr) + nbytes;
+    m_bump_space -= nbytes;
+    return ptr;
+  }
+
+#if defined(RAJA_ENABLE_OPENMP)
+  RAJA::omp::mutex m_mutex;
+#endif
+
+  std::vector<void*> m_arenas;
+  std::vector<std::vector<void*>> m_free_lists;
+  std::unordered_map<void*, size_t> m_block_classes;
+  void* m_bump_ptr;
+  size_t m_bump_space;
+  size_t m_default_arena_size;
+  allocator_t m_alloc;
+};
+
+} // namespace size_class_mempool
+
+} // namespace COMB
+
+#endif // _SIZE_CLASS_MEMPOOL_HPP
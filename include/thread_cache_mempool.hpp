@@ -0,0 +1,403 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _THREAD_CACHE_MEMPOOL_HPP
+#define _THREAD_CACHE_MEMPOOL_HPP
+
+#include "align.hpp"
+#include "size_class_mempool.hpp"
+
+#include <cassert>
+#include <cstddef>
+#include <cstdint>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <mutex>
+#include <utility>
+#include <vector>
+
+namespace COMB {
+
+namespace thread_cache_mempool {
+
+// Memory pool with the malloc/free interface of RAJA::basic_mempool::MemPool
+// that may be used by many threads at once. Blocks use the size classes of
+// size_class_mempool and are handed out from magazines of up to
+// magazine_size blocks. Each thread allocates from and frees to the
+// magazines in its own cache without synchronization and swaps empty and
+// full magazines with a lock free depot per size class when they run out.
+// Only carving new blocks off an arena and creating magazines take a lock.
+// Each block starts with a header holding its size class so arenas must be
+// host memory.
+template <typename allocator_t>
+class MemPool
+{
+public:
+  using allocator_type = allocator_t;
+
+  static inline MemPool<allocator_t>& getInstance()
+  {
+    static MemPool<allocator_t> pool{};
+    return pool;
+  }
+
+  static const size_t default_default_arena_size = 32ull * 1024ull * 1024ull;
+
+  // blocks are multiples of and aligned to block_alignment,
+  // the header takes the first block_alignment bytes of each block
+  static const size_t block_alignment = size_class_mempool::MemPool<allocator_t>::block_alignment;
+  static const size_t num_classes = size_class_mempool::MemPool<allocator_t>::num_classes;
+
+  static const size_t magazine_size = 32;
+  // blocks carved off the arena at once are limited to refill_nbytes
+  static const size_t refill_nbytes = 1024ull * 1024ull;
+
+  // threads after the first max_threads share one cache under a lock
+  static const size_t max_threads = 256;
+
+  MemPool()
+      : m_arenas(), m_bump_ptr(nullptr), m_bump_space(0),
+        m_default_arena_size(default_default_arena_size), m_alloc(),
+        m_depots(new depot[num_classes]), m_num_magazines(0)
+  {
+    for (std::atomic<magazine*>& chunk : m_magazine_chunks) {
+      chunk.store(nullptr, std::memory_order_relaxed);
+    }
+  }
+
+  ~MemPool()
+  {
+    // With static objects like MemPool, cudaErrorCudartUnloading is a possible
+    // error with cudaFree
+    // So no more cuda calls here
+    for (std::atomic<magazine*>& chunk : m_magazine_chunks) {
+      delete[] chunk.load(std::memory_order_relaxed);
+    }
+  }
+
+  MemPool(MemPool const&) = delete;
+  MemPool& operator=(MemPool const&) = delete;
+
+  // must not be called while other threads use the pool
+  void free_chunks()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    for (void* arena : m_arenas) {
+      m_alloc.free(arena);
+    }
+    m_arenas.clear();
+    m_bump_ptr = nullptr;
+    m_bump_space = 0;
+
+    for (std::unique_ptr<thread_cache>& cache : m_caches) {
+      cache.reset();
+    }
+    for (size_t cls = 0; cls < num_classes; ++cls) {
+      m_depots[cls].full.store(null_head, std::memory_order_relaxed);
+      m_depots[cls].empty.store(null_head, std::memory_order_relaxed);
+    }
+    for (std::atomic<magazine*>& chunk : m_magazine_chunks) {
+      delete[] chunk.load(std::memory_order_relaxed);
+      chunk.store(nullptr, std::memory_order_relaxed);
+    }
+    m_num_magazines = 0;
+  }
+
+  size_t arena_size()
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    return m_default_arena_size;
+  }
+
+  size_t arena_size(size_t new_size)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    size_t prev_size = m_default_arena_size;
+    m_default_arena_size = new_size;
+    return prev_size;
+  }
+
+  template <typename T>
+  T* malloc(size_t nTs, size_t alignment = std::max(alignof(T), alignof(std::max_align_t)))
+  {
+    assert(alignment <= block_alignment);
+    static_cast<void>(alignment);
+
+    const size_t cls = size_class_mempool::MemPool<allocator_t>::size_class(nTs * sizeof(T) + block_alignment);
+
+    void* block = nullptr;
+    const size_t tid = thread_index();
+    if (tid < max_threads) {
+      block = cache_malloc(get_cache(tid), cls);
+    } else {
+      std::lock_guard<std::mutex> lock(m_shared_cache_mutex);
+      block = cache_malloc(get_cache(max_threads), cls);
+    }
+
+    return (block != nullptr) ? reinterpret_cast<T*>(static_cast<char*>(block) + block_alignment)
+                              : nullptr;
+  }
+
+  void free(const void* cptr)
+  {
+    if (cptr == nullptr) return;
+
+    void* block = static_cast<char*>(const_cast<void*>(cptr)) - block_alignment;
+    const size_t cls = *static_cast<size_t*>(block);
+    assert(cls < num_classes);
+
+    const size_t tid = thread_index();
+    if (tid < max_threads) {
+      cache_free(get_cache(tid), cls, block);
+    } else {
+      std::lock_guard<std::mutex> lock(m_shared_cache_mutex);
+      cache_free(get_cache(max_threads), cls, block);
+    }
+  }
+
+private:
+  static const uint32_t null_idx = UINT32_MAX;
+  // depot stack heads hold a magazine index in the low 32 bits
+  // and a tag in the high 32 bits that changes on every update
+  static const uint64_t null_head = null_idx;
+
+  static const size_t magazine_chunk_size = 1024;
+  static const size_t max_magazine_chunks = 4096;
+
+  struct magazine
+  {
+    void* blocks[magazine_size];
+    size_t count = 0;
+    std::atomic<uint32_t> next{null_idx};
+  };
+
+  struct depot
+  {
+    std::atomic<uint64_t> full{null_head};
+    std::atomic<uint64_t> empty{null_head};
+  };
+
+  struct thread_cache
+  {
+    uint32_t loaded[num_classes];
+    uint32_t previous[num_classes];
+
+    thread_cache()
+    {
+      for (size_t cls = 0; cls < num_classes; ++cls) {
+        loaded[cls]   = null_idx;
+        previous[cls] = null_idx;
+      }
+    }
+  };
+
+  // threads are numbered in the order they first use a pool of this type
+  static size_t thread_index()
+  {
+    static std::atomic<size_t> num_threads{0};
+    static thread_local size_t index = num_threads.fetch_add(1, std::memory_order_relaxed);
+    return index;
+  }
+
+  thread_cache& get_cache(size_t tid)
+  {
+    std::unique_ptr<thread_cache>& cache = m_caches[tid];
+    if (!cache) {
+      cache.reset(new thread_cache{});
+    }
+    return *cache;
+  }
+
+  magazine& get_magazine(uint32_t idx)
+  {
+    magazine* chunk = m_magazine_chunks[idx / magazine_chunk_size].load(std::memory_order_acquire);
+    return chunk[idx % magazine_chunk_size];
+  }
+
+  static uint64_t make_head(uint64_t old_head, uint32_t idx)
+  {
+    return (((old_head >> 32) + 1) << 32) | idx;
+  }
+
+  uint32_t pop(std::atomic<uint64_t>& head)
+  {
+    uint64_t old_head = head.load(std::memory_order_acquire);
+    for (;;) {
+      uint32_t idx = static_cast<uint32_t>(old_head);
+      if (idx == null_idx) return null_idx;
+      // next may be stale if idx was popped meanwhile, the tag fails the exchange then
+      uint32_t next = get_magazine(idx).next.load(std::memory_order_relaxed);
+      if (head.compare_exchange_weak(old_head, make_head(old_head, next),
+                                     std::memory_order_acquire, std::memory_order_acquire)) {
+        return idx;
+      }
+    }
+  }
+
+  void push(std::atomic<uint64_t>& head, uint32_t idx)
+  {
+    magazine& mag = get_magazine(idx);
+    uint64_t old_head = head.load(std::memory_order_relaxed);
+    do {
+      mag.next.store(static_cast<uint32_t>(old_head), std::memory_order_relaxed);
+    } while (!head.compare_exchange_weak(old_head, make_head(old_head, idx),
+                                         std::memory_order_release, std::memory_order_relaxed));
+  }
+
+  // call with m_mutex held
+  uint32_t new_magazine()
+  {
+    size_t idx = m_num_magazines;
+    size_t chunk = idx / magazine_chunk_size;
+    if (chunk >= max_magazine_chunks) {
+      return null_idx;
+    }
+    if (m_magazine_chunks[chunk].load(std::memory_order_relaxed) == nullptr) {
+      m_magazine_chunks[chunk].store(new magazine[magazine_chunk_size], std::memory_order_release);
+    }
+    m_num_magazines += 1;
+    return static_cast<uint32_t>(idx);
+  }
+
+  // carves nbytes off the current arena, starting a new arena when it
+  // does not fit, the rest of the old arena is left unused,
+  // call with m_mutex held
+  void* bump(size_t nbytes)
+  {
+    void* ptr = m_bump_ptr;
+    if (ptr == nullptr || !::RAJA::align(block_alignment, nbytes, ptr, m_bump_space)) {
+      const size_t alloc_size = std::max(nbytes + block_alignment, m_default_arena_size);
+      void* arena_ptr = m_alloc.malloc(alloc_size);
+      if (arena_ptr == nullptr) {
+        return nullptr;
+      }
+      m_arenas.emplace_back(arena_ptr);
+      ptr = arena_ptr;
+      m_bump_space = alloc_size;
+      ::RAJA::align(block_alignment, nbytes, ptr, m_bump_space);
+    }
+    m_bump_ptr = static_cast<char*>(ptr) + nbytes;
+    m_bump_space -= nbytes;
+    return ptr;
+  }
+
+  // returns a magazine of new blocks of size class cls
+  uint32_t refill(size_t cls)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+
+    uint32_t idx = new_magazine();
+    if (idx == null_idx) return null_idx;
+    magazine& mag = get_magazine(idx);
+
+    const size_t nbytes = size_class_mempool::MemPool<allocator_t>::class_nbytes(cls);
+    const size_t num_blocks = std::max(size_t(1), std::min(size_t(magazine_size), refill_nbytes / nbytes));
+    while (mag.count < num_blocks) {
+      void* block = bump(nbytes);
+      if (block == nullptr) break;
+      *static_cast<size_t*>(block) = cls;
+      mag.blocks[mag.count++] = block;
+    }
+    if (mag.count == 0) {
+      push(m_depots[cls].empty, idx);
+      return null_idx;
+    }
+    return idx;
+  }
+
+  uint32_t get_empty_magazine(size_t cls)
+  {
+    uint32_t idx = pop(m_depots[cls].empty);
+    if (idx == null_idx) {
+      std::lock_guard<std::mutex> lock(m_mutex);
+      idx = new_magazine();
+    }
+    return idx;
+  }
+
+  void* cache_malloc(thread_cache& cache, size_t cls)
+  {
+    uint32_t& loaded   = cache.loaded[cls];
+    uint32_t& previous = cache.previous[cls];
+    if (loaded == null_idx || get_magazine(loaded).count == 0) {
+      if (previous != null_idx && get_magazine(previous).count > 0) {
+        std::swap(loaded, previous);
+      } else {
+        uint32_t full = pop(m_depots[cls].full);
+        if (full == null_idx) {
+          full = refill(cls);
+          if (full == null_idx) return nullptr;
+        }
+        // previous is empty here
+        if (previous != null_idx) {
+          push(m_depots[cls].empty, previous);
+        }
+        previous = loaded;
+        loaded = full;
+      }
+    }
+    magazine& mag = get_magazine(loaded);
+    return mag.blocks[--mag.count];
+  }
+
+  void cache_free(thread_cache& cache, size_t cls, void* block)
+  {
+    uint32_t& loaded   = cache.loaded[cls];
+    uint32_t& previous = cache.previous[cls];
+    if (loaded == null_idx || get_magazine(loaded).count == magazine_size) {
+      if (previous != null_idx && get_magazine(previous).count < magazine_size) {
+        std::swap(loaded, previous);
+      } else {
+        uint32_t empty = get_empty_magazine(cls);
+        if (empty == null_idx) {
+          // out of magazines, the block is not reused
+          return;
+        }
+        // previous is full here
+        if (previous != null_idx) {
+          push(m_depots[cls].full, previous);
+        }
+        previous = loaded;
+        loaded = empty;
+      }
+    }
+    magazine& mag = get_magazine(loaded);
+    mag.blocks[mag.count++] = block;
+  }
+
+  std::mutex m_mutex;
+  std::mutex m_shared_cache_mutex;
+
+  std::vector<void*> m_arenas;
+  void* m_bump_ptr;
+  size_t m_bump_space;
+  size_t m_default_arena_size;
+  allocator_t m_alloc;
+
+  std::unique_ptr<depot[]> m_depots;
+  std::unique_ptr<thread_cache> m_caches[max_threads + 1];
+  std::atomic<magazine*> m_magazine_chunks[max_magazine_chunks];
+  size_t m_num_magazines;
+};
+
+} // namespace thread_cache_mempool
+
+} // namespace COMB
+
+#endif // _THREAD_CACHE_MEMPOOL_HPP
@@ -22,11 +22,89 @@
 
 #include <cassert>
 #include <cstdio>
+#include <cstdint>
+#include <cstring>
+#include <utility>
 
 using IdxT = int;
 using LidxT = int;
 using DataT = double;
 
+// element types of mesh variables
+enum struct ElemType
+{
+  f64 // double
+ ,f32 // float
+ ,i32 // int
+};
+
+inline const char* elem_type_str(ElemType type)
+{
+  const char* str = "unknown";
+  switch (type) {
+    case ElemType::f64: str = "double"; break;
+    case ElemType::f32: str = "float";  break;
+    case ElemType::i32: str = "int";    break;
+  }
+  return str;
+}
+
+inline IdxT elem_type_size(ElemType type)
+{
+  IdxT size = 0;
+  switch (type) {
+    case ElemType::f64: size = sizeof(double); break;
+    case ElemType::f32: size = sizeof(float);  break;
+    case ElemType::i32: size = sizeof(int);    break;
+  }
+  return size;
+}
+
+// message item buffers are padded so each item starts aligned for any element type
+inline IdxT item_nbytes(IdxT size, IdxT zone_nbytes)
+{
+  const IdxT align = sizeof(double);
+  return (size * zone_nbytes + align - 1) / align * align;
+}
+
+// pointer to the data of a variable of any element type,
+// values are converted to and from DataT
+struct ElemPtr
+{
+  void* ptr;
+  ElemType type;
+
+  ElemPtr(DataT* ptr_) : ptr(ptr_), type(ElemType::f64) {}
+  ElemPtr(void* ptr_, ElemType type_) : ptr(ptr_), type(type_) {}
+
+  COMB_HOST COMB_DEVICE DataT load(IdxT i) const
+  {
+    switch (type) {
+      case ElemType::f32: return static_cast<DataT>(static_cast<float const*>(ptr)[i]);
+      case ElemType::i32: return static_cast<DataT>(static_cast<int const*>(ptr)[i]);
+      default:            return static_cast<DataT const*>(ptr)[i];
+    }
+  }
+
+  COMB_HOST COMB_DEVICE void store(IdxT i, DataT val) const
+  {
+    switch (type) {
+      case ElemType::f32: static_cast<float*>(ptr)[i] = static_cast<float>(val); break;
+      case ElemType::i32: static_cast<int*>(ptr)[i]   = static_cast<int>(val);   break;
+      default:            static_cast<DataT*>(ptr)[i] = val;                     break;
+    }
+  }
+};
+
+// true if found is within a relative tolerance of expected
+COMB_HOST COMB_DEVICE
+inline bool values_match(DataT found, DataT expected, DataT tol)
+{
+  DataT diff = (found < expected) ? expected - found : found - expected;
+  DataT mag  = (expected < 0) ? -expected : expected;
+  return diff <= tol * mag;
+}
+
 
 namespace detail {
 
@@ -109,6 +187,12 @@ struct indexer_idx {
   COMB_HOST COMB_DEVICE IdxT operator()(IdxT, IdxT, IdxT, IdxT idx) const { return idx; }
 };
 
+struct indexer_stride_idx {
+  IdxT stride;
+  indexer_stride_idx(IdxT stride_) : stride(stride_) {}
+  COMB_HOST COMB_DEVICE IdxT operator()(IdxT, IdxT idx) const { return idx * stride; }
+};
+
 struct indexer_list_idx {
   LidxT const* indices;
   indexer_list_idx(LidxT const* indices_) : indices(indices_) {}
@@ -165,24 +249,62 @@ set_idxr_idxr<I_src, T_dst, I_dst> make_set_idxr_idxr(I_src const& idxr_src, T_d
   return set_idxr_idxr<I_src, T_dst, I_dst>(idxr_src, ptr_dst, idxr_dst);
 }
 
+// bfloat16 buffer element, the upper half of a float rounded to nearest even
+struct bf16
+{
+  uint16_t bits;
+
+  bf16() = default;
+
+  COMB_HOST COMB_DEVICE
+  bf16(DataT val)
+  {
+    float f = static_cast<float>(val);
+    uint32_t u;
+    memcpy(&u, &f, sizeof(u));
+    if ((u & 0x7fffffffu) > 0x7f800000u) {
+      bits = static_cast<uint16_t>((u >> 16) | 0x0040u); // quiet nan
+    } else {
+      bits = static_cast<uint16_t>((u + 0x7fffu + ((u >> 16) & 1u)) >> 16);
+    }
+  }
+
+  COMB_HOST COMB_DEVICE
+  operator DataT() const
+  {
+    uint32_t u = static_cast<uint32_t>(bits) << 16;
+    float f;
+    memcpy(&f, &u, sizeof(f));
+    return f;
+  }
+};
+
+// the fused kernels pack the variables of one element type T into buffer
+// elements of type B, the section of each item's buffer for these variables
+// starts zone_offset bytes per zone into the item's buffer
+
+template < typename T, typename B = T >
 struct fused_packer
 {
-  DataT const** srcs;
-  DataT**       bufs;
-  LidxT const** idxs;
-  IdxT const*   lens;
+  void const* const* srcs;
+  char* const*       bufs;
+  LidxT const**      idxs;
+  IdxT const*        lens;
+  IdxT               zone_offset;
 
-  DataT const* src = nullptr;
-  DataT*       bufk = nullptr;
-  DataT*       buf = nullptr;
+  T const*     src = nullptr;
+  B*           bufk = nullptr;
+  B*           buf = nullptr;
   LidxT const* idx = nullptr;
   IdxT         len = 0;
 
-  fused_packer(DataT const** srcs_, DataT** bufs_, LidxT const** idxs_, IdxT const* lens_)
+  fused_packer(void const* const* srcs_, char* const* bufs_, LidxT const** idxs_, IdxT const* lens_,
+               IdxT zone_offset_)
     : srcs(srcs_)
     , bufs(bufs_)
     , idxs(idxs_)
     , lens(lens_)
+    , zone_offset(zone_offset_)
   { }
 
   COMB_HOST COMB_DEVICE
@@ -190,13 +312,13 @@ struct fused_packer
   {
     len = lens[k];
     idx = idxs[k];
-    bufk = bufs[k];
+    bufk = reinterpret_cast<B*>(bufs[k] + len*zone_offset);
   }
 
   COMB_HOST COMB_DEVICE
   void set_inner(IdxT j)
   {
-    src = srcs[j];
+    src = static_cast<T const*>(srcs[j]);
     buf = bufk + j*len;
   }
 
@@ -211,24 +333,28 @@ struct fused_packer
   }
 };
 
+template < typename T, typename B = T >
 struct fused_unpacker
 {
-  DataT**       dsts;
-  DataT const** bufs;
-  LidxT const** idxs;
-  IdxT  const*  lens;
+  void* const*       dsts;
+  char const* const* bufs;
+  LidxT const**      idxs;
+  IdxT  const*       lens;
+  IdxT               zone_offset;
 
-  DataT*       dst = nullptr;
-  DataT const* bufk = nullptr;
-  DataT const* buf = nullptr;
+  T*           dst = nullptr;
+  B const*     bufk = nullptr;
+  B const*     buf = nullptr;
   LidxT const* idx = nullptr;
   IdxT         len = 0;
 
-  fused_unpacker(DataT** dsts_, DataT const** bufs_, LidxT const** idxs_, IdxT const* lens_)
+  fused_unpacker(void* const* dsts_, char const* const* bufs_, LidxT const** idxs_, IdxT const* lens_,
+                 IdxT zone_offset_)
     : dsts(dsts_)
     , bufs(bufs_)
     , idxs(idxs_)
     , lens(lens_)
+    , zone_offset(zone_offset_)
   { }
 
   COMB_HOST COMB_DEVICE
@@ -236,13 +362,13 @@ struct fused_unpacker
   {
     len = lens[k];
     idx = idxs[k];
-    bufk = bufs[k];
+    bufk = reinterpret_cast<B const*>(bufs[k] + len*zone_offset);
   }
 
   COMB_HOST COMB_DEVICE
   void set_inner(IdxT j)
   {
-    dst = dsts[j];
+    dst = static_cast<T*>(dsts[j]);
     buf = bufk + j*len;
   }
 
@@ -257,7 +383,743 @@ struct fused_unpacker
   }
 };
 
+// copies the zones of a variable at src indices to the zones at dst indices,
+// used for messages whose partner is this rank
+template < typename T >
+struct fused_copier
+{
+  void* const*  vars;
+  LidxT const** srcs;
+  LidxT const** dsts;
+  IdxT  const*  lens;
+
+  T*           var = nullptr;
+  LidxT const* src = nullptr;
+  LidxT const* dst = nullptr;
+  IdxT         len = 0;
+
+  fused_copier(void* const* vars_, LidxT const** srcs_, LidxT const** dsts_, IdxT const* lens_)
+    : vars(vars_)
+    , srcs(srcs_)
+    , dsts(dsts_)
+    , lens(lens_)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    len = lens[k];
+    src = srcs[k];
+    dst = dsts[k];
+  }
+
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT j)
+  {
+    var = static_cast<T*>(vars[j]);
+  }
+
+  // must be run for all i in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT i, IdxT)
+  {
+    var[dst[i]] = var[src[i]];
+  }
+};
+
+// shape of the boxes described by a message item, from the number of
+// dimensions in which the boxes are no wider than the ghost zones
+enum struct ShapeClass
+{
+  face   // thin in one dimension
+ ,edge   // thin in two dimensions
+ ,corner // thin in all three dimensions
+ ,mixed  // boxes of different shapes or of unknown shape
+};
+
+inline ShapeClass combine_shape_class(ShapeClass a, ShapeClass b)
+{
+  return (a == b) ? a : ShapeClass::mixed;
+}
+
+// fused_packer specialised on the number of variables, packs all variables
+// of a zone per call so each index is loaded once,
+// with whole_items each item is packed in a single call as corner items are
+// a few zones, the variables of a zone are adjacent in the buffer when
+// interleaved
+template < typename T, IdxT num_vars, bool whole_items, typename B = T >
+struct fused_packer_vars
+{
+  T const*      srcs[num_vars];
+  char* const*  bufs;
+  LidxT const** idxs;
+  IdxT const*   lens;
+  IdxT          zone_offset;
+  bool          interleaved;
+
+  B*           buf = nullptr;
+  LidxT const* idx = nullptr;
+  IdxT         item_len = 0;
+  IdxT         len = 0;
+  IdxT         var_stride = 0;
+  IdxT         zone_stride = 0;
+
+  fused_packer_vars(void const* const* srcs_, char* const* bufs_, LidxT const** idxs_, IdxT const* lens_,
+                    IdxT zone_offset_, bool interleaved_)
+    : bufs(bufs_)
+    , idxs(idxs_)
+    , lens(lens_)
+    , zone_offset(zone_offset_)
+    , interleaved(interleaved_)
+  {
+    for (IdxT j = 0; j < num_vars; ++j) {
+      srcs[j] = static_cast<T const*>(srcs_[j]);
+    }
+  }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    item_len = lens[k];
+    idx = idxs[k];
+    buf = reinterpret_cast<B*>(bufs[k] + item_len*zone_offset);
+    len = whole_items ? ((item_len > 0) ? 1 : 0) : item_len;
+    var_stride  = interleaved ? 1 : item_len;
+    zone_stride = interleaved ? num_vars : 1;
+  }
+
+  // all variables are handled in each call
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void pack_zone(IdxT i) const
+  {
+    LidxT zone = idx[i];
+    B* zone_buf = buf + i*zone_stride;
+    for (IdxT j = 0; j < num_vars; ++j) {
+      zone_buf[j*var_stride] = srcs[j][zone];
+    }
+  }
+
+  // must be run for all i in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT i, IdxT) const
+  {
+    if (whole_items) {
+      for (IdxT ii = 0; ii < item_len; ++ii) {
+        pack_zone(ii);
+      }
+    } else {
+      pack_zone(i);
+    }
+  }
+};
+
+template < typename T, IdxT num_vars, bool whole_items, typename B = T >
+struct fused_unpacker_vars
+{
+  T*                 dsts[num_vars];
+  char const* const* bufs;
+  LidxT const**      idxs;
+  IdxT const*        lens;
+  IdxT               zone_offset;
+  bool               interleaved;
+
+  B const*     buf = nullptr;
+  LidxT const* idx = nullptr;
+  IdxT         item_len = 0;
+  IdxT         len = 0;
+  IdxT         var_stride = 0;
+  IdxT         zone_stride = 0;
+
+  fused_unpacker_vars(void* const* dsts_, char const* const* bufs_, LidxT const** idxs_, IdxT const* lens_,
+                      IdxT zone_offset_, bool interleaved_)
+    : bufs(bufs_)
+    , idxs(idxs_)
+    , lens(lens_)
+    , zone_offset(zone_offset_)
+    , interleaved(interleaved_)
+  {
+    for (IdxT j = 0; j < num_vars; ++j) {
+      dsts[j] = static_cast<T*>(dsts_[j]);
+    }
+  }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    item_len = lens[k];
+    idx = idxs[k];
+    buf = reinterpret_cast<B const*>(bufs[k] + item_len*zone_offset);
+    len = whole_items ? ((item_len > 0) ? 1 : 0) : item_len;
+    var_stride  = interleaved ? 1 : item_len;
+    zone_stride = interleaved ? num_vars : 1;
+  }
+
+  // all variables are handled in each call
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void unpack_zone(IdxT i) const
+  {
+    LidxT zone = idx[i];
+    B const* zone_buf = buf + i*zone_stride;
+    for (IdxT j = 0; j < num_vars; ++j) {
+      dsts[j][zone] = zone_buf[j*var_stride];
+    }
+  }
+
+  // must be run for all i in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT i, IdxT) const
+  {
+    if (whole_items) {
+      for (IdxT ii = 0; ii < item_len; ++ii) {
+        unpack_zone(ii);
+      }
+    } else {
+      unpack_zone(i);
+    }
+  }
+};
+
+// packs all variables of a zone contiguously in the buffer
+template < typename T, typename B = T >
+struct fused_interleaved_packer
+{
+  void const* const* srcs;
+  char* const*       bufs;
+  LidxT const**      idxs;
+  IdxT const*        lens;
+  IdxT               num_vars;
+  IdxT               zone_offset;
+
+  B*           buf = nullptr;
+  LidxT const* idx = nullptr;
+  IdxT         len = 0;
+
+  fused_interleaved_packer(void const* const* srcs_, char* const* bufs_, LidxT const** idxs_, IdxT const* lens_,
+                           IdxT num_vars_, IdxT zone_offset_)
+    : srcs(srcs_)
+    , bufs(bufs_)
+    , idxs(idxs_)
+    , lens(lens_)
+    , num_vars(num_vars_)
+    , zone_offset(zone_offset_)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    len = lens[k];
+    idx = idxs[k];
+    buf = reinterpret_cast<B*>(bufs[k] + len*zone_offset);
+  }
+
+  // all variables are handled in each call
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT)
+  { }
+
+  // must be run for all i in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT i, IdxT) const
+  {
+    LidxT zone = idx[i];
+    B* zone_buf = buf + i*num_vars;
+    for (IdxT j = 0; j < num_vars; ++j) {
+      zone_buf[j] = static_cast<T const*>(srcs[j])[zone];
+    }
+  }
+};
+
+template < typename T, typename B = T >
+struct fused_interleaved_unpacker
+{
+  void* const*       dsts;
+  char const* const* bufs;
+  LidxT const**      idxs;
+  IdxT const*        lens;
+  IdxT               num_vars;
+  IdxT               zone_offset;
+
+  B const*     buf = nullptr;
+  LidxT const* idx = nullptr;
+  IdxT         len = 0;
+
+  fused_interleaved_unpacker(void* const* dsts_, char const* const* bufs_, LidxT const** idxs_, IdxT const* lens_,
+                             IdxT num_vars_, IdxT zone_offset_)
+    : dsts(dsts_)
+    , bufs(bufs_)
+    , idxs(idxs_)
+    , lens(lens_)
+    , num_vars(num_vars_)
+    , zone_offset(zone_offset_)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    len = lens[k];
+    idx = idxs[k];
+    buf = reinterpret_cast<B const*>(bufs[k] + len*zone_offset);
+  }
+
+  // all variables are handled in each call
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT)
+  { }
+
+  // must be run for all i in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT i, IdxT) const
+  {
+    LidxT zone = idx[i];
+    B const* zone_buf = buf + i*num_vars;
+    for (IdxT j = 0; j < num_vars; ++j) {
+      static_cast<T*>(dsts[j])[zone] = zone_buf[j];
+    }
+  }
+};
+
+// describes the zones of a box as num_rows rows of row_runs contiguous runs
+// of run_len zones, rows are the longer of the two strided dimensions so the
+// number of rows is the parallel loop length
+struct box_runs
+{
+  LidxT offset = 0;
+  IdxT run_len = 0;
+  IdxT row_runs = 0;
+  IdxT run_stride = 0;
+  IdxT run_buf_stride = 0;
+  IdxT num_rows = 0;
+  IdxT row_stride = 0;
+  IdxT row_buf_stride = 0;
+
+  COMB_HOST COMB_DEVICE
+  IdxT size() const
+  {
+    return run_len * row_runs * num_rows;
+  }
+
+  template < typename T, typename B >
+  COMB_HOST COMB_DEVICE
+  void copy_row_to_buf(T const* src, B* buf, IdxT r) const
+  {
+    T const* row_src = src + offset + r * row_stride;
+    B* row_buf = buf + r * row_buf_stride;
+    for (IdxT q = 0; q < row_runs; ++q) {
+      T const* run_src = row_src + q * run_stride;
+      B* run_buf = row_buf + q * run_buf_stride;
+      for (IdxT i = 0; i < run_len; ++i) {
+        run_buf[i] = run_src[i];
+      }
+    }
+  }
+
+  template < typename T, typename B >
+  COMB_HOST COMB_DEVICE
+  void copy_row_from_buf(T* dst, B const* buf, IdxT r) const
+  {
+    T* row_dst = dst + offset + r * row_stride;
+    B const* row_buf = buf + r * row_buf_stride;
+    for (IdxT q = 0; q < row_runs; ++q) {
+      T* run_dst = row_dst + q * run_stride;
+      B const* run_buf = row_buf + q * run_buf_stride;
+      for (IdxT i = 0; i < run_len; ++i) {
+        run_dst[i] = run_buf[i];
+      }
+    }
+  }
+};
+
+// copies one row of a box into a buffer per call
+template < typename T, typename B = T >
+struct box_packer
+{
+  T const* src;
+  box_runs box;
+  B* buf;
+
+  box_packer(T const* src_, box_runs const& box_, B* buf_)
+    : src(src_)
+    , box(box_)
+    , buf(buf_)
+  { }
+
+  // must be run for all r in [0, box.num_rows)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT) const
+  {
+    box.copy_row_to_buf(src, buf, r);
+  }
+};
+
+template < typename T, typename B >
+box_packer<T, B> make_box_packer(T const* src, box_runs const& box, B* buf)
+{
+  return box_packer<T, B>(src, box, buf);
+}
+
+// copies one row of a buffer into a box per call
+template < typename T, typename B = T >
+struct box_unpacker
+{
+  T* dst;
+  box_runs box;
+  B const* buf;
+
+  box_unpacker(T* dst_, box_runs const& box_, B const* buf_)
+    : dst(dst_)
+    , box(box_)
+    , buf(buf_)
+  { }
+
+  // must be run for all r in [0, box.num_rows)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT) const
+  {
+    box.copy_row_from_buf(dst, buf, r);
+  }
+};
+
+template < typename T, typename B >
+box_unpacker<T, B> make_box_unpacker(T* dst, box_runs const& box, B const* buf)
+{
+  return box_unpacker<T, B>(dst, box, buf);
+}
+
+template < typename T, typename B = T >
+struct fused_box_packer
+{
+  void const* const* srcs;
+  char* const*       bufs;
+  box_runs const*    boxs;
+  IdxT               zone_offset;
+
+  T const*     src = nullptr;
+  B*           bufk = nullptr;
+  B*           buf = nullptr;
+  box_runs     box;
+  IdxT         len = 0;
+
+  fused_box_packer(void const* const* srcs_, char* const* bufs_, box_runs const* boxs_,
+                   IdxT zone_offset_)
+    : srcs(srcs_)
+    , bufs(bufs_)
+    , boxs(boxs_)
+    , zone_offset(zone_offset_)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    box = boxs[k];
+    len = box.num_rows;
+    bufk = reinterpret_cast<B*>(bufs[k] + box.size()*zone_offset);
+  }
+
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT j)
+  {
+    src = static_cast<T const*>(srcs[j]);
+    buf = bufk + j*box.size();
+  }
+
+  // must be run for all r in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT)
+  {
+    box.copy_row_to_buf(src, buf, r);
+  }
+};
+
+template < typename T, typename B = T >
+struct fused_box_unpacker
+{
+  void* const*       dsts;
+  char const* const* bufs;
+  box_runs const*    boxs;
+  IdxT               zone_offset;
+
+  T*           dst = nullptr;
+  B const*     bufk = nullptr;
+  B const*     buf = nullptr;
+  box_runs     box;
+  IdxT         len = 0;
+
+  fused_box_unpacker(void* const* dsts_, char const* const* bufs_, box_runs const* boxs_,
+                     IdxT zone_offset_)
+    : dsts(dsts_)
+    , bufs(bufs_)
+    , boxs(boxs_)
+    , zone_offset(zone_offset_)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    box = boxs[k];
+    len = box.num_rows;
+    bufk = reinterpret_cast<B const*>(bufs[k] + box.size()*zone_offset);
+  }
+
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT j)
+  {
+    dst = static_cast<T*>(dsts[j]);
+    buf = bufk + j*box.size();
+  }
+
+  // must be run for all r in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT)
+  {
+    box.copy_row_from_buf(dst, buf, r);
+  }
+};
+
+// copies the zones of a variable in src boxes to the zones of dst boxes of
+// the same extents one row per call, used for messages whose partner is
+// this rank when items are described by box
+template < typename T >
+struct fused_box_copier
+{
+  void* const*    vars;
+  box_runs const* srcs;
+  box_runs const* dsts;
+
+  T*           var = nullptr;
+  box_runs     src;
+  box_runs     dst;
+  IdxT         len = 0;
+
+  fused_box_copier(void* const* vars_, box_runs const* srcs_, box_runs const* dsts_)
+    : vars(vars_)
+    , srcs(srcs_)
+    , dsts(dsts_)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    src = srcs[k];
+    dst = dsts[k];
+    len = src.num_rows;
+  }
+
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT j)
+  {
+    var = static_cast<T*>(vars[j]);
+  }
+
+  // must be run for all r in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT)
+  {
+    T const* row_src = var + src.offset + r * src.row_stride;
+    T* row_dst = var + dst.offset + r * dst.row_stride;
+    for (IdxT q = 0; q < src.row_runs; ++q) {
+      T const* run_src = row_src + q * src.run_stride;
+      T* run_dst = row_dst + q * dst.run_stride;
+      for (IdxT i = 0; i < src.run_len; ++i) {
+        run_dst[i] = run_src[i];
+      }
+    }
+  }
+};
+
+// describes zones as num_runs runs of contiguous zones,
+// run r starts at zone starts[r] and at buffer element offsets[r]
+// and has offsets[r+1] - offsets[r] zones
+struct index_runs
+{
+  LidxT* starts = nullptr;
+  IdxT* offsets = nullptr;
+  IdxT num_runs = 0;
+
+  COMB_HOST COMB_DEVICE
+  IdxT size() const
+  {
+    return (num_runs > 0) ? offsets[num_runs] : 0;
+  }
+
+  template < typename T, typename B >
+  COMB_HOST COMB_DEVICE
+  void copy_run_to_buf(T const* src, B* buf, IdxT r) const
+  {
+    T const* run_src = src + starts[r];
+    IdxT run_begin = offsets[r];
+    IdxT run_end = offsets[r+1];
+    for (IdxT i = run_begin; i < run_end; ++i) {
+      buf[i] = run_src[i - run_begin];
+    }
+  }
+
+  template < typename T, typename B >
+  COMB_HOST COMB_DEVICE
+  void copy_run_from_buf(T* dst, B const* buf, IdxT r) const
+  {
+    T* run_dst = dst + starts[r];
+    IdxT run_begin = offsets[r];
+    IdxT run_end = offsets[r+1];
+    for (IdxT i = run_begin; i < run_end; ++i) {
+      run_dst[i - run_begin] = buf[i];
+    }
+  }
+};
+
+// copies one run into a buffer per call
+template < typename T, typename B = T >
+struct runs_packer
+{
+  T const* src;
+  index_runs runs;
+  B* buf;
+
+  runs_packer(T const* src_, index_runs const& runs_, B* buf_)
+    : src(src_)
+    , runs(runs_)
+    , buf(buf_)
+  { }
+
+  // must be run for all r in [0, runs.num_runs)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT) const
+  {
+    runs.copy_run_to_buf(src, buf, r);
+  }
+};
+
+template < typename T, typename B >
+runs_packer<T, B> make_runs_packer(T const* src, index_runs const& runs, B* buf)
+{
+  return runs_packer<T, B>(src, runs, buf);
+}
+
+// copies one run of a buffer into the mesh per call
+template < typename T, typename B = T >
+struct runs_unpacker
+{
+  T* dst;
+  index_runs runs;
+  B const* buf;
+
+  runs_unpacker(T* dst_, index_runs const& runs_, B const* buf_)
+    : dst(dst_)
+    , runs(runs_)
+    , buf(buf_)
+  { }
+
+  // must be run for all r in [0, runs.num_runs)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT) const
+  {
+    runs.copy_run_from_buf(dst, buf, r);
+  }
+};
+
+template < typename T, typename B >
+runs_unpacker<T, B> make_runs_unpacker(T* dst, index_runs const& runs, B const* buf)
+{
+  return runs_unpacker<T, B>(dst, runs, buf);
+}
+
+template < typename T, typename B = T >
+struct fused_runs_packer
+{
+  void const* const* srcs;
+  char* const*       bufs;
+  index_runs const*  runss;
+  IdxT               zone_offset;
+
+  T const*     src = nullptr;
+  B*           bufk = nullptr;
+  B*           buf = nullptr;
+  index_runs   runs;
+  IdxT         len = 0;
+
+  fused_runs_packer(void const* const* srcs_, char* const* bufs_, index_runs const* runss_,
+                    IdxT zone_offset_)
+    : srcs(srcs_)
+    , bufs(bufs_)
+    , runss(runss_)
+    , zone_offset(zone_offset_)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    runs = runss[k];
+    len = runs.num_runs;
+    bufk = reinterpret_cast<B*>(bufs[k] + runs.size()*zone_offset);
+  }
+
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT j)
+  {
+    src = static_cast<T const*>(srcs[j]);
+    buf = bufk + j*runs.size();
+  }
+
+  // must be run for all r in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT)
+  {
+    runs.copy_run_to_buf(src, buf, r);
+  }
+};
+
+template < typename T, typename B = T >
+struct fused_runs_unpacker
+{
+  void* const*       dsts;
+  char const* const* bufs;
+  index_runs const*  runss;
+  IdxT               zone_offset;
+
+  T*           dst = nullptr;
+  B const*     bufk = nullptr;
+  B const*     buf = nullptr;
+  index_runs   runs;
+  IdxT         len = 0;
+
+  fused_runs_unpacker(void* const* dsts_, char const* const* bufs_, index_runs const* runss_,
+                      IdxT zone_offset_)
+    : dsts(dsts_)
+    , bufs(bufs_)
+    , runss(runss_)
+    , zone_offset(zone_offset_)
+  { }
+
+  COMB_HOST COMB_DEVICE
+  void set_outer(IdxT k)
+  {
+    runs = runss[k];
+    len = runs.num_runs;
+    bufk = reinterpret_cast<B const*>(bufs[k] + runs.size()*zone_offset);
+  }
+
+  COMB_HOST COMB_DEVICE
+  void set_inner(IdxT j)
+  {
+    dst = static_cast<T*>(dsts[j]);
+    buf = bufk + j*runs.size();
+  }
+
+  // must be run for all r in [0, len)
+  COMB_HOST COMB_DEVICE
+  void operator()(IdxT r, IdxT)
+  {
+    runs.copy_run_from_buf(dst, buf, r);
+  }
+};
+
 } // namespace detail
 
 #endif // _UTILS_HPP
-
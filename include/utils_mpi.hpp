@@ -25,6 +25,8 @@
 
 #include <mpi.h>
 
+#include "utils.hpp"
+
 namespace detail {
 
 namespace MPI {
@@ -97,6 +99,15 @@ inline void Comm_free(MPI_Comm* comm)
   assert(ret == MPI_SUCCESS);
 }
 
+inline MPI_Comm Comm_split_type(MPI_Comm comm, int split_type, int key)
+{
+  MPI_Comm newcomm;
+  // FGPRINTF(FileGroup::proc, "MPI_Comm_split_type rank(w%i) split_type %i key %i\n", Comm_rank(MPI_COMM_WORLD), split_type, key);
+  int ret = MPI_Comm_split_type(comm, split_type, key, MPI_INFO_NULL, &newcomm);
+  assert(ret == MPI_SUCCESS);
+  return newcomm;
+}
+
 inline MPI_Comm Cart_create(MPI_Comm comm_old, int ndims, const int*dims, const int* periods, int reorder)
 {
   MPI_Comm cartcomm;
@@ -106,6 +117,15 @@ inline MPI_Comm Cart_create(MPI_Comm comm_old, int ndims, const int*dims, const
   return cartcomm;
 }
 
+inline MPI_Comm Dist_graph_create_adjacent(MPI_Comm comm_old, int indegree, const int* sources, int outdegree, const int* destinations, int reorder)
+{
+  MPI_Comm comm;
+  // FGPRINTF(FileGroup::proc, "MPI_Dist_graph_create_adjacent rank(w%i) indegree(%i) outdegree(%i)\n", Comm_rank(MPI_COMM_WORLD), indegree, outdegree);
+  int ret = MPI_Dist_graph_create_adjacent(comm_old, indegree, sources, MPI_UNWEIGHTED, outdegree, destinations, MPI_UNWEIGHTED, MPI_INFO_NULL, reorder, &comm);
+  assert(ret == MPI_SUCCESS);
+  return comm;
+}
+
 inline void Cart_coords(MPI_Comm cartcomm, int rank, int maxdims, int* coords)
 {
 
@@ -123,6 +143,17 @@ inline int Cart_rank(MPI_Comm cartcomm, const int* coords)
   return rank;
 }
 
+inline MPI_Datatype elem_mpi_type(ElemType type)
+{
+  MPI_Datatype mpi_type = MPI_DOUBLE;
+  switch (type) {
+    case ElemType::f64: mpi_type = MPI_DOUBLE; break;
+    case ElemType::f32: mpi_type = MPI_FLOAT;  break;
+    case ElemType::i32: mpi_type = MPI_INT;    break;
+  }
+  return mpi_type;
+}
+
 inline MPI_Datatype Type_create_indexed_block(int count, int blocklength, const int *displacements, MPI_Datatype old_type)
 {
   MPI_Datatype mpi_type;
@@ -141,6 +172,33 @@ inline MPI_Datatype Type_create_subarray(int ndims, const int *sizes, const int
   return mpi_type;
 }
 
+inline MPI_Datatype Type_vector(int count, int blocklength, int stride, MPI_Datatype old_type)
+{
+  MPI_Datatype mpi_type;
+  int ret = MPI_Type_vector(count, blocklength, stride, old_type, &mpi_type);
+  // FGPRINTF(FileGroup::proc, "MPI_Type_vector rank(w%i) count(%i) blocklength(%i) stride(%i)\n", Comm_rank(MPI_COMM_WORLD), count, blocklength, stride);
+  assert(ret == MPI_SUCCESS);
+  return mpi_type;
+}
+
+inline MPI_Datatype Type_create_struct(int count, const int* blocklengths, const MPI_Aint* displacements, const MPI_Datatype* types)
+{
+  MPI_Datatype mpi_type;
+  int ret = MPI_Type_create_struct(count, blocklengths, displacements, types, &mpi_type);
+  // FGPRINTF(FileGroup::proc, "MPI_Type_create_struct rank(w%i) count(%i)\n", Comm_rank(MPI_COMM_WORLD), count);
+  assert(ret == MPI_SUCCESS);
+  return mpi_type;
+}
+
+inline MPI_Aint Get_address(const void* location)
+{
+  MPI_Aint address;
+  int ret = MPI_Get_address(location, &address);
+  // FGPRINTF(FileGroup::proc, "MPI_Get_address rank(w%i) location(%p)\n", Comm_rank(MPI_COMM_WORLD), location);
+  assert(ret == MPI_SUCCESS);
+  return address;
+}
+
 inline void Type_commit(MPI_Datatype* mpi_type)
 {
   int ret = MPI_Type_commit(mpi_type);
@@ -169,6 +227,13 @@ inline void Bcast(void* buf, int count, MPI_Datatype mpi_type, int root, MPI_Com
   assert(ret == MPI_SUCCESS);
 }
 
+inline void Allreduce(const void* inbuf, void* outbuf, int count, MPI_Datatype mpi_type, MPI_Op op, MPI_Comm comm)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Allreduce rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Allreduce(inbuf, outbuf, count, mpi_type, op, comm);
+  assert(ret == MPI_SUCCESS);
+}
+
 inline void Reduce(const void* inbuf, void* outbuf, int count, MPI_Datatype mpi_type, MPI_Op op, int root, MPI_Comm comm)
 {
   // FGPRINTF(FileGroup::proc, "MPI_Reduce rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
@@ -215,6 +280,218 @@ inline void Isend(const void *buf, int count, MPI_Datatype mpi_type, int dest, i
   assert(ret == MPI_SUCCESS);
 }
 
+inline void Recv_init(void *buf, int count, MPI_Datatype mpi_type, int src, int tag, MPI_Comm comm, MPI_Request *request)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Recv_init rank(w%i) %p[%i] src(%i) tag(%i)\n", Comm_rank(MPI_COMM_WORLD), buf, count, src, tag);
+  int ret = MPI_Recv_init(buf, count, mpi_type, src, tag, comm, request);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Send_init(const void *buf, int count, MPI_Datatype mpi_type, int dest, int tag, MPI_Comm comm, MPI_Request *request)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Send_init rank(w%i) %p[%i] dst(%i) tag(%i)\n", Comm_rank(MPI_COMM_WORLD), buf, count, dest, tag);
+  int ret = MPI_Send_init(buf, count, mpi_type, dest, tag, comm, request);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Startall(int count, MPI_Request *requests)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Startall rank(w%i) count(%i)\n", Comm_rank(MPI_COMM_WORLD), count);
+  int ret = MPI_Startall(count, requests);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Request_free(MPI_Request *request)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Request_free rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Request_free(request);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Ineighbor_alltoallv(const void* sendbuf, const int* sendcounts, const int* sdispls, MPI_Datatype sendtype,
+                                void* recvbuf, const int* recvcounts, const int* rdispls, MPI_Datatype recvtype,
+                                MPI_Comm comm, MPI_Request *request)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Ineighbor_alltoallv rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Ineighbor_alltoallv(sendbuf, sendcounts, sdispls, sendtype, recvbuf, recvcounts, rdispls, recvtype, comm, request);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Ineighbor_alltoallw(const void* sendbuf, const int* sendcounts, const MPI_Aint* sdispls, const MPI_Datatype* sendtypes,
+                                void* recvbuf, const int* recvcounts, const MPI_Aint* rdispls, const MPI_Datatype* recvtypes,
+                                MPI_Comm comm, MPI_Request *request)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Ineighbor_alltoallw rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Ineighbor_alltoallw(sendbuf, sendcounts, sdispls, sendtypes, recvbuf, recvcounts, rdispls, recvtypes, comm, request);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline MPI_Group Comm_group(MPI_Comm comm)
+{
+  MPI_Group group;
+  // FGPRINTF(FileGroup::proc, "MPI_Comm_group rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Comm_group(comm, &group);
+  assert(ret == MPI_SUCCESS);
+  return group;
+}
+
+inline MPI_Group Group_incl(MPI_Group group, int n, const int* ranks)
+{
+  MPI_Group newgroup;
+  // FGPRINTF(FileGroup::proc, "MPI_Group_incl rank(w%i) n(%i)\n", Comm_rank(MPI_COMM_WORLD), n);
+  int ret = MPI_Group_incl(group, n, ranks, &newgroup);
+  assert(ret == MPI_SUCCESS);
+  return newgroup;
+}
+
+inline void Group_translate_ranks(MPI_Group group1, int n, const int* ranks1, MPI_Group group2, int* ranks2)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Group_translate_ranks rank(w%i) n(%i)\n", Comm_rank(MPI_COMM_WORLD), n);
+  int ret = MPI_Group_translate_ranks(group1, n, ranks1, group2, ranks2);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Group_free(MPI_Group* group)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Group_free rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Group_free(group);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline MPI_Win Win_create(void* base, MPI_Aint size, int disp_unit, MPI_Comm comm)
+{
+  MPI_Win win;
+  // FGPRINTF(FileGroup::proc, "MPI_Win_create rank(w%i) %p[%li]\n", Comm_rank(MPI_COMM_WORLD), base, (long)size);
+  int ret = MPI_Win_create(base, size, disp_unit, MPI_INFO_NULL, comm, &win);
+  assert(ret == MPI_SUCCESS);
+  return win;
+}
+
+inline MPI_Win Win_allocate(MPI_Aint size, int disp_unit, MPI_Comm comm, void* baseptr)
+{
+  MPI_Win win;
+  // FGPRINTF(FileGroup::proc, "MPI_Win_allocate rank(w%i) size(%li)\n", Comm_rank(MPI_COMM_WORLD), (long)size);
+  int ret = MPI_Win_allocate(size, disp_unit, MPI_INFO_NULL, comm, baseptr, &win);
+  assert(ret == MPI_SUCCESS);
+  return win;
+}
+
+inline MPI_Win Win_allocate_shared(MPI_Aint size, int disp_unit, MPI_Comm comm, void* baseptr)
+{
+  MPI_Win win;
+  // FGPRINTF(FileGroup::proc, "MPI_Win_allocate_shared rank(w%i) size(%li)\n", Comm_rank(MPI_COMM_WORLD), (long)size);
+  int ret = MPI_Win_allocate_shared(size, disp_unit, MPI_INFO_NULL, comm, baseptr, &win);
+  assert(ret == MPI_SUCCESS);
+  return win;
+}
+
+inline void Win_shared_query(MPI_Win win, int rank, MPI_Aint* size, int* disp_unit, void* baseptr)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_shared_query rank(w%i) rank(%i)\n", Comm_rank(MPI_COMM_WORLD), rank);
+  int ret = MPI_Win_shared_query(win, rank, size, disp_unit, baseptr);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_free(MPI_Win* win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_free rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_free(win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_fence(int assert_, MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_fence rank(w%i) assert(%i)\n", Comm_rank(MPI_COMM_WORLD), assert_);
+  int ret = MPI_Win_fence(assert_, win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_post(MPI_Group group, int assert_, MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_post rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_post(group, assert_, win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_start(MPI_Group group, int assert_, MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_start rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_start(group, assert_, win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_complete(MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_complete rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_complete(win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_wait(MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_wait rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_wait(win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline bool Win_test(MPI_Win win)
+{
+  int completed = 0;
+  // FGPRINTF(FileGroup::proc, "MPI_Win_test rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_test(win, &completed);
+  assert(ret == MPI_SUCCESS);
+  return completed;
+}
+
+inline void Win_lock_all(int assert_, MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_lock_all rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_lock_all(assert_, win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_unlock_all(MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_unlock_all rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_unlock_all(win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_flush(int rank, MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_flush rank(w%i) target(%i)\n", Comm_rank(MPI_COMM_WORLD), rank);
+  int ret = MPI_Win_flush(rank, win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Win_sync(MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Win_sync rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
+  int ret = MPI_Win_sync(win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Put(const void* buf, int count, MPI_Datatype mpi_type, int target_rank, MPI_Aint target_disp, MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Put rank(w%i) %p[%i] target(%i) disp(%li)\n", Comm_rank(MPI_COMM_WORLD), buf, count, target_rank, (long)target_disp);
+  int ret = MPI_Put(buf, count, mpi_type, target_rank, target_disp, count, mpi_type, win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Accumulate(const void* buf, int count, MPI_Datatype mpi_type, int target_rank, MPI_Aint target_disp, MPI_Op op, MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Accumulate rank(w%i) target(%i) disp(%li)\n", Comm_rank(MPI_COMM_WORLD), target_rank, (long)target_disp);
+  int ret = MPI_Accumulate(buf, count, mpi_type, target_rank, target_disp, count, mpi_type, op, win);
+  assert(ret == MPI_SUCCESS);
+}
+
+inline void Fetch_and_op(const void* buf, void* result, MPI_Datatype mpi_type, int target_rank, MPI_Aint target_disp, MPI_Op op, MPI_Win win)
+{
+  // FGPRINTF(FileGroup::proc, "MPI_Fetch_and_op rank(w%i) target(%i) disp(%li)\n", Comm_rank(MPI_COMM_WORLD), target_rank, (long)target_disp);
+  int ret = MPI_Fetch_and_op(buf, result, mpi_type, target_rank, target_disp, op, win);
+  assert(ret == MPI_SUCCESS);
+}
+
 inline void Wait(MPI_Request *request, MPI_Status *status)
 {
   // FGPRINTF(FileGroup::proc, "MPI_Wait rank(w%i)\n", Comm_rank(MPI_COMM_WORLD));
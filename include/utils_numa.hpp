@@ -0,0 +1,152 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _UTILS_NUMA_HPP
+#define _UTILS_NUMA_HPP
+
+#include "config.hpp"
+
+#include <cstddef>
+#include <cstdio>
+#include <cstdlib>
+#include <vector>
+
+#if defined(__linux__)
+#include <sys/syscall.h>
+#include <unistd.h>
+#endif
+
+namespace detail {
+
+// numa memory policy via the linux syscalls so libnuma is not required,
+// without them there is a single node and policies are ignored
+namespace numa {
+
+// memory policy modes from linux/mempolicy.h
+const int mpol_bind       = 2;
+const int mpol_interleave = 3;
+
+// node masks are a single word
+const int max_nodes = 8 * sizeof(unsigned long);
+
+inline int num_nodes()
+{
+  static int nodes = []() {
+    int n = 1;
+#if defined(__linux__)
+    // the online nodes as a list of ranges like 0-1,3
+    FILE* f = fopen("/sys/devices/system/node/online", "r");
+    if (f != nullptr) {
+      int first = 0, last = 0;
+      char sep = 0;
+      while (fscanf(f, "%d", &first) == 1) {
+        last = first;
+        if (fscanf(f, "%c", &sep) == 1 && sep == '-') {
+          if (fscanf(f, "%d", &last) != 1) break;
+          if (fscanf(f, "%c", &sep) != 1) sep = 0;
+        }
+        if (last + 1 > n) n = last + 1;
+        if (sep != ',') break;
+      }
+      fclose(f);
+    }
+#endif
+    return (n < max_nodes) ? n : max_nodes;
+  }();
+  return nodes;
+}
+
+inline size_t page_nbytes()
+{
+#if defined(__linux__)
+  static size_t nbytes = sysconf(_SC_PAGESIZE);
+  return nbytes;
+#else
+  return 4096;
+#endif
+}
+
+inline unsigned long all_nodes_mask()
+{
+  int n = num_nodes();
+  return (n < max_nodes) ? (1ul << n) - 1ul : ~0ul;
+}
+
+// node of the cpu the calling thread runs on
+inline int current_node()
+{
+  int node = 0;
+#if defined(__linux__) && defined(SYS_getcpu)
+  unsigned cpu = 0, node_ = 0;
+  if (syscall(SYS_getcpu, &cpu, &node_, nullptr) == 0) {
+    node = static_cast<int>(node_);
+  }
+#endif
+  return (node < max_nodes) ? node : 0;
+}
+
+// sets the policy of the page aligned range, returns false on failure
+inline bool mbind(void* ptr, size_t len, int mode, unsigned long mask)
+{
+#if defined(__linux__) && defined(SYS_mbind)
+  return syscall(SYS_mbind, ptr, len, mode, &mask, max_nodes + 1, 0) == 0;
+#else
+  static_cast<void>(ptr); static_cast<void>(len);
+  static_cast<void>(mode); static_cast<void>(mask);
+  return false;
+#endif
+}
+
+// adds the number of pages of the range on each node to node_pages,
+// the last entry counts pages not yet touched or not found
+inline void page_nodes(void const* ptr, size_t nbytes, std::vector<long>& node_pages)
+{
+  int nodes = num_nodes();
+  if (static_cast<int>(node_pages.size()) < nodes + 1) {
+    node_pages.resize(nodes + 1, 0);
+  }
+  if (ptr == nullptr || nbytes == 0) return;
+#if defined(__linux__) && defined(SYS_move_pages)
+  const size_t page_size = page_nbytes();
+  const size_t batch = 1024;
+  size_t begin = reinterpret_cast<size_t>(ptr) / page_size;
+  size_t end = (reinterpret_cast<size_t>(ptr) + nbytes - 1) / page_size + 1;
+  std::vector<void*> pages(batch);
+  std::vector<int> status(batch);
+  for (size_t page = begin; page < end; page += batch) {
+    size_t count = (end - page < batch) ? end - page : batch;
+    for (size_t i = 0; i < count; ++i) {
+      pages[i] = reinterpret_cast<void*>((page + i) * page_size);
+    }
+    // with no target nodes move_pages reports the node of each page
+    if (syscall(SYS_move_pages, 0, count, pages.data(), nullptr, status.data(), 0) != 0) {
+      node_pages[nodes] += count;
+      continue;
+    }
+    for (size_t i = 0; i < count; ++i) {
+      int node = status[i];
+      node_pages[(node >= 0 && node < nodes) ? node : nodes] += 1;
+    }
+  }
+#else
+  node_pages[0] += (nbytes + page_nbytes() - 1) / page_nbytes();
+#endif
+}
+
+} // namespace numa
+
+} // namespace detail
+
+#endif // _UTILS_NUMA_HPP
@@ -0,0 +1,197 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#ifndef _UTILS_SHM_HPP
+#define _UTILS_SHM_HPP
+
+#include "config.hpp"
+
+#include <cstddef>
+#include <cstdint>
+#include <cstdio>
+#include <mutex>
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "utils_mpi.hpp"
+
+namespace detail {
+
+// posix shared memory segment mapped by every rank on a node
+namespace shm {
+
+// one segment per node split into a slice per rank on the node, each rank
+// allocates from its own slice and may read the slices of the others
+struct segment
+{
+  static segment& get()
+  {
+    static segment s;
+    return s;
+  }
+
+  // maps a segment with slice_nbytes per rank on each node, collective
+  // over comm, returns false if the segment could not be mapped
+  bool setup(
+#ifdef COMB_ENABLE_MPI
+             MPI_Comm comm,
+#endif
+             size_t slice_nbytes)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_base != nullptr) return true;
+
+    size_t page = 4096;
+#if defined(__linux__)
+    page = sysconf(_SC_PAGESIZE);
+#endif
+    m_slice_nbytes = (slice_nbytes + page - 1) / page * page;
+
+#ifdef COMB_ENABLE_MPI
+    MPI_Comm node_comm = MPI::Comm_split_type(comm, MPI_COMM_TYPE_SHARED, MPI::Comm_rank(comm));
+    m_node_rank = MPI::Comm_rank(node_comm);
+    m_node_size = MPI::Comm_size(node_comm);
+#else
+    m_node_rank = 0;
+    m_node_size = 1;
+#endif
+
+    int ok = 0;
+#if defined(__linux__)
+    size_t nbytes = m_slice_nbytes * m_node_size;
+
+    // the first rank on the node names and sizes the segment
+    char name[64] = "";
+    int fd = -1;
+    if (m_node_rank == 0) {
+      snprintf(name, sizeof(name), "/comb_shm_%ld", static_cast<long>(getpid()));
+      fd = shm_open(name, O_CREAT | O_EXCL | O_RDWR, 0600);
+      ok = (fd >= 0 && ftruncate(fd, nbytes) == 0) ? 1 : 0;
+    }
+#ifdef COMB_ENABLE_MPI
+    MPI::Bcast(name, sizeof(name), MPI_CHAR, 0, node_comm);
+    MPI::Bcast(&ok, 1, MPI_INT, 0, node_comm);
+#endif
+
+    if (ok && m_node_rank != 0) {
+      fd = shm_open(name, O_RDWR, 0600);
+      ok = (fd >= 0) ? 1 : 0;
+    }
+    if (ok) {
+      void* ptr = mmap(nullptr, nbytes, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+      if (ptr != MAP_FAILED) {
+        m_base = static_cast<char*>(ptr);
+      } else {
+        ok = 0;
+      }
+    }
+    if (fd >= 0) close(fd);
+
+    // every rank has the segment open so it can be unlinked
+#ifdef COMB_ENABLE_MPI
+    MPI::Barrier(node_comm);
+#endif
+    if (m_node_rank == 0 && name[0] != '\0') {
+      shm_unlink(name);
+    }
+#endif
+
+#ifdef COMB_ENABLE_MPI
+    MPI::Comm_free(&node_comm);
+
+    // use the segment only if every rank mapped it
+    int all_ok = 0;
+    MPI::Allreduce(&ok, &all_ok, 1, MPI_INT, MPI_MIN, comm);
+    ok = all_ok;
+#endif
+
+    if (!ok) {
+#if defined(__linux__)
+      if (m_base != nullptr) munmap(m_base, nbytes);
+#endif
+      m_base = nullptr;
+      m_slice_nbytes = 0;
+    }
+    m_bump = 0;
+    return ok != 0;
+  }
+
+  bool mapped() const { return m_base != nullptr; }
+  int node_rank() const { return m_node_rank; }
+  int node_size() const { return m_node_size; }
+  size_t slice_nbytes() const { return m_slice_nbytes; }
+  size_t used_nbytes() const { return m_bump; }
+
+  // start of the slice of a rank on this node
+  char* slice(int node_rank) const
+  {
+    return m_base + static_cast<size_t>(node_rank) * m_slice_nbytes;
+  }
+
+  // node rank whose slice contains ptr, -1 if ptr is not in the segment
+  int owner(void const* ptr) const
+  {
+    if (m_base == nullptr) return -1;
+    uintptr_t begin = reinterpret_cast<uintptr_t>(m_base);
+    uintptr_t p = reinterpret_cast<uintptr_t>(ptr);
+    if (p < begin || p >= begin + m_slice_nbytes * m_node_size) return -1;
+    return static_cast<int>((p - begin) / m_slice_nbytes);
+  }
+
+  // offset of ptr in the slice of its owner
+  size_t offset(void const* ptr) const
+  {
+    return (reinterpret_cast<uintptr_t>(ptr) - reinterpret_cast<uintptr_t>(m_base)) % m_slice_nbytes;
+  }
+
+  // carves nbytes off the slice of this rank, returns nullptr when the
+  // slice is full, memory is only returned when the segment is unmapped
+  void* bump(size_t nbytes, size_t align)
+  {
+    std::lock_guard<std::mutex> lock(m_mutex);
+    if (m_base == nullptr) return nullptr;
+    size_t begin = (m_bump + align - 1) / align * align;
+    if (begin + nbytes > m_slice_nbytes) return nullptr;
+    m_bump = begin + nbytes;
+    return slice(m_node_rank) + begin;
+  }
+
+  ~segment()
+  {
+#if defined(__linux__)
+    if (m_base != nullptr) {
+      munmap(m_base, m_slice_nbytes * m_node_size);
+    }
+#endif
+  }
+
+private:
+  std::mutex m_mutex;
+  char* m_base = nullptr;
+  size_t m_slice_nbytes = 0;
+  size_t m_bump = 0;
+  int m_node_rank = 0;
+  int m_node_size = 1;
+};
+
+} // namespace shm
+
+} // namespace detail
+
+#endif // _UTILS_SHM_HPP
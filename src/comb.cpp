@@ -114,6 +114,7 @@ int main(int argc, char** argv)
   int divisions[3] = {0, 0, 0};
   int periodic[3] = {0, 0, 0};
   IdxT ghost_widths[3] = {1, 1, 1};
+  IdxT pads[2] = {0, 0};
   IdxT num_vars = 1;
   IdxT ncycles = 5;
 
@@ -204,6 +205,10 @@ int main(int argc, char** argv)
                 comm_avail.mock = enabledisable;
 #ifdef COMB_ENABLE_MPI
                 comm_avail.mpi = enabledisable;
+                comm_avail.mpi_persistent = enabledisable;
+                comm_avail.mpi_neighbor = enabledisable;
+                comm_avail.mpi_rma = enabledisable;
+                comm_avail.mpi_shm = enabledisable;
 #endif
 #ifdef COMB_ENABLE_GDSYNC
                 comm_avail.gdsync = enabledisable;
@@ -222,6 +227,22 @@ int main(int argc, char** argv)
               } else if (strcmp(argv[i], "mpi") == 0) {
 #ifdef COMB_ENABLE_MPI
                 comm_avail.mpi = enabledisable;
+#endif
+              } else if (strcmp(argv[i], "mpi_persistent") == 0) {
+#ifdef COMB_ENABLE_MPI
+                comm_avail.mpi_persistent = enabledisable;
+#endif
+              } else if (strcmp(argv[i], "mpi_neighbor") == 0) {
+#ifdef COMB_ENABLE_MPI
+                comm_avail.mpi_neighbor = enabledisable;
+#endif
+              } else if (strcmp(argv[i], "mpi_rma") == 0) {
+#ifdef COMB_ENABLE_MPI
+                comm_avail.mpi_rma = enabledisable;
+#endif
+              } else if (strcmp(argv[i], "mpi_shm") == 0) {
+#ifdef COMB_ENABLE_MPI
+                comm_avail.mpi_shm = enabledisable;
 #endif
               } else if (strcmp(argv[i], "gdsync") == 0) {
 #ifdef COMB_ENABLE_GDSYNC
@@ -245,6 +266,92 @@ int main(int argc, char** argv)
             } else {
               fgprintf(FileGroup::err_master, "No argument to sub-option, ignoring %s %s.\n", argv[i-1], argv[i]);
             }
+          } else if (strcmp(argv[i], "pack_mode") == 0) {
+            if (i+1 < argc && argv[i+1][0] != '-') {
+              ++i;
+              if (strcmp(argv[i], "list") == 0) {
+                comb_pack_mode() = PackMode::list;
+              } else if (strcmp(argv[i], "box") == 0) {
+                comb_pack_mode() = PackMode::box;
+              } else if (strcmp(argv[i], "runs") == 0) {
+                comb_pack_mode() = PackMode::runs;
+              } else {
+                fgprintf(FileGroup::err_master, "Invalid argument to sub-option, ignoring %s %s %s.\n", argv[i-2], argv[i-1], argv[i]);
+              }
+            } else {
+              fgprintf(FileGroup::err_master, "No argument to sub-option, ignoring %s %s.\n", argv[i-1], argv[i]);
+            }
+          } else if (strcmp(argv[i], "pack_store") == 0) {
+            if (i+1 < argc && argv[i+1][0] != '-') {
+              ++i;
+              if (strcmp(argv[i], "cached") == 0) {
+                comb_pack_store() = PackStore::cached;
+              } else if (strcmp(argv[i], "streaming") == 0) {
+                comb_pack_store() = PackStore::streaming;
+              } else {
+                fgprintf(FileGroup::err_master, "Invalid argument to sub-option, ignoring %s %s %s.\n", argv[i-2], argv[i-1], argv[i]);
+              }
+            } else {
+              fgprintf(FileGroup::err_master, "No argument to sub-option, ignoring %s %s.\n", argv[i-1], argv[i]);
+            }
+          } else if (strcmp(argv[i], "buffer_layout") == 0) {
+            if (i+1 < argc && argv[i+1][0] != '-') {
+              ++i;
+              if (strcmp(argv[i], "variable") == 0) {
+                comb_buffer_layout() = BufferLayout::variable;
+              } else if (strcmp(argv[i], "zone") == 0) {
+                comb_buffer_layout() = BufferLayout::zone;
+              } else {
+                fgprintf(FileGroup::err_master, "Invalid argument to sub-option, ignoring %s %s %s.\n", argv[i-2], argv[i-1], argv[i]);
+              }
+            } else {
+              fgprintf(FileGroup::err_master, "No argument to sub-option, ignoring %s %s.\n", argv[i-1], argv[i]);
+            }
+          } else if (strcmp(argv[i], "wire_precision") == 0) {
+            if (i+1 < argc && argv[i+1][0] != '-') {
+              ++i;
+              if (strcmp(argv[i], "full") == 0) {
+                comb_wire_precision() = WirePrecision::full;
+              } else if (strcmp(argv[i], "float") == 0) {
+                comb_wire_precision() = WirePrecision::f32;
+              } else if (strcmp(argv[i], "bf16") == 0) {
+                comb_wire_precision() = WirePrecision::bf16;
+              } else {
+                fgprintf(FileGroup::err_master, "Invalid argument to sub-option, ignoring %s %s %s.\n", argv[i-2], argv[i-1], argv[i]);
+              }
+            } else {
+              fgprintf(FileGroup::err_master, "No argument to sub-option, ignoring %s %s.\n", argv[i-1], argv[i]);
+            }
+          } else if (strcmp(argv[i], "rma_sync") == 0) {
+            if (i+1 < argc && argv[i+1][0] != '-') {
+              ++i;
+              if (strcmp(argv[i], "fence") == 0) {
+                comb_rma_sync() = RmaSync::fence;
+              } else if (strcmp(argv[i], "pscw") == 0) {
+                comb_rma_sync() = RmaSync::pscw;
+              } else if (strcmp(argv[i], "passive") == 0) {
+                comb_rma_sync() = RmaSync::passive;
+              } else {
+                fgprintf(FileGroup::err_master, "Invalid argument to sub-option, ignoring %s %s %s.\n", argv[i-2], argv[i-1], argv[i]);
+              }
+            } else {
+              fgprintf(FileGroup::err_master, "No argument to sub-option, ignoring %s %s.\n", argv[i-1], argv[i]);
+            }
+          } else if (strcmp(argv[i], "compress") == 0) {
+            if (i+1 < argc && argv[i+1][0] != '-') {
+              ++i;
+              if (strcmp(argv[i], "none") == 0) {
+                comb_compression() = Compression::none;
+              } else if (strcmp(argv[i], "shuffle_rle") == 0) {
+                comb_compression() = Compression::shuffle_rle;
+              } else if (strcmp(argv[i], "lz") == 0) {
+                comb_compression() = Compression::lz;
+              } else {
+                fgprintf(FileGroup::err_master, "Invalid argument to sub-option, ignoring %s %s %s.\n", argv[i-2], argv[i-1], argv[i]);
+              }
+            } else {
+              fgprintf(FileGroup::err_master, "No argument to sub-option, ignoring %s %s.\n", argv[i-1], argv[i]);
+            }
           } else if ( strcmp(argv[i], "allow") == 0
                    || strcmp(argv[i], "disallow") == 0 ) {
             bool allowdisallow = false;
@@ -259,6 +366,16 @@ int main(int argc, char** argv)
                 comb_allow_per_message_pack_fusing() = allowdisallow;
               } else if (strcmp(argv[i], "message_group_pack_fusing") == 0) {
                 comb_allow_pack_loop_fusion() = allowdisallow;
+              } else if (strcmp(argv[i], "zero_copy") == 0) {
+                comb_allow_zero_copy() = allowdisallow;
+              } else if (strcmp(argv[i], "persistent_buffers") == 0) {
+                comb_allow_persistent_buffers() = allowdisallow;
+              } else if (strcmp(argv[i], "util_arena") == 0) {
+                comb_allow_util_arena() = allowdisallow;
+              } else if (strcmp(argv[i], "low_footprint") == 0) {
+                comb_allow_low_footprint() = allowdisallow;
+              } else if (strcmp(argv[i], "self_copy") == 0) {
+                comb_allow_self_copy() = allowdisallow;
               } else {
                 fgprintf(FileGroup::err_master, "Invalid argument to sub-option, ignoring %s %s %s.\n", argv[i-2], argv[i-1], argv[i]);
               }
@@ -289,6 +406,22 @@ int main(int argc, char** argv)
         } else {
           fgprintf(FileGroup::err_master, "No argument to option, ignoring %s.\n", argv[i]);
         }
+      } else if (strcmp(&argv[i][1], "pad") == 0) {
+        if (i+1 < argc && argv[i+1][0] != '-') {
+          long read_pads[2] {pads[0], pads[1]};
+          if (strcmp(argv[++i], "auto") == 0) {
+            pads[0] = -1;
+            pads[1] = -1;
+          } else if (sscanf(argv[i], "%ld_%ld", &read_pads[0], &read_pads[1]) == 2
+                  && read_pads[0] >= 0 && read_pads[1] >= 0) {
+            pads[0] = read_pads[0];
+            pads[1] = read_pads[1];
+          } else {
+            fgprintf(FileGroup::err_master, "Invalid argument to option, ignoring %s %s.\n", argv[i-1], argv[i]);
+          }
+        } else {
+          fgprintf(FileGroup::err_master, "No argument to option, ignoring %s.\n", argv[i]);
+        }
       } else if (strcmp(&argv[i][1], "exec") == 0) {
         if (i+1 < argc && argv[i+1][0] != '-') {
           ++i;
@@ -307,6 +440,7 @@ int main(int argc, char** argv)
   #ifdef COMB_ENABLE_OPENMP
                 exec_avail.omp = enabledisable;
   #endif
+                exec_avail.simd = enabledisable;
   #ifdef COMB_ENABLE_CUDA
                 exec_avail.cuda = enabledisable;
                 exec_avail.cuda_batch = enabledisable && cuda::batch_launch::available();
@@ -327,6 +461,8 @@ int main(int argc, char** argv)
   #ifdef COMB_ENABLE_OPENMP
                 exec_avail.omp = enabledisable;
   #endif
+              } else if (strcmp(argv[i], "simd") == 0) {
+                exec_avail.simd = enabledisable;
               } else if (strcmp(argv[i], "cuda") == 0) {
   #ifdef COMB_ENABLE_CUDA
                 exec_avail.cuda = enabledisable;
@@ -382,6 +518,12 @@ int main(int argc, char** argv)
               ++i;
               if (strcmp(argv[i], "all") == 0) {
                 alloc.host.m_available = enabledisable;
+                alloc.host_pool.m_available = enabledisable;
+                alloc.host_hugepage.m_available = enabledisable;
+                alloc.host_numa_interleave.m_available = enabledisable;
+                alloc.host_numa_local.m_available = enabledisable;
+                alloc.host_numa_first_touch.m_available = enabledisable;
+                alloc.host_shm.m_available = enabledisable;
   #ifdef COMB_ENABLE_CUDA
                 alloc.cuda_hostpinned.m_available = enabledisable;
                 alloc.cuda_device.m_available = enabledisable;
@@ -393,6 +535,18 @@ int main(int argc, char** argv)
   #endif
               } else if (strcmp(argv[i], "host") == 0) {
                 alloc.host.m_available = enabledisable;
+              } else if (strcmp(argv[i], "host_pool") == 0) {
+                alloc.host_pool.m_available = enabledisable;
+              } else if (strcmp(argv[i], "host_hugepage") == 0) {
+                alloc.host_hugepage.m_available = enabledisable;
+              } else if (strcmp(argv[i], "host_numa_interleave") == 0) {
+                alloc.host_numa_interleave.m_available = enabledisable;
+              } else if (strcmp(argv[i], "host_numa_local") == 0) {
+                alloc.host_numa_local.m_available = enabledisable;
+              } else if (strcmp(argv[i], "host_numa_first_touch") == 0) {
+                alloc.host_numa_first_touch.m_available = enabledisable;
+              } else if (strcmp(argv[i], "host_shm") == 0) {
+                alloc.host_shm.m_available = enabledisable;
               } else if (strcmp(argv[i], "cuda_hostpinned") == 0) {
   #ifdef COMB_ENABLE_CUDA
                 alloc.cuda_hostpinned.m_available = enabledisable;
@@ -435,10 +589,34 @@ int main(int argc, char** argv)
         }
       } else if (strcmp(&argv[i][1], "vars") == 0) {
         if (i+1 < argc && argv[i+1][0] != '-') {
-          long read_num_vars = num_vars;
-          int ret = sscanf(argv[++i], "%ld", &read_num_vars);
-          if (ret == 1) {
-            num_vars = read_num_vars;
+          // number of variables or comma separated counts and types, ex. 3d,2f
+          std::vector<ElemType> read_var_types;
+          const char* str = argv[++i];
+          bool valid = (*str != '\0');
+          while (valid && *str != '\0') {
+            char* end = nullptr;
+            long count = strtol(str, &end, 10);
+            ElemType type = ElemType::f64;
+            valid = (end != str && count >= 0);
+            if (valid) {
+              switch (*end) {
+                case 'd': type = ElemType::f64; ++end; break;
+                case 'f': type = ElemType::f32; ++end; break;
+                case 'i': type = ElemType::i32; ++end; break;
+                default: break;
+              }
+              if (*end == ',' && end[1] != '\0') {
+                ++end;
+              } else if (*end != '\0') {
+                valid = false;
+              }
+              read_var_types.insert(read_var_types.end(), count, type);
+            }
+            str = end;
+          }
+          if (valid) {
+            num_vars = read_var_types.size();
+            comb_var_types() = read_var_types;
           } else {
             fgprintf(FileGroup::err_master, "Invalid argument to option, ignoring %s %s.\n", argv[i-1], argv[i]);
           }
@@ -457,6 +635,18 @@ int main(int argc, char** argv)
         } else {
           fgprintf(FileGroup::err_master, "No argument to option, ignoring %s.\n", argv[i]);
         }
+      } else if (strcmp(&argv[i][1], "compressibility") == 0) {
+        if (i+1 < argc && argv[i+1][0] != '-') {
+          double read_compressibility = comb_compressibility();
+          int ret = sscanf(argv[++i], "%lf", &read_compressibility);
+          if (ret == 1 && read_compressibility >= 0.0 && read_compressibility <= 1.0) {
+            comb_compressibility() = read_compressibility;
+          } else {
+            fgprintf(FileGroup::err_master, "Invalid argument to option, ignoring %s %s.\n", argv[i-1], argv[i]);
+          }
+        } else {
+          fgprintf(FileGroup::err_master, "No argument to option, ignoring %s.\n", argv[i]);
+        }
       } else if (strcmp(&argv[i][1], "periodic") == 0) {
         if (i+1 < argc && argv[i+1][0] != '-') {
           long read_periodic[3] {periodic[0], periodic[1], periodic[2]};
@@ -547,6 +737,8 @@ int main(int argc, char** argv)
         do_print_packing_sizes = true;
       } else if (strcmp(&argv[i][1], "print_message_sizes") == 0) {
         do_print_message_sizes = true;
+      } else if (strcmp(&argv[i][1], "print_memory_stats") == 0) {
+        COMB::comb_memory_stats() = true;
       } else {
         fgprintf(FileGroup::err_master, "Unknown option, ignoring %s.\n", argv[i]);
       }
@@ -587,6 +779,11 @@ int main(int argc, char** argv)
     comminfo.abort();
   }
 
+  // low footprint items compute their indices from their box on the fly
+  if (comb_allow_low_footprint()) {
+    comb_pack_mode() = PackMode::box;
+  }
+
 #ifdef COMB_ENABLE_OPENMP
   // OMP setup
   {
@@ -633,8 +830,12 @@ int main(int argc, char** argv)
   }
 #endif // ifdef COMB_ENABLE_OPENMP
 
+  if (exec_avail.simd) {
+    fgprintf(FileGroup::all, "SIMD isa %s\n", detail::simd::isa_name());
+  }
+
 
-  GlobalMeshInfo global_info(sizes, comminfo.size, divisions, periodic, ghost_widths);
+  GlobalMeshInfo global_info(sizes, comminfo.size, divisions, periodic, ghost_widths, pads);
 
   // create cartesian communicator and get rank
   comminfo.cart.create(global_info.divisions, global_info.periodic);
@@ -651,6 +852,7 @@ int main(int argc, char** argv)
     long print_sizes[3]        = {global_info.sizes[0],       global_info.sizes[1],       global_info.sizes[2]      };
     long print_divisions[3]    = {comminfo.cart.divisions[0], comminfo.cart.divisions[1], comminfo.cart.divisions[2]};
     long print_periodic[3]     = {comminfo.cart.periodic[0],  comminfo.cart.periodic[1],  comminfo.cart.periodic[2] };
+    long print_strides[3]      = {info.stride[0],             info.stride[1],             info.stride[2]            };
 
     fgprintf(FileGroup::all, "Cart coords  %8li %8li %8li\n", print_coords[0],       print_coords[1],       print_coords[2]      );
     fgprintf(FileGroup::all, "Message policy cutoff %li\n",   print_cutoff                                                       );
@@ -658,12 +860,29 @@ int main(int argc, char** argv)
     fgprintf(FileGroup::all, "Post Send using %s method\n",   CommInfo::method_str(comminfo.post_send_method)                    );
     fgprintf(FileGroup::all, "Wait Recv using %s method\n",   CommInfo::method_str(comminfo.wait_recv_method)                    );
     fgprintf(FileGroup::all, "Wait Send using %s method\n",   CommInfo::method_str(comminfo.wait_send_method)                    );
+    fgprintf(FileGroup::all, "Pack mode %s\n",                pack_mode_str(comb_pack_mode())                                    );
+    fgprintf(FileGroup::all, "Pack store %s\n",               pack_store_str(comb_pack_store())                                  );
+    fgprintf(FileGroup::all, "Buffer layout %s\n",            buffer_layout_str(comb_buffer_layout())                            );
+    fgprintf(FileGroup::all, "Wire precision %s\n",           wire_precision_str(comb_wire_precision())                          );
+    fgprintf(FileGroup::all, "Compression %s\n",              compression_str(comb_compression())                                );
+    fgprintf(FileGroup::all, "RMA sync %s\n",                 rma_sync_str(comb_rma_sync())                                      );
+    fgprintf(FileGroup::all, "Persistent buffers %s\n",       comb_allow_persistent_buffers() ? "allowed" : "disallowed"          );
+    fgprintf(FileGroup::all, "Util arena %s\n",               comb_allow_util_arena() ? "allowed" : "disallowed"                  );
+    fgprintf(FileGroup::all, "Low footprint %s\n",            comb_allow_low_footprint() ? "allowed" : "disallowed"               );
+    fgprintf(FileGroup::all, "Self copy %s\n",                comb_allow_self_copy() ? "allowed" : "disallowed"                   );
+    fgprintf(FileGroup::all, "Compressibility %.3f\n",        comb_compressibility()                                             );
     fgprintf(FileGroup::all, "Num cycles   %8li\n",           print_ncycles                                                      );
     fgprintf(FileGroup::all, "Num vars     %8li\n",           print_num_vars                                                     );
+    fgprintf(FileGroup::all, "Var types   ");
+    for (IdxT vi = 0; vi < num_vars; ++vi) {
+      fgprintf(FileGroup::all, " %s", elem_type_str(comb_var_type(vi)));
+    }
+    fgprintf(FileGroup::all, "\n");
     fgprintf(FileGroup::all, "ghost_widths %8li %8li %8li\n", print_ghost_widths[0], print_ghost_widths[1], print_ghost_widths[2]);
     fgprintf(FileGroup::all, "sizes        %8li %8li %8li\n", print_sizes[0],        print_sizes[1],        print_sizes[2]       );
     fgprintf(FileGroup::all, "divisions    %8li %8li %8li\n", print_divisions[0],    print_divisions[1],    print_divisions[2]   );
     fgprintf(FileGroup::all, "periodic     %8li %8li %8li\n", print_periodic[0],     print_periodic[1],     print_periodic[2]    );
+    fgprintf(FileGroup::all, "strides      %8li %8li %8li\n", print_strides[0],      print_strides[1],      print_strides[2]     );
     fgprintf(FileGroup::all, "division map\n");
     // print division map
     IdxT max_cuts = std::max(std::max(comminfo.cart.divisions[0], comminfo.cart.divisions[1]), comminfo.cart.divisions[2]);
@@ -693,6 +912,25 @@ int main(int argc, char** argv)
 
   COMB::print_message_info(comminfo, info, alloc.host.allocator(), num_vars, do_print_packing_sizes, do_print_message_sizes);
 
+  if (alloc.host_shm.m_available) {
+    // each rank's slice fits the warm-up arrays and the mesh and buffers of
+    // a test, plus the arenas of the memory pool, pages are only used
+    // when touched
+    size_t slice_nbytes = 4 * (num_vars+1) * info.totallen * sizeof(double) + 128ull * 1024ull * 1024ull;
+    if (detail::shm::segment::get().setup(
+#ifdef COMB_ENABLE_MPI
+                                          MPI_COMM_WORLD,
+#endif
+                                          slice_nbytes)) {
+      fgprintf(FileGroup::all, "Shared memory segment node rank %i of %i slice %zu B\n",
+               detail::shm::segment::get().node_rank(), detail::shm::segment::get().node_size(),
+               detail::shm::segment::get().slice_nbytes());
+    } else {
+      fgprintf(FileGroup::err_master, "Could not map shared memory segment, disabling host_shm.\n");
+      alloc.host_shm.m_available = false;
+    }
+  }
+
   Timer tm(2*6*ncycles);
   Timer tm_total(1024);
 
@@ -703,6 +941,10 @@ int main(int argc, char** argv)
 
   COMB::test_copy(comminfo, exec, alloc, exec_avail, tm, num_vars, info.totallen, ncycles);
 
+  COMB::test_pack(comminfo, info, exec, alloc, exec_avail, tm, num_vars, ncycles);
+
+  COMB::test_mempool(comminfo, info, exec, alloc, tm, num_vars, ncycles);
+
   if (do_basic_only) {
 
     COMB::test_cycles_basic(comminfo, info, exec, alloc, exec_avail, num_vars, ncycles, tm, tm_total);
@@ -715,6 +957,18 @@ int main(int argc, char** argv)
 #ifdef COMB_ENABLE_MPI
     if (comm_avail.mpi)
       COMB::test_cycles_mpi(comminfo, info, exec, alloc, exec_avail, num_vars, ncycles, tm, tm_total);
+
+    if (comm_avail.mpi_persistent)
+      COMB::test_cycles_mpi_persistent(comminfo, info, exec, alloc, exec_avail, num_vars, ncycles, tm, tm_total);
+
+    if (comm_avail.mpi_neighbor)
+      COMB::test_cycles_mpi_neighbor(comminfo, info, exec, alloc, exec_avail, num_vars, ncycles, tm, tm_total);
+
+    if (comm_avail.mpi_rma)
+      COMB::test_cycles_mpi_rma(comminfo, info, exec, alloc, exec_avail, num_vars, ncycles, tm, tm_total);
+
+    if (comm_avail.mpi_shm)
+      COMB::test_cycles_mpi_shm(comminfo, info, exec, alloc, exec_avail, num_vars, ncycles, tm, tm_total);
 #endif
 
 #ifdef COMB_ENABLE_GDSYNC
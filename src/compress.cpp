@@ -0,0 +1,362 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "config.hpp"
+
+#include "compress.hpp"
+
+#include <cassert>
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
+
+namespace COMB {
+
+namespace {
+
+// run-length encoding in the style of PackBits,
+// control bytes below 128 are followed by control+1 literal bytes,
+// control bytes of 128 or more are followed by one byte repeated control-125 times
+const IdxT rle_max_literal = 128;
+const IdxT rle_min_repeat  = 3;
+const IdxT rle_max_repeat  = 130;
+
+IdxT rle_max_nbytes(IdxT nbytes)
+{
+  return nbytes + (nbytes + rle_max_literal - 1) / rle_max_literal;
+}
+
+IdxT rle_encode(const unsigned char* src, IdxT nbytes, unsigned char* dst)
+{
+  IdxT out = 0;
+  IdxT i = 0;
+  while (i < nbytes) {
+    IdxT run = 1;
+    while (i + run < nbytes && run < rle_max_repeat && src[i + run] == src[i]) {
+      ++run;
+    }
+    if (run >= rle_min_repeat) {
+      dst[out++] = static_cast<unsigned char>(run + 125);
+      dst[out++] = src[i];
+      i += run;
+    } else {
+      IdxT j = i;
+      while (j < nbytes && j - i < rle_max_literal) {
+        if (j + 2 < nbytes && src[j] == src[j+1] && src[j] == src[j+2]) break;
+        ++j;
+      }
+      dst[out++] = static_cast<unsigned char>(j - i - 1);
+      memcpy(dst + out, src + i, j - i);
+      out += j - i;
+      i = j;
+    }
+  }
+  return out;
+}
+
+void rle_decode(const unsigned char* src, IdxT compressed_nbytes, unsigned char* dst, IdxT nbytes)
+{
+  IdxT out = 0;
+  IdxT i = 0;
+  while (i < compressed_nbytes) {
+    IdxT control = src[i++];
+    if (control < rle_max_literal) {
+      IdxT len = control + 1;
+      assert(out + len <= nbytes);
+      memcpy(dst + out, src + i, len);
+      i += len;
+      out += len;
+    } else {
+      IdxT len = control - 125;
+      assert(out + len <= nbytes);
+      memset(dst + out, src[i++], len);
+      out += len;
+    }
+  }
+  assert(out == nbytes);
+  COMB::ignore_unused(nbytes);
+}
+
+// groups byte b of every element together so the slowly varying
+// bytes of similar values form long runs
+void shuffle(const unsigned char* src, IdxT nbytes, IdxT elem_size, unsigned char* dst)
+{
+  IdxT nelems = nbytes / elem_size;
+  for (IdxT b = 0; b < elem_size; ++b) {
+    for (IdxT e = 0; e < nelems; ++e) {
+      dst[b*nelems + e] = src[e*elem_size + b];
+    }
+  }
+  IdxT tail = nelems * elem_size;
+  memcpy(dst + tail, src + tail, nbytes - tail);
+}
+
+void unshuffle(const unsigned char* src, IdxT nbytes, IdxT elem_size, unsigned char* dst)
+{
+  IdxT nelems = nbytes / elem_size;
+  for (IdxT b = 0; b < elem_size; ++b) {
+    for (IdxT e = 0; e < nelems; ++e) {
+      dst[e*elem_size + b] = src[b*nelems + e];
+    }
+  }
+  IdxT tail = nelems * elem_size;
+  memcpy(dst + tail, src + tail, nbytes - tail);
+}
+
+struct ShuffleRleCodec : Codec
+{
+  IdxT m_elem_size;
+  std::vector<unsigned char> m_scratch;
+
+  ShuffleRleCodec(IdxT elem_size)
+    : m_elem_size(elem_size > 0 ? elem_size : 1)
+  { }
+
+  const char* name() override { return "shuffle_rle"; }
+
+  IdxT max_compressed_nbytes(IdxT nbytes) override
+  {
+    return rle_max_nbytes(nbytes);
+  }
+
+  IdxT compress(const char* src, IdxT nbytes, char* dst) override
+  {
+    m_scratch.resize(nbytes);
+    shuffle(reinterpret_cast<const unsigned char*>(src), nbytes, m_elem_size, m_scratch.data());
+    return rle_encode(m_scratch.data(), nbytes, reinterpret_cast<unsigned char*>(dst));
+  }
+
+  void decompress(const char* src, IdxT compressed_nbytes, char* dst, IdxT nbytes) override
+  {
+    m_scratch.resize(nbytes);
+    rle_decode(reinterpret_cast<const unsigned char*>(src), compressed_nbytes, m_scratch.data(), nbytes);
+    unshuffle(m_scratch.data(), nbytes, m_elem_size, reinterpret_cast<unsigned char*>(dst));
+  }
+};
+
+// block format in the style of LZ4, each sequence is a token whose high
+// nibble is the literal length and low nibble is the match length - 4,
+// nibbles of 15 are extended by following bytes summed until one is not 255,
+// then the literals, then a 2 byte little endian match offset,
+// the last sequence has only literals
+const IdxT lz_hash_bits   = 12;
+const IdxT lz_min_match   = 4;
+const IdxT lz_max_offset  = 65535;
+
+uint32_t read32(const unsigned char* p)
+{
+  uint32_t val;
+  memcpy(&val, p, sizeof(uint32_t));
+  return val;
+}
+
+unsigned char* lz_write_length(unsigned char* out, IdxT len)
+{
+  while (len >= 255) {
+    *out++ = 255;
+    len -= 255;
+  }
+  *out++ = static_cast<unsigned char>(len);
+  return out;
+}
+
+IdxT lz_read_length(const unsigned char* src, IdxT& i, IdxT len)
+{
+  if (len == 15) {
+    unsigned char b;
+    do {
+      b = src[i++];
+      len += b;
+    } while (b == 255);
+  }
+  return len;
+}
+
+struct LzCodec : Codec
+{
+  std::vector<IdxT> m_table;
+
+  LzCodec()
+    : m_table(IdxT(1) << lz_hash_bits)
+  { }
+
+  const char* name() override { return "lz"; }
+
+  IdxT max_compressed_nbytes(IdxT nbytes) override
+  {
+    return nbytes + nbytes / 255 + 16;
+  }
+
+  unsigned char* write_sequence(unsigned char* out, const unsigned char* literals, IdxT num_literals, IdxT offset, IdxT match_len)
+  {
+    IdxT lit_nibble   = (num_literals < 15) ? num_literals : 15;
+    IdxT match_nibble = 0;
+    if (match_len > 0) {
+      match_len -= lz_min_match;
+      match_nibble = (match_len < 15) ? match_len : 15;
+    }
+    *out++ = static_cast<unsigned char>((lit_nibble << 4) | match_nibble);
+    if (lit_nibble == 15) out = lz_write_length(out, num_literals - 15);
+    memcpy(out, literals, num_literals);
+    out += num_literals;
+    if (offset > 0) {
+      *out++ = static_cast<unsigned char>(offset & 0xff);
+      *out++ = static_cast<unsigned char>(offset >> 8);
+      if (match_nibble == 15) out = lz_write_length(out, match_len - 15);
+    }
+    return out;
+  }
+
+  IdxT compress(const char* src_, IdxT nbytes, char* dst_) override
+  {
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(src_);
+    unsigned char* dst = reinterpret_cast<unsigned char*>(dst_);
+    unsigned char* out = dst;
+
+    std::fill(m_table.begin(), m_table.end(), IdxT(-1));
+
+    IdxT anchor = 0;
+    IdxT i = 0;
+    while (i + lz_min_match <= nbytes) {
+      uint32_t seq = read32(src + i);
+      IdxT h = static_cast<IdxT>((seq * 2654435761u) >> (32 - lz_hash_bits));
+      IdxT ref = m_table[h];
+      m_table[h] = i;
+      if (ref >= 0 && i - ref <= lz_max_offset && read32(src + ref) == seq) {
+        IdxT len = lz_min_match;
+        while (i + len < nbytes && src[ref + len] == src[i + len]) {
+          ++len;
+        }
+        out = write_sequence(out, src + anchor, i - anchor, i - ref, len);
+        i += len;
+        anchor = i;
+      } else {
+        ++i;
+      }
+    }
+    out = write_sequence(out, src + anchor, nbytes - anchor, 0, 0);
+
+    return static_cast<IdxT>(out - dst);
+  }
+
+  void decompress(const char* src_, IdxT compressed_nbytes, char* dst_, IdxT nbytes) override
+  {
+    const unsigned char* src = reinterpret_cast<const unsigned char*>(src_);
+    unsigned char* dst = reinterpret_cast<unsigned char*>(dst_);
+
+    IdxT out = 0;
+    IdxT i = 0;
+    while (i < compressed_nbytes) {
+      IdxT token = src[i++];
+      IdxT num_literals = lz_read_length(src, i, token >> 4);
+      assert(out + num_literals <= nbytes);
+      memcpy(dst + out, src + i, num_literals);
+      i += num_literals;
+      out += num_literals;
+      if (i >= compressed_nbytes) break;
+      IdxT offset = src[i] | (src[i+1] << 8);
+      i += 2;
+      IdxT match_len = lz_read_length(src, i, token & 15) + lz_min_match;
+      assert(offset > 0 && offset <= out);
+      assert(out + match_len <= nbytes);
+      // matches may overlap the bytes they produce
+      for (IdxT m = 0; m < match_len; ++m) {
+        dst[out + m] = dst[out - offset + m];
+      }
+      out += match_len;
+    }
+    assert(out == nbytes);
+    COMB::ignore_unused(nbytes);
+  }
+};
+
+struct compressed_header
+{
+  IdxT nbytes; // bytes following the header
+  IdxT raw;    // non-zero if the payload is the uncompressed buffer
+};
+
+double time_since(std::chrono::high_resolution_clock::time_point t0)
+{
+  return std::chrono::duration<double>(std::chrono::high_resolution_clock::now() - t0).count();
+}
+
+} // namespace
+
+std::unique_ptr<Codec> make_codec(Compression compression, IdxT elem_size)
+{
+  std::unique_ptr<Codec> codec;
+  switch (compression) {
+    case Compression::none: break;
+    case Compression::shuffle_rle: codec.reset(new ShuffleRleCodec(elem_size)); break;
+    case Compression::lz:          codec.reset(new LzCodec()); break;
+  }
+  return codec;
+}
+
+IdxT compressed_message_max_nbytes(Codec& codec, IdxT nbytes)
+{
+  return sizeof(compressed_header) + std::max(codec.max_compressed_nbytes(nbytes), nbytes);
+}
+
+IdxT compress_message(Codec& codec, const void* buf, IdxT nbytes, void* zbuf)
+{
+  auto t0 = std::chrono::high_resolution_clock::now();
+
+  compressed_header header;
+  char* payload = static_cast<char*>(zbuf) + sizeof(compressed_header);
+
+  header.nbytes = codec.compress(static_cast<const char*>(buf), nbytes, payload);
+  header.raw = 0;
+  if (header.nbytes >= nbytes) {
+    memcpy(payload, buf, nbytes);
+    header.nbytes = nbytes;
+    header.raw = 1;
+  }
+  memcpy(zbuf, &header, sizeof(compressed_header));
+
+  IdxT zbuf_nbytes = sizeof(compressed_header) + header.nbytes;
+
+  CompressionStats& stats = comb_compression_stats();
+  stats.compress_time += time_since(t0);
+  stats.raw_nbytes += nbytes;
+  stats.compressed_nbytes += zbuf_nbytes;
+  stats.num_compressed += 1;
+
+  return zbuf_nbytes;
+}
+
+void decompress_message(Codec& codec, const void* zbuf, void* buf, IdxT nbytes)
+{
+  auto t0 = std::chrono::high_resolution_clock::now();
+
+  compressed_header header;
+  memcpy(&header, zbuf, sizeof(compressed_header));
+  const char* payload = static_cast<const char*>(zbuf) + sizeof(compressed_header);
+
+  if (header.raw) {
+    assert(header.nbytes == nbytes);
+    memcpy(buf, payload, nbytes);
+  } else {
+    codec.decompress(payload, header.nbytes, static_cast<char*>(buf), nbytes);
+  }
+
+  CompressionStats& stats = comb_compression_stats();
+  stats.decompress_time += time_since(t0);
+  stats.num_decompressed += 1;
+}
+
+} // namespace COMB
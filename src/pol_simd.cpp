@@ -0,0 +1,408 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "config.hpp"
+
+#include "for_all.hpp"
+
+#include <cstdint>
+#include <type_traits>
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#define COMB_SIMD_X86
+#include <immintrin.h>
+#endif
+
+namespace detail {
+
+namespace simd {
+
+namespace {
+
+void gather_scalar(DataT* dst, DataT const* src, LidxT const* idx, IdxT len)
+{
+  for (IdxT i = 0; i < len; ++i) {
+    dst[i] = src[idx[i]];
+  }
+}
+
+void scatter_scalar(DataT* dst, LidxT const* idx, DataT const* src, IdxT len)
+{
+  for (IdxT i = 0; i < len; ++i) {
+    dst[idx[i]] = src[i];
+  }
+}
+
+void copy_scalar(DataT* dst, DataT const* src, IdxT len)
+{
+  for (IdxT i = 0; i < len; ++i) {
+    dst[i] = src[i];
+  }
+}
+
+// indexed zones this many iterations ahead are prefetched
+const IdxT prefetch_distance = 16;
+
+void gather_stream_scalar(DataT* dst, DataT const* src, LidxT const* idx, IdxT len)
+{
+  for (IdxT i = 0; i < len; ++i) {
+    if (i + prefetch_distance < len) {
+      __builtin_prefetch(src + idx[i + prefetch_distance], 0);
+    }
+    dst[i] = src[idx[i]];
+  }
+}
+
+void scatter_prefetch_scalar(DataT* dst, LidxT const* idx, DataT const* src, IdxT len)
+{
+  for (IdxT i = 0; i < len; ++i) {
+    if (i + prefetch_distance < len) {
+      __builtin_prefetch(dst + idx[i + prefetch_distance], 1);
+    }
+    dst[idx[i]] = src[i];
+  }
+}
+
+#ifdef COMB_SIMD_X86
+
+// the vector kernels are written for double data and int indices
+static_assert(std::is_same<DataT, double>::value, "simd kernels expect double data");
+static_assert(std::is_same<LidxT, int>::value,    "simd kernels expect int indices");
+
+// vectors of consecutive indices are copied with contiguous loads and stores
+
+__attribute__((target("avx2")))
+void gather_avx2(DataT* dst, DataT const* src, LidxT const* idx, IdxT len)
+{
+  const __m128i step = _mm_setr_epi32(0, 1, 2, 3);
+  IdxT i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128i vidx = _mm_loadu_si128(reinterpret_cast<__m128i const*>(idx + i));
+    __m128i vrun = _mm_add_epi32(_mm_set1_epi32(idx[i]), step);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(vidx, vrun)) == 0xFFFF) {
+      _mm256_storeu_pd(dst + i, _mm256_loadu_pd(src + idx[i]));
+    } else {
+      _mm256_storeu_pd(dst + i, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), src, vidx,
+                                                         _mm256_castsi256_pd(_mm256_set1_epi64x(-1)),
+                                                         sizeof(DataT)));
+    }
+  }
+  for (; i < len; ++i) {
+    dst[i] = src[idx[i]];
+  }
+}
+
+// avx2 has no scatter, non-consecutive indices are stored one at a time
+__attribute__((target("avx2")))
+void scatter_avx2(DataT* dst, LidxT const* idx, DataT const* src, IdxT len)
+{
+  const __m128i step = _mm_setr_epi32(0, 1, 2, 3);
+  IdxT i = 0;
+  for (; i + 4 <= len; i += 4) {
+    __m128i vidx = _mm_loadu_si128(reinterpret_cast<__m128i const*>(idx + i));
+    __m128i vrun = _mm_add_epi32(_mm_set1_epi32(idx[i]), step);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(vidx, vrun)) == 0xFFFF) {
+      _mm256_storeu_pd(dst + idx[i], _mm256_loadu_pd(src + i));
+    } else {
+      dst[idx[i+0]] = src[i+0];
+      dst[idx[i+1]] = src[i+1];
+      dst[idx[i+2]] = src[i+2];
+      dst[idx[i+3]] = src[i+3];
+    }
+  }
+  for (; i < len; ++i) {
+    dst[idx[i]] = src[i];
+  }
+}
+
+__attribute__((target("avx2")))
+void copy_avx2(DataT* dst, DataT const* src, IdxT len)
+{
+  IdxT i = 0;
+  for (; i + 4 <= len; i += 4) {
+    _mm256_storeu_pd(dst + i, _mm256_loadu_pd(src + i));
+  }
+  for (; i < len; ++i) {
+    dst[i] = src[i];
+  }
+}
+
+// the streaming kernels store until dst is aligned then stream whole vectors,
+// a vector of indices that is not one run is prefetched lane by lane
+
+__attribute__((target("avx2")))
+void prefetch_lanes_avx2(DataT const* src, LidxT const* idx, int hint_write)
+{
+  if (idx[3] == idx[0] + 3) {
+    if (hint_write) __builtin_prefetch(src + idx[0], 1); else __builtin_prefetch(src + idx[0], 0);
+  } else {
+    for (IdxT l = 0; l < 4; ++l) {
+      if (hint_write) __builtin_prefetch(src + idx[l], 1); else __builtin_prefetch(src + idx[l], 0);
+    }
+  }
+}
+
+__attribute__((target("avx2")))
+void gather_stream_avx2(DataT* dst, DataT const* src, LidxT const* idx, IdxT len)
+{
+  IdxT i = 0;
+  for (; i < len && (reinterpret_cast<uintptr_t>(dst + i) & 31) != 0; ++i) {
+    dst[i] = src[idx[i]];
+  }
+  const __m128i step = _mm_setr_epi32(0, 1, 2, 3);
+  for (; i + 4 <= len; i += 4) {
+    if (i + prefetch_distance + 4 <= len) {
+      prefetch_lanes_avx2(src, idx + i + prefetch_distance, 0);
+    }
+    __m128i vidx = _mm_loadu_si128(reinterpret_cast<__m128i const*>(idx + i));
+    __m128i vrun = _mm_add_epi32(_mm_set1_epi32(idx[i]), step);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(vidx, vrun)) == 0xFFFF) {
+      _mm256_stream_pd(dst + i, _mm256_loadu_pd(src + idx[i]));
+    } else {
+      _mm256_stream_pd(dst + i, _mm256_mask_i32gather_pd(_mm256_setzero_pd(), src, vidx,
+                                                          _mm256_castsi256_pd(_mm256_set1_epi64x(-1)),
+                                                          sizeof(DataT)));
+    }
+  }
+  for (; i < len; ++i) {
+    dst[i] = src[idx[i]];
+  }
+}
+
+__attribute__((target("avx2")))
+void scatter_prefetch_avx2(DataT* dst, LidxT const* idx, DataT const* src, IdxT len)
+{
+  const __m128i step = _mm_setr_epi32(0, 1, 2, 3);
+  IdxT i = 0;
+  for (; i + 4 <= len; i += 4) {
+    if (i + prefetch_distance + 4 <= len) {
+      prefetch_lanes_avx2(dst, idx + i + prefetch_distance, 1);
+    }
+    __m128i vidx = _mm_loadu_si128(reinterpret_cast<__m128i const*>(idx + i));
+    __m128i vrun = _mm_add_epi32(_mm_set1_epi32(idx[i]), step);
+    if (_mm_movemask_epi8(_mm_cmpeq_epi32(vidx, vrun)) == 0xFFFF) {
+      _mm256_storeu_pd(dst + idx[i], _mm256_loadu_pd(src + i));
+    } else {
+      dst[idx[i+0]] = src[i+0];
+      dst[idx[i+1]] = src[i+1];
+      dst[idx[i+2]] = src[i+2];
+      dst[idx[i+3]] = src[i+3];
+    }
+  }
+  for (; i < len; ++i) {
+    dst[idx[i]] = src[i];
+  }
+}
+
+__attribute__((target("avx2")))
+void copy_stream_avx2(DataT* dst, DataT const* src, IdxT len)
+{
+  IdxT i = 0;
+  for (; i < len && (reinterpret_cast<uintptr_t>(dst + i) & 31) != 0; ++i) {
+    dst[i] = src[i];
+  }
+  for (; i + 4 <= len; i += 4) {
+    _mm256_stream_pd(dst + i, _mm256_loadu_pd(src + i));
+  }
+  for (; i < len; ++i) {
+    dst[i] = src[i];
+  }
+}
+
+__attribute__((target("avx512f")))
+void gather_avx512(DataT* dst, DataT const* src, LidxT const* idx, IdxT len)
+{
+  const __m256i step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  IdxT i = 0;
+  for (; i + 8 <= len; i += 8) {
+    __m256i vidx = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx + i));
+    __m256i vrun = _mm256_add_epi32(_mm256_set1_epi32(idx[i]), step);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(vidx, vrun)) == -1) {
+      _mm512_storeu_pd(dst + i, _mm512_loadu_pd(src + idx[i]));
+    } else {
+      _mm512_storeu_pd(dst + i, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, vidx, src, sizeof(DataT)));
+    }
+  }
+  gather_avx2(dst + i, src, idx + i, len - i);
+}
+
+__attribute__((target("avx512f")))
+void scatter_avx512(DataT* dst, LidxT const* idx, DataT const* src, IdxT len)
+{
+  const __m256i step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  IdxT i = 0;
+  for (; i + 8 <= len; i += 8) {
+    __m256i vidx = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx + i));
+    __m256i vrun = _mm256_add_epi32(_mm256_set1_epi32(idx[i]), step);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(vidx, vrun)) == -1) {
+      _mm512_storeu_pd(dst + idx[i], _mm512_loadu_pd(src + i));
+    } else {
+      _mm512_i32scatter_pd(dst, vidx, _mm512_loadu_pd(src + i), sizeof(DataT));
+    }
+  }
+  scatter_avx2(dst, idx + i, src + i, len - i);
+}
+
+__attribute__((target("avx512f")))
+void copy_avx512(DataT* dst, DataT const* src, IdxT len)
+{
+  IdxT i = 0;
+  for (; i + 8 <= len; i += 8) {
+    _mm512_storeu_pd(dst + i, _mm512_loadu_pd(src + i));
+  }
+  copy_avx2(dst + i, src + i, len - i);
+}
+
+__attribute__((target("avx512f")))
+void gather_stream_avx512(DataT* dst, DataT const* src, LidxT const* idx, IdxT len)
+{
+  IdxT i = 0;
+  for (; i < len && (reinterpret_cast<uintptr_t>(dst + i) & 63) != 0; ++i) {
+    dst[i] = src[idx[i]];
+  }
+  const __m256i step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  for (; i + 8 <= len; i += 8) {
+    if (i + prefetch_distance + 8 <= len) {
+      prefetch_lanes_avx2(src, idx + i + prefetch_distance,     0);
+      prefetch_lanes_avx2(src, idx + i + prefetch_distance + 4, 0);
+    }
+    __m256i vidx = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx + i));
+    __m256i vrun = _mm256_add_epi32(_mm256_set1_epi32(idx[i]), step);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(vidx, vrun)) == -1) {
+      _mm512_stream_pd(dst + i, _mm512_loadu_pd(src + idx[i]));
+    } else {
+      _mm512_stream_pd(dst + i, _mm512_mask_i32gather_pd(_mm512_setzero_pd(), 0xFF, vidx, src, sizeof(DataT)));
+    }
+  }
+  gather_stream_avx2(dst + i, src, idx + i, len - i);
+}
+
+__attribute__((target("avx512f")))
+void scatter_prefetch_avx512(DataT* dst, LidxT const* idx, DataT const* src, IdxT len)
+{
+  const __m256i step = _mm256_setr_epi32(0, 1, 2, 3, 4, 5, 6, 7);
+  IdxT i = 0;
+  for (; i + 8 <= len; i += 8) {
+    if (i + prefetch_distance + 8 <= len) {
+      prefetch_lanes_avx2(dst, idx + i + prefetch_distance,     1);
+      prefetch_lanes_avx2(dst, idx + i + prefetch_distance + 4, 1);
+    }
+    __m256i vidx = _mm256_loadu_si256(reinterpret_cast<__m256i const*>(idx + i));
+    __m256i vrun = _mm256_add_epi32(_mm256_set1_epi32(idx[i]), step);
+    if (_mm256_movemask_epi8(_mm256_cmpeq_epi32(vidx, vrun)) == -1) {
+      _mm512_storeu_pd(dst + idx[i], _mm512_loadu_pd(src + i));
+    } else {
+      _mm512_i32scatter_pd(dst, vidx, _mm512_loadu_pd(src + i), sizeof(DataT));
+    }
+  }
+  scatter_prefetch_avx2(dst, idx + i, src + i, len - i);
+}
+
+__attribute__((target("avx512f")))
+void copy_stream_avx512(DataT* dst, DataT const* src, IdxT len)
+{
+  IdxT i = 0;
+  for (; i < len && (reinterpret_cast<uintptr_t>(dst + i) & 63) != 0; ++i) {
+    dst[i] = src[i];
+  }
+  for (; i + 8 <= len; i += 8) {
+    _mm512_stream_pd(dst + i, _mm512_loadu_pd(src + i));
+  }
+  copy_stream_avx2(dst + i, src + i, len - i);
+}
+
+#endif
+
+struct kernels
+{
+  const char* name;
+  void (*gather)(DataT*, DataT const*, LidxT const*, IdxT);
+  void (*scatter)(DataT*, LidxT const*, DataT const*, IdxT);
+  void (*copy)(DataT*, DataT const*, IdxT);
+  void (*gather_stream)(DataT*, DataT const*, LidxT const*, IdxT);
+  void (*scatter_prefetch)(DataT*, LidxT const*, DataT const*, IdxT);
+  void (*copy_stream)(DataT*, DataT const*, IdxT);
+};
+
+kernels select_kernels()
+{
+#ifdef COMB_SIMD_X86
+  __builtin_cpu_init();
+  if (__builtin_cpu_supports("avx512f") && __builtin_cpu_supports("avx2")) {
+    return kernels{"avx512", &gather_avx512, &scatter_avx512, &copy_avx512,
+                   &gather_stream_avx512, &scatter_prefetch_avx512, &copy_stream_avx512};
+  }
+  if (__builtin_cpu_supports("avx2")) {
+    return kernels{"avx2", &gather_avx2, &scatter_avx2, &copy_avx2,
+                   &gather_stream_avx2, &scatter_prefetch_avx2, &copy_stream_avx2};
+  }
+#endif
+  return kernels{"scalar", &gather_scalar, &scatter_scalar, &copy_scalar,
+                 &gather_stream_scalar, &scatter_prefetch_scalar, &copy_scalar};
+}
+
+kernels const& get_kernels()
+{
+  static const kernels k = select_kernels();
+  return k;
+}
+
+} // namespace
+
+const char* isa_name()
+{
+  return get_kernels().name;
+}
+
+void gather(DataT* dst, DataT const* src, LidxT const* idx, IdxT len)
+{
+  get_kernels().gather(dst, src, idx, len);
+}
+
+void scatter(DataT* dst, LidxT const* idx, DataT const* src, IdxT len)
+{
+  get_kernels().scatter(dst, idx, src, len);
+}
+
+void copy(DataT* dst, DataT const* src, IdxT len)
+{
+  get_kernels().copy(dst, src, len);
+}
+
+void store_fence()
+{
+#ifdef COMB_SIMD_X86
+  _mm_sfence();
+#endif
+}
+
+void gather_stream(DataT* dst, DataT const* src, LidxT const* idx, IdxT len)
+{
+  get_kernels().gather_stream(dst, src, idx, len);
+}
+
+void scatter_prefetch(DataT* dst, LidxT const* idx, DataT const* src, IdxT len)
+{
+  get_kernels().scatter_prefetch(dst, idx, src, len);
+}
+
+void copy_stream(DataT* dst, DataT const* src, IdxT len)
+{
+  get_kernels().copy_stream(dst, src, len);
+}
+
+} // namespace simd
+
+} // namespace detail
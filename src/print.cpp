@@ -15,13 +15,11 @@
 
 #include "print.hpp"
 #include "utils_mpi.hpp"
-#include "utils_cuda.hpp"
 
 #include <cassert>
 #include <cstdlib>
 #include <cstdio>
 #include <cstdarg>
-#include <vector>
 
 int mpi_rank = 0;
 FILE* comb_out_file = stdout;
@@ -162,36 +160,3 @@ void fgprintf(FileGroup fg, const char* fmt, ...)
 
   free(msg);
 }
-
-void print_proc_memory_stats()
-{
-  // print /proc/self/stat to per proc file
-  std::vector<char> stat;
-  const char fstat_name[] = "/proc/self/stat";
-  FILE* fstat = fopen(fstat_name, "r");
-  if (fstat) {
-    // fprintf(f, "%s ", fstat_name);
-    int c = fgetc(fstat);
-    int clast = c;
-    while(c != EOF) {
-      stat.push_back(c);
-      // fputc(c, f);
-      clast = c;
-      c = fgetc(fstat);
-    }
-    fclose(fstat);
-    if (clast != '\n') {
-      stat.push_back('\n');
-      // fprintf(f, "\n");
-    }
-    stat.push_back('\0');
-  }
-  fgprintf(FileGroup::proc, "/proc/self/stat: %s", &stat[0]);
-
-#if defined(COMB_ENABLE_CUDA)
-  // print cuda device memory usage to per proc file
-  size_t free_mem, total_mem;
-  cudaCheck(cudaMemGetInfo(&free_mem, &total_mem));
-  fgprintf(FileGroup::proc, "cuda device memory usage: %12zu\n", total_mem - free_mem);
-#endif
-}
@@ -96,13 +96,220 @@ void print_timer(CommInfo& comminfo, Timer& tm, const char* prefix) {
   delete[] nums;
 }
 
+// prints the compression ratio, codec times, and the bandwidth of the
+// uncompressed messages over the time spent posting and waiting on messages
+void print_compression(CommInfo& comminfo, Timer& tm)
+{
+  CompressionStats& stats = comb_compression_stats();
+
+  double comm_time = 0.0;
+  for (auto& stat : tm.getStats()) {
+    if (stat.name == "post-recv" || stat.name == "post-send" ||
+        stat.name == "wait-recv" || stat.name == "wait-send") {
+      comm_time += stat.sum;
+    }
+  }
+
+  double sums[4] = {stats.raw_nbytes, stats.compressed_nbytes, stats.compress_time, stats.decompress_time};
+  long   nums[2] = {stats.num_compressed, stats.num_decompressed};
+
+  double final_sums[4] = {0.0, 0.0, 0.0, 0.0};
+  long   final_nums[2] = {0, 0};
+  double final_comm_time = 0.0;
+
+#ifdef COMB_ENABLE_MPI
+  MPI_Reduce(sums, final_sums, 4, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(nums, final_nums, 2, MPI_LONG,   MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&comm_time, &final_comm_time, 1, MPI_DOUBLE, MPI_MAX, 0, MPI_COMM_WORLD);
+#else
+  for (int i = 0; i < 4; ++i) final_sums[i] = sums[i];
+  for (int i = 0; i < 2; ++i) final_nums[i] = nums[i];
+  final_comm_time = comm_time;
+#endif
+
+  if (comminfo.rank == 0 && final_nums[0] > 0) {
+    fgprintf(FileGroup::summary, "compression %s: ratio %.3f raw %.0f B sent %.0f B compress num %ld sum %.9f s decompress num %ld sum %.9f s effective bandwidth %.3f GB/s\n",
+                           compression_str(comb_compression()),
+                           final_sums[0] / final_sums[1], final_sums[0], final_sums[1],
+                           final_nums[0], final_sums[2], final_nums[1], final_sums[3],
+                           (final_comm_time > 0.0) ? final_sums[0] / final_comm_time / 1.0e9 : 0.0);
+  }
+
+  if (nums[0] > 0) {
+    fgprintf(FileGroup::proc, "compression %s: ratio %.3f raw %.0f B sent %.0f B compress num %ld sum %.9f s decompress num %ld sum %.9f s effective bandwidth %.3f GB/s\n",
+                        compression_str(comb_compression()),
+                        sums[0] / sums[1], sums[0], sums[1],
+                        nums[0], sums[2], nums[1], sums[3],
+                        (comm_time > 0.0) ? sums[0] / comm_time / 1.0e9 : 0.0);
+  }
+}
+
+// prints the usage of each distinct allocator in alocs since its stats
+// were last cleared, summed over the ranks in the summary
+void print_memory_stats(CommInfo& comminfo, std::vector<COMB::Allocator*> const& alocs, IdxT ncycles)
+{
+  std::vector<COMB::Allocator*> printed;
+  for (COMB::Allocator* aloc : alocs) {
+    if (std::find(printed.begin(), printed.end(), aloc) != printed.end()) continue;
+    printed.push_back(aloc);
+
+    COMB::AllocatorStats stats = aloc->get_stats();
+    if (stats.num_allocate < 0) continue;
+
+    long   nums[4]  = {stats.live_nbytes, stats.peak_nbytes, stats.num_allocate, stats.num_deallocate};
+    double times[2] = {stats.allocate_time, stats.deallocate_time};
+
+    long   final_nums[4]  = {0, 0, 0, 0};
+    long   final_max_peak = 0;
+    double final_times[2] = {0.0, 0.0};
+
+#ifdef COMB_ENABLE_MPI
+    MPI_Reduce(nums,  final_nums,  4, MPI_LONG,   MPI_SUM, 0, MPI_COMM_WORLD);
+    MPI_Reduce(&nums[1], &final_max_peak, 1, MPI_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+    MPI_Reduce(times, final_times, 2, MPI_DOUBLE, MPI_SUM, 0, MPI_COMM_WORLD);
+#else
+    for (int i = 0; i < 4; ++i) final_nums[i] = nums[i];
+    final_max_peak = nums[1];
+    for (int i = 0; i < 2; ++i) final_times[i] = times[i];
+#endif
+
+    double cycles = (ncycles > 0) ? (double)ncycles : 1.0;
+
+    if (comminfo.rank == 0) {
+      fgprintf(FileGroup::summary, "memory %s: live %ld B peak %ld B max peak %ld B allocate num %ld per cycle %.1f sum %.9f s deallocate num %ld sum %.9f s\n",
+                             aloc->name(), final_nums[0], final_nums[1], final_max_peak,
+                             final_nums[2], final_nums[2] / cycles, final_times[0],
+                             final_nums[3], final_times[1]);
+    }
+
+    fgprintf(FileGroup::proc, "memory %s: live %ld B peak %ld B allocate num %ld per cycle %.1f sum %.9f s deallocate num %ld sum %.9f s\n",
+                        aloc->name(), nums[0], nums[1],
+                        nums[2], nums[2] / cycles, times[0],
+                        nums[3], times[1]);
+  }
+}
+
+// prints the bytes held by this rank before and after the low footprint
+// layout, with the largest footprint over the ranks in the summary
+void print_footprint(CommInfo& comminfo, CommFootprint const& fp)
+{
+  long nums[7] = {fp.mesh_nbytes,
+                  fp.index_nbytes_before, fp.index_nbytes,
+                  fp.buffer_nbytes_before, fp.buffer_nbytes,
+                  fp.mesh_nbytes + fp.index_nbytes_before + fp.buffer_nbytes_before,
+                  fp.mesh_nbytes + fp.index_nbytes + fp.buffer_nbytes};
+
+  long final_nums[7] = {0, 0, 0, 0, 0, 0, 0};
+
+#ifdef COMB_ENABLE_MPI
+  MPI_Reduce(nums, final_nums, 7, MPI_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+#else
+  for (int i = 0; i < 7; ++i) final_nums[i] = nums[i];
+#endif
+
+  if (comminfo.rank == 0) {
+    fgprintf(FileGroup::summary, "footprint max: mesh %ld B index lists %ld -> %ld B buffers %ld -> %ld B total %ld -> %ld B\n",
+                           final_nums[0], final_nums[1], final_nums[2],
+                           final_nums[3], final_nums[4], final_nums[5], final_nums[6]);
+  }
+
+  fgprintf(FileGroup::proc, "footprint: mesh %ld B index lists %ld -> %ld B buffers %ld -> %ld B total %ld -> %ld B\n",
+                      nums[0], nums[1], nums[2], nums[3], nums[4], nums[5], nums[6]);
+}
+
+// prints the capacity of the comm util arenas and the number of times they
+// were reset since their stats were last cleared
+void print_util_arenas(CommInfo& comminfo, std::vector<COMB::ArenaAllocator*> const& arenas, IdxT ncycles)
+{
+  if (arenas.empty()) return;
+
+  long nums[2] = {0, 0};
+  for (COMB::ArenaAllocator* arena : arenas) {
+    nums[0] += arena->capacity();
+    nums[1] = std::max(nums[1], arena->num_resets());
+  }
+
+  long final_nums[2]  = {0, 0};
+  long final_max_size = 0;
+
+#ifdef COMB_ENABLE_MPI
+  MPI_Reduce(nums, final_nums, 2, MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+  MPI_Reduce(&nums[0], &final_max_size, 1, MPI_LONG, MPI_MAX, 0, MPI_COMM_WORLD);
+#else
+  for (int i = 0; i < 2; ++i) final_nums[i] = nums[i];
+  final_max_size = nums[0];
+#endif
+
+  double cycles = (ncycles > 0) ? (double)ncycles : 1.0;
+
+  if (comminfo.rank == 0) {
+    fgprintf(FileGroup::summary, "util arena: size %ld B max size %ld B resets %ld per cycle %.1f\n",
+                           final_nums[0], final_max_size,
+                           final_nums[1], final_nums[1] / (cycles * comminfo.size));
+  }
+
+  fgprintf(FileGroup::proc, "util arena: size %ld B resets %ld per cycle %.1f\n",
+                      nums[0], nums[1], nums[1] / cycles);
+}
+
+namespace {
+
+void print_node_pages(FileGroup fg, const char* what, const char* name,
+                      std::vector<long> const& pages, int nodes)
+{
+  long total = 0;
+  for (long p : pages) total += p;
+  if (total == 0) return;
+
+  char msg[1024];
+  int len = snprintf(msg, 1024, "numa placement %s %s:", what, name);
+  for (int n = 0; n < nodes && len < 1024; ++n) {
+    len += snprintf(msg + len, 1024 - len, " node %i %.1f%%", n, 100.0 * pages[n] / total);
+  }
+  if (len < 1024) {
+    snprintf(msg + len, 1024 - len, " not present %.1f%% of %ld pages\n", 100.0 * pages.back() / total, total);
+  }
+  fgprintf(fg, "%s", msg);
+}
+
+} // namespace
+
+// prints the share of the pages of the allocations of aloc on each numa node
+// and not yet present, summed over the ranks in the summary
+void print_numa_placement(CommInfo& comminfo, const char* what, COMB::Allocator& aloc)
+{
+  std::vector<long> node_pages = aloc.take_node_pages();
+  if (node_pages.empty()) return;
+
+  // nodes then pages not present
+  int nodes = static_cast<int>(node_pages.size()) - 1;
+  std::vector<long> pages(::detail::numa::max_nodes + 1, 0);
+  for (int n = 0; n < nodes; ++n) pages[n] = node_pages[n];
+  pages.back() = node_pages.back();
+
+  std::vector<long> final_pages(pages.size(), 0);
+
+#ifdef COMB_ENABLE_MPI
+  MPI_Reduce(pages.data(), final_pages.data(), pages.size(), MPI_LONG, MPI_SUM, 0, MPI_COMM_WORLD);
+#else
+  final_pages = pages;
+#endif
+
+  if (comminfo.rank == 0) {
+    print_node_pages(FileGroup::summary, what, aloc.name(), final_pages, nodes);
+  }
+  print_node_pages(FileGroup::proc, what, aloc.name(), pages, nodes);
+}
+
 void print_message_info(CommInfo& comminfo, MeshInfo& info,
                         COMB::Allocator& aloc_unused,
                         IdxT num_vars,
                         bool print_packing_sizes,
                         bool print_message_sizes)
 {
-  if (!(print_packing_sizes || print_message_sizes)) {
+  bool print_index_runs = comb_pack_mode() == PackMode::runs;
+
+  if (!(print_packing_sizes || print_message_sizes || print_index_runs)) {
     return;
   }
 
@@ -114,6 +321,9 @@ void print_message_info(CommInfo& comminfo, MeshInfo& info,
   } else if (print_message_sizes) {
     fgprintf(FileGroup::all, "%sprint message sizes to proc file(s)\n",
         prefix);
+  } else if (print_index_runs) {
+    fgprintf(FileGroup::all, "%sprint index run compression to proc file(s)\n",
+        prefix);
   }
 
   Range r0("print_message_info", Range::green);
@@ -126,7 +336,7 @@ void print_message_info(CommInfo& comminfo, MeshInfo& info,
 
     for (IdxT i = 0; i < num_vars; ++i) {
 
-      vars.push_back(MeshData(info, aloc_unused));
+      vars.push_back(MeshData(info, aloc_unused, comb_var_type(i)));
 
       factory.add_var(vars[i]);
     }
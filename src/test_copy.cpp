@@ -203,6 +203,54 @@ void test_copy_allocators(CommInfo& comminfo,
                       exec_avail,
                       tm, num_vars, len, nrepeats);
 
+  test_copy_allocator(comminfo,
+                      exec,
+                      alloc.host_pool,
+                      cpu_src_aloc,
+                      cuda_src_aloc,
+                      exec_avail,
+                      tm, num_vars, len, nrepeats);
+
+  test_copy_allocator(comminfo,
+                      exec,
+                      alloc.host_hugepage,
+                      cpu_src_aloc,
+                      cuda_src_aloc,
+                      exec_avail,
+                      tm, num_vars, len, nrepeats);
+
+  test_copy_allocator(comminfo,
+                      exec,
+                      alloc.host_numa_interleave,
+                      cpu_src_aloc,
+                      cuda_src_aloc,
+                      exec_avail,
+                      tm, num_vars, len, nrepeats);
+
+  test_copy_allocator(comminfo,
+                      exec,
+                      alloc.host_numa_local,
+                      cpu_src_aloc,
+                      cuda_src_aloc,
+                      exec_avail,
+                      tm, num_vars, len, nrepeats);
+
+  test_copy_allocator(comminfo,
+                      exec,
+                      alloc.host_numa_first_touch,
+                      cpu_src_aloc,
+                      cuda_src_aloc,
+                      exec_avail,
+                      tm, num_vars, len, nrepeats);
+
+  test_copy_allocator(comminfo,
+                      exec,
+                      alloc.host_shm,
+                      cpu_src_aloc,
+                      cuda_src_aloc,
+                      exec_avail,
+                      tm, num_vars, len, nrepeats);
+
 #ifdef COMB_ENABLE_CUDA
 
   test_copy_allocator(comminfo,
@@ -107,7 +107,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        vars.emplace_back(info, aloc_mesh);
+        vars.emplace_back(info, aloc_mesh, comb_var_type(i));
 
         MeshData& var = vars.back();
 
@@ -115,7 +115,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
         var.allocate();
 
         // initialize variable
-        DataT* data = var.data();
+        ElemPtr data = var.data();
         IdxT totallen = info.totallen;
 
         con_mesh.for_all(0, totallen,
@@ -129,6 +129,14 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
       factory.populate(comm, con_many, con_few);
     }
 
+    if (comb_allow_low_footprint()) {
+      CommFootprint fp = comm.footprint();
+      for (MeshData const& var : vars) {
+        fp.mesh_nbytes += var.nbytes();
+      }
+      print_footprint(comminfo, fp);
+    }
+
     // do_cycles_basic expects that all sends and receives have_many (use pol_many)
     assert(comm.m_recvs.message_group_few.messages.size() == 0);
     assert(comm.m_sends.message_group_few.messages.size() == 0);
@@ -156,6 +164,8 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
       Range r2("cycle", Range::cyan);
 
       bool mock_communication = comm.mock_communication();
+      // double values sent at reduced precision are compared with a tolerance
+      DataT tolerance = wire_precision_tolerance(comb_wire_precision());
       IdxT imin = info.min[0];
       IdxT jmin = info.min[1];
       IdxT kmin = info.min[2];
@@ -177,6 +187,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
       IdxT ighost_width = info.ghost_widths[0];
       IdxT jghost_width = info.ghost_widths[1];
       IdxT kghost_width = info.ghost_widths[2];
+      IdxT jstride = info.stride[1];
       IdxT ijlen = info.stride[2];
       IdxT ijlen_global = ilen_global * jlen_global;
 
@@ -186,7 +197,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
         IdxT var_i = i + 1;
 
         con_mesh.for_all_3d(0, klen,
@@ -194,7 +205,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
                                0, ilen,
                                [=] COMB_HOST COMB_DEVICE (IdxT k, IdxT j, IdxT i, IdxT idx) {
           COMB::ignore_unused(idx);
-          IdxT zone = i + j * ilen + k * ijlen;
+          IdxT zone = i + j * jstride + k * ijlen;
           IdxT iglobal = i + iglobal_offset;
           if (iperiodic) {
             iglobal = iglobal % ilen_global;
@@ -217,13 +228,13 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
               j >= jmin+jghost_width && j < jmax-jghost_width &&
               i >= imin+ighost_width && i < imax-ighost_width) {
             // interior non-communicated zones
-            expected = -1.0; found = data[zone]; next =-(zone_global+var_i);
+            expected = -1.0; found = data.load(zone); next =-(zone_global+var_i);
             branchid = 0;
           } else if (k >= kmin && k < kmax &&
                      j >= jmin && j < jmax &&
                      i >= imin && i < imax) {
             // interior communicated zones
-            expected = -1.0; found = data[zone]; next = zone_global + var_i;
+            expected = -1.0; found = data.load(zone); next = zone_global + var_i;
             branchid = 1;
           } else if (iglobal < 0 || iglobal >= ilen_global ||
                      jglobal < 0 || jglobal >= jlen_global ||
@@ -231,21 +242,21 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
             // out of global bounds exterior zones, some may be owned others not
             // some may be communicated if at least one dimension is periodic
             // and another is non-periodic
-            expected = -1.0; found = data[zone]; next = zone_global + var_i;
+            expected = -1.0; found = data.load(zone); next = zone_global + var_i;
             branchid = 2;
           } else {
             // in global bounds exterior zones
-            expected = -1.0; found = data[zone]; next =-(zone_global+var_i);
+            expected = -1.0; found = data.load(zone); next =-(zone_global+var_i);
             branchid = 3;
           }
           if (!mock_communication) {
-            if (found != expected) {
-              FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
+            if (!values_match(found, expected, tolerance)) {
+              FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data.ptr, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
             }
             // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
-            assert(found == expected);
+            assert(values_match(found, expected, tolerance));
           }
-          data[zone] = next;
+          data.store(zone, next);
         });
       }
 
@@ -278,7 +289,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
 
       // for (IdxT i = 0; i < num_vars; ++i) {
 
-      //   DataT* data = vars[i].data();
+      //   ElemPtr data = vars[i].data();
       //   IdxT var_i = i + 1;
 
       //   con_mesh.for_all_3d(0, klen,
@@ -286,7 +297,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
       //                          0, ilen,
       //                          [=] COMB_HOST COMB_DEVICE (IdxT k, IdxT j, IdxT i, IdxT idx) {
       //     COMB::ignore_unused(idx);
-      //     IdxT zone = i + j * ilen + k * ijlen;
+      //     IdxT zone = i + j * jstride + k * ijlen;
       //     IdxT iglobal = i + iglobal_offset;
       //     if (iperiodic) {
       //       iglobal = iglobal % ilen_global;
@@ -309,11 +320,11 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
       //         j >= jmin+jghost_width && j < jmax-jghost_width &&
       //         i >= imin+ighost_width && i < imax-ighost_width) {
       //       // interior non-communicated zones should not have changed value
-      //       expected =-(zone_global+var_i); found = data[zone]; next = -1.0;
+      //       expected =-(zone_global+var_i); found = data.load(zone); next = -1.0;
       //       branchid = 0;
       //       if (!mock_communication) {
       //         if (found != expected) {
-      //           FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
+      //           FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data.ptr, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
       //         }
       //         // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
       //         assert(found == expected);
@@ -354,7 +365,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
         IdxT var_i = i + 1;
 
         con_mesh.for_all_3d(0, klen,
@@ -362,7 +373,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
                                0, ilen,
                                [=] COMB_HOST COMB_DEVICE (IdxT k, IdxT j, IdxT i, IdxT idx) {
           COMB::ignore_unused(idx);
-          IdxT zone = i + j * ilen + k * ijlen;
+          IdxT zone = i + j * jstride + k * ijlen;
           IdxT iglobal = i + iglobal_offset;
           if (iperiodic) {
             iglobal = iglobal % ilen_global;
@@ -385,35 +396,35 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
               j >= jmin+jghost_width && j < jmax-jghost_width &&
               i >= imin+ighost_width && i < imax-ighost_width) {
             // interior non-communicated zones should not have changed value
-            expected =-(zone_global+var_i); found = data[zone]; next = -1.0;
+            expected =-(zone_global+var_i); found = data.load(zone); next = -1.0;
             branchid = 0;
           } else if (k >= kmin && k < kmax &&
                      j >= jmin && j < jmax &&
                      i >= imin && i < imax) {
             // interior communicated zones should not have changed value
-            expected = zone_global + var_i; found = data[zone]; next = -1.0;
+            expected = zone_global + var_i; found = data.load(zone); next = -1.0;
             branchid = 1;
           } else if (iglobal < 0 || iglobal >= ilen_global ||
                      jglobal < 0 || jglobal >= jlen_global ||
                      kglobal < 0 || kglobal >= klen_global) {
             // out of global bounds exterior zones should not have changed value
             // some may have been communicated, but values should be the same
-            expected = zone_global + var_i; found = data[zone]; next = -1.0;
+            expected = zone_global + var_i; found = data.load(zone); next = -1.0;
             branchid = 2;
           } else {
             // in global bounds exterior zones should have changed value
             // should now be populated with data from another rank
-            expected = zone_global + var_i; found = data[zone]; next = -1.0;
+            expected = zone_global + var_i; found = data.load(zone); next = -1.0;
             branchid = 3;
           }
           if (!mock_communication) {
-            if (found != expected) {
-              FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
+            if (!values_match(found, expected, tolerance)) {
+              FGPRINTF(FileGroup::proc, "%p %i zone %i(%i %i %i) g%i(%i %i %i) = %f expected %f next %f\n", data.ptr, branchid, zone, i, j, k, zone_global, iglobal, jglobal, kglobal, found, expected, next);
             }
             // FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
-            assert(found == expected);
+            assert(values_match(found, expected, tolerance));
           }
-          data[zone] = next;
+          data.store(zone, next);
         });
       }
 
@@ -429,7 +440,18 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
 
     tm_total.stop(tm_con);
 
+    // memory spaces of the mesh, message buffers, and index lists
+    std::vector<COMB::Allocator*> alocs{&aloc_mesh, &aloc_many, &aloc_few,
+                                        &con_mesh.util_aloc, &con_many.util_aloc, &con_few.util_aloc};
+
     tm.clear();
+    COMB::comb_compression_stats().clear();
+    for (COMB::Allocator* aloc : alocs) {
+      aloc->clear_stats();
+    }
+    for (COMB::ArenaAllocator* arena : comm.util_arenas()) {
+      arena->clear_stats();
+    }
 
 
    /**************************************************************************
@@ -457,6 +479,7 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
       IdxT ilen = info.len[0];
       IdxT jlen = info.len[1];
       IdxT klen = info.len[2];
+      IdxT jstride = info.stride[1];
       IdxT ijlen = info.stride[2];
 
 
@@ -465,12 +488,12 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
 
         con_mesh.for_all_3d(kmin, kmax,
                             jmin, jmax,
                             imin, imax,
-                            detail::set_1(ilen, ijlen, data));
+                            detail::set_1(jstride, ijlen, data, comb_compressibility(), i));
       }
 
       con_mesh.synchronize();
@@ -533,26 +556,26 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
       /*
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
 
         con_mesh.for_all_3d(0, klen,
                                0, jlen,
                                0, ilen,
                                [=] COMB_HOST COMB_DEVICE (IdxT k, IdxT j, IdxT i, IdxT idx) {
-          IdxT zone = i + j * ilen + k * ijlen;
+          IdxT zone = i + j * jstride + k * ijlen;
           DataT expected, found, next;
           if (k >= kmin && k < kmax &&
               j >= jmin && j < jmax &&
               i >= imin && i < imax) {
-            expected = 1.0; found = data[zone]; next = 1.0;
+            expected = 1.0; found = data.load(zone); next = 1.0;
           } else {
-            expected = -1.0; found = data[zone]; next = -1.0;
+            expected = -1.0; found = data.load(zone); next = -1.0;
           }
           // if (found != expected) {
           //   FGPRINTF(FileGroup::proc, "zone %i(%i %i %i) = %f expected %f\n", zone, i, j, k, found, expected);
           // }
           //FGPRINTF(FileGroup::proc, "%p[%i] = %f\n", data, zone, 1.0);
-          data[zone] = next;
+          data.store(zone, next);
         });
       }
       */
@@ -630,12 +653,12 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
 
       for (IdxT i = 0; i < num_vars; ++i) {
 
-        DataT* data = vars[i].data();
+        ElemPtr data = vars[i].data();
 
         con_mesh.for_all_3d(0, klen,
                                0, jlen,
                                0, ilen,
-                               detail::reset_1(ilen, ijlen, data, imin, jmin, kmin, imax, jmax, kmax));
+                               detail::reset_1(jstride, ijlen, data, imin, jmin, kmin, imax, jmax, kmax));
       }
 
       con_mesh.synchronize();
@@ -655,12 +678,13 @@ void do_cycles_basic(CommContext<pol_comm>& con_comm_in,
 
     print_timer(comminfo, tm);
     print_timer(comminfo, tm_total);
+    print_compression(comminfo, tm);
+    print_memory_stats(comminfo, alocs, ncycles);
+    print_util_arenas(comminfo, comm.util_arenas(), ncycles);
   }
 
   tm.clear();
   tm_total.clear();
-
-  // print_proc_memory_stats(comminfo);
 }
 
 
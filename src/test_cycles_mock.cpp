@@ -55,6 +55,36 @@ void test_cycles_mock(CommInfo& comminfo, MeshInfo& info,
                          num_vars, ncycles, tm, tm_total);
   }
 
+  AllocatorInfo* host_buf_alocs[] = {&alloc.host_hugepage,
+                                     &alloc.host_numa_interleave,
+                                     &alloc.host_numa_local,
+                                     &alloc.host_numa_first_touch,
+                                     &alloc.host_shm};
+  for (AllocatorInfo* host_buf_aloc : host_buf_alocs) {
+    if (!host_buf_aloc->available()) continue;
+
+    // mock other host buffer memory tests
+    AllocatorInfo& cpu_many_aloc = *host_buf_aloc;
+    AllocatorInfo& cpu_few_aloc  = *host_buf_aloc;
+
+  #ifdef COMB_ENABLE_CUDA
+    AllocatorInfo& cuda_many_aloc = alloc.cuda_hostpinned;
+    AllocatorInfo& cuda_few_aloc  = alloc.cuda_hostpinned;
+  #else
+    AllocatorInfo& cuda_many_aloc = alloc.invalid;
+    AllocatorInfo& cuda_few_aloc  = alloc.invalid;
+  #endif
+
+    do_cycles_allocators(con_comm,
+                         comminfo, info,
+                         exec,
+                         alloc,
+                         cpu_many_aloc, cpu_few_aloc,
+                         cuda_many_aloc, cuda_few_aloc,
+                         exec_avail,
+                         num_vars, ncycles, tm, tm_total);
+  }
+
 #ifdef COMB_ENABLE_CUDA
   {
     // mock cuda memory tests
@@ -0,0 +1,56 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "comb.hpp"
+
+#ifdef COMB_ENABLE_MPI
+
+#include "comm_pol_mpi_shm.hpp"
+#include "do_cycles.hpp"
+
+namespace COMB {
+
+void test_cycles_mpi_shm(CommInfo& comminfo, MeshInfo& info,
+                         COMB::ExecContexts& exec,
+                         COMB::Allocators& alloc,
+                         COMB::ExecutorsAvailable& exec_avail,
+                         IdxT num_vars, IdxT ncycles, Timer& tm, Timer& tm_total)
+{
+  CommContext<mpi_shm_pol> con_comm{exec.base_mpi};
+
+  {
+    // mpi shm host memory tests, the recv buffers are in the shared window
+    // so only host execution packs and unpacks them
+    AllocatorInfo& cpu_many_aloc = alloc.host;
+    AllocatorInfo& cpu_few_aloc  = alloc.host;
+
+    AllocatorInfo& cuda_many_aloc = alloc.invalid;
+    AllocatorInfo& cuda_few_aloc  = alloc.invalid;
+
+    do_cycles_allocators(con_comm,
+                         comminfo, info,
+                         exec,
+                         alloc,
+                         cpu_many_aloc, cpu_few_aloc,
+                         cuda_many_aloc, cuda_few_aloc,
+                         exec_avail,
+                         num_vars, ncycles, tm, tm_total);
+  }
+
+}
+
+} // namespace COMB
+
+#endif
@@ -0,0 +1,419 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "comb.hpp"
+
+#include "comm_pol_mock.hpp"
+#include "CommFactory.hpp"
+#include "basic_mempool.hpp"
+#include "size_class_mempool.hpp"
+#include "thread_cache_mempool.hpp"
+
+#include <mutex>
+#include <unordered_map>
+
+#ifdef COMB_ENABLE_OPENMP
+#include <omp.h>
+#endif
+
+namespace COMB {
+
+namespace {
+
+// host allocator that records the allocations and deallocations
+// of a halo exchange cycle in order
+struct RecordingAllocator : Allocator
+{
+  struct op
+  {
+    bool alloc;
+    size_t nbytes;
+    IdxT id;
+  };
+
+  std::vector<op> ops;
+  std::unordered_map<void*, IdxT> ids;
+  IdxT num_allocs = 0;
+
+  const char* name() override { return "Recording"; }
+  void* allocate(size_t nbytes) override
+  {
+    void* ptr = malloc(std::max(nbytes, size_t(1)));
+    ids[ptr] = num_allocs;
+    ops.emplace_back(op{true, nbytes, num_allocs++});
+    return ptr;
+  }
+  void deallocate(void* ptr) override
+  {
+    auto found = ids.find(ptr);
+    assert(found != ids.end());
+    ops.emplace_back(op{false, 0, found->second});
+    ids.erase(found);
+    free(ptr);
+  }
+};
+
+// host allocator that counts the bytes held by a pool
+struct counting_allocator
+{
+  static size_t& reserved()
+  {
+    static size_t nbytes = 0;
+    return nbytes;
+  }
+
+  static std::unordered_map<void*, size_t>& sizes()
+  {
+    static std::unordered_map<void*, size_t> s;
+    return s;
+  }
+
+  void* malloc(size_t nbytes)
+  {
+    void* ptr = std::malloc(nbytes);
+    if (ptr != nullptr) {
+      sizes()[ptr] = nbytes;
+      reserved() += nbytes;
+    }
+    return ptr;
+  }
+
+  bool free(void* ptr)
+  {
+    auto found = sizes().find(ptr);
+    assert(found != sizes().end());
+    reserved() -= found->second;
+    sizes().erase(found);
+    std::free(ptr);
+    return true;
+  }
+};
+
+// records the buffer and utility allocations of one cycle of the
+// halo exchange as done by the mpi comm policy, ids count from 0
+IdxT record_cycle(COMB::ExecContexts& exec,
+                  CommInfo& comm_info, MeshInfo& info,
+                  COMB::Allocator& aloc_mesh,
+                  IdxT num_vars,
+                  std::vector<RecordingAllocator::op>& ops)
+{
+  RecordingAllocator aloc_rec;
+
+#ifdef COMB_ENABLE_MPI
+  CommContext<mock_pol> con_comm_in{exec.base_mpi};
+#else
+  CommContext<mock_pol> con_comm_in{exec.base_cpu};
+#endif
+
+  // make a copy of comminfo to duplicate the MPI communicator
+  CommInfo comminfo(comm_info);
+
+  CommContext<mock_pol> con_comm(con_comm_in
+#ifdef COMB_ENABLE_MPI
+                                ,comminfo.cart.comm
+#endif
+                                 );
+
+  ExecContext<seq_pol> con(exec.base_cpu, aloc_rec);
+
+  using comm_type = Comm<seq_pol, seq_pol, mock_pol>;
+
+  // record the buffers of the messages whose partner is this rank too
+  SetReset<bool> sr_sc(comb_allow_self_copy(), false);
+
+  comm_type comm(con_comm, comminfo, aloc_mesh, aloc_rec, aloc_rec);
+
+  std::vector<MeshData> vars;
+  vars.reserve(num_vars);
+
+  {
+    CommFactory factory(comminfo);
+
+    for (IdxT i = 0; i < num_vars; ++i) {
+
+      vars.push_back(MeshData(info, aloc_mesh, comb_var_type(i)));
+
+      vars[i].allocate();
+
+      con.for_all(0, info.totallen, detail::set_n1(vars[i].data()));
+
+      factory.add_var(vars[i]);
+    }
+
+    con.synchronize();
+
+    factory.populate(comm, con, con);
+  }
+
+  // only record the cycle
+  aloc_rec.ops.clear();
+  IdxT first_id = aloc_rec.num_allocs;
+
+  comm.postRecv(con, con);
+  comm.postSend(con, con);
+  comm.waitRecv(con, con);
+  comm.waitSend(con, con);
+
+  ops.clear();
+  for (RecordingAllocator::op op : aloc_rec.ops) {
+    assert(op.id >= first_id);
+    op.id -= first_id;
+    ops.emplace_back(op);
+  }
+
+  return aloc_rec.num_allocs - first_id;
+}
+
+// replays the recorded cycle nrepeats times,
+// returns the time per allocation or deallocation in ns
+template < typename pool_type >
+double replay_cycles(pool_type& pool,
+                     std::vector<RecordingAllocator::op> const& ops, IdxT num_allocs,
+                     const char* sub_test_name, Timer& tm, IdxT nrepeats)
+{
+  CPUContext tm_con;
+
+  std::vector<char*> ptrs(num_allocs, nullptr);
+
+  for (IdxT rep = 0; rep < nrepeats; ++rep) {
+
+    tm.start(tm_con, sub_test_name);
+
+    for (RecordingAllocator::op const& op : ops) {
+      if (op.alloc) {
+        ptrs[op.id] = pool.template malloc<char>(op.nbytes);
+      } else {
+        pool.free(ptrs[op.id]);
+      }
+    }
+
+    tm.stop(tm_con);
+  }
+
+  double time = 0.0;
+  for (auto& stat : tm.getStats()) {
+    if (stat.name == sub_test_name) {
+      time = stat.sum;
+    }
+  }
+
+  double num_ops = static_cast<double>(ops.size()) * nrepeats;
+  return (num_ops > 0.0) ? time / num_ops * 1.0e9 : 0.0;
+}
+
+// measures the latency of the pool with its default arena size and
+// the bytes it reserves when each arena is only as large as the
+// allocation that needed it
+template < typename pool_type >
+void do_mempool(std::vector<RecordingAllocator::op> const& ops, IdxT num_allocs, size_t peak_nbytes,
+                const char* name, const char* sub_test_name, Timer& tm, IdxT nrepeats)
+{
+  double ns_per_op = 0.0;
+  {
+    pool_type pool;
+    ns_per_op = replay_cycles(pool, ops, num_allocs, sub_test_name, tm, nrepeats);
+    pool.free_chunks();
+  }
+
+  size_t reserved = 0;
+  {
+    pool_type pool;
+    pool.arena_size(1);
+    Timer tm_tight(2*nrepeats);
+    replay_cycles(pool, ops, num_allocs, sub_test_name, tm_tight, nrepeats);
+    reserved = counting_allocator::reserved();
+    pool.free_chunks();
+  }
+
+  double fragmentation = (reserved > 0) ? 1.0 - static_cast<double>(peak_nbytes) / reserved : 0.0;
+
+  fgprintf(FileGroup::all, "mempool %s: %.1f ns per op reserved %zu B for %zu B live fragmentation %.3f\n",
+                           name, ns_per_op, reserved, peak_nbytes, fragmentation);
+}
+
+// pool guarded by a lock so many threads may use it
+template < typename pool_type >
+struct locked_pool
+{
+  pool_type pool;
+  std::mutex mutex;
+
+  template < typename T >
+  T* malloc(size_t nTs)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    return pool.template malloc<T>(nTs);
+  }
+
+  void free(const void* ptr)
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    pool.free(ptr);
+  }
+
+  void free_chunks()
+  {
+    pool.free_chunks();
+  }
+};
+
+int max_num_threads()
+{
+#ifdef COMB_ENABLE_OPENMP
+  return omp_get_max_threads();
+#else
+  return 1;
+#endif
+}
+
+// replays the recorded cycle nrepeats times on each thread, with
+// free_other each thread frees the buffers allocated by the next thread,
+// returns the time per allocation or deallocation of a thread in ns
+template < typename pool_type >
+double replay_cycles_threads(pool_type& pool,
+                             std::vector<RecordingAllocator::op> const& ops, IdxT num_allocs,
+                             int num_threads, bool free_other,
+                             const char* sub_test_name, Timer& tm, IdxT nrepeats)
+{
+  CPUContext tm_con;
+
+  std::vector<std::vector<char*>> ptrs(num_threads, std::vector<char*>(num_allocs, nullptr));
+
+  tm.start(tm_con, sub_test_name);
+
+#ifdef COMB_ENABLE_OPENMP
+#pragma omp parallel num_threads(num_threads)
+#endif
+  {
+#ifdef COMB_ENABLE_OPENMP
+    int thread = omp_get_thread_num();
+#else
+    int thread = 0;
+#endif
+    std::vector<char*>& my_ptrs    = ptrs[thread];
+    std::vector<char*>& other_ptrs = ptrs[(thread + 1) % num_threads];
+
+    for (IdxT rep = 0; rep < nrepeats; ++rep) {
+
+      if (!free_other) {
+        for (RecordingAllocator::op const& op : ops) {
+          if (op.alloc) {
+            my_ptrs[op.id] = pool.template malloc<char>(op.nbytes);
+          } else {
+            pool.free(my_ptrs[op.id]);
+          }
+        }
+      } else {
+        for (RecordingAllocator::op const& op : ops) {
+          if (op.alloc) {
+            my_ptrs[op.id] = pool.template malloc<char>(op.nbytes);
+          }
+        }
+#ifdef COMB_ENABLE_OPENMP
+#pragma omp barrier
+#endif
+        for (RecordingAllocator::op const& op : ops) {
+          if (!op.alloc) {
+            pool.free(other_ptrs[op.id]);
+          }
+        }
+#ifdef COMB_ENABLE_OPENMP
+#pragma omp barrier
+#endif
+      }
+    }
+  }
+
+  tm.stop(tm_con);
+
+  double time = 0.0;
+  for (auto& stat : tm.getStats()) {
+    if (stat.name == sub_test_name) {
+      time = stat.sum;
+    }
+  }
+
+  double num_ops = static_cast<double>(ops.size()) * nrepeats;
+  return (num_ops > 0.0) ? time / num_ops * 1.0e9 : 0.0;
+}
+
+// measures the latency of the pool when all threads allocate and
+// free at once, freeing on the same thread and on another thread
+template < typename pool_type >
+void do_mempool_threads(std::vector<RecordingAllocator::op> const& ops, IdxT num_allocs,
+                        int num_threads, const char* name, const char* sub_test_name, Timer& tm, IdxT nrepeats)
+{
+  char same_name[256];
+  snprintf(same_name, 256, "%s-same", sub_test_name);
+  char other_name[256];
+  snprintf(other_name, 256, "%s-other", sub_test_name);
+
+  pool_type pool;
+  double ns_same  = replay_cycles_threads(pool, ops, num_allocs, num_threads, false, same_name, tm, nrepeats);
+  double ns_other = replay_cycles_threads(pool, ops, num_allocs, num_threads, true, other_name, tm, nrepeats);
+  pool.free_chunks();
+
+  fgprintf(FileGroup::all, "mempool %s %i threads: %.1f ns per op same thread free %.1f ns per op other thread free\n",
+                           name, num_threads, ns_same, ns_other);
+}
+
+} // namespace
+
+void test_mempool(CommInfo& comminfo, MeshInfo& info,
+                  COMB::ExecContexts& exec,
+                  COMB::Allocators& alloc,
+                  Timer& tm, IdxT num_vars, IdxT nrepeats)
+{
+  tm.clear();
+
+  const char* test_name = "mempool halo cycle";
+  fgprintf(FileGroup::all, "Starting test %s\n", test_name);
+
+  Range r(test_name, Range::green);
+
+  std::vector<RecordingAllocator::op> ops;
+  IdxT num_allocs = record_cycle(exec, comminfo, info, alloc.host.allocator(), num_vars, ops);
+
+  size_t live_nbytes = 0;
+  size_t peak_nbytes = 0;
+  std::vector<size_t> nbytes(num_allocs, 0);
+  for (RecordingAllocator::op const& op : ops) {
+    if (op.alloc) {
+      nbytes[op.id] = op.nbytes;
+      live_nbytes += op.nbytes;
+      peak_nbytes = std::max(peak_nbytes, live_nbytes);
+    } else {
+      live_nbytes -= nbytes[op.id];
+    }
+  }
+
+  do_mempool<RAJA::basic_mempool::MemPool<counting_allocator>>(
+      ops, num_allocs, peak_nbytes, "arena", "mempool-arena", tm, nrepeats);
+  do_mempool<COMB::size_class_mempool::MemPool<counting_allocator>>(
+      ops, num_allocs, peak_nbytes, "size_class", "mempool-size_class", tm, nrepeats);
+  do_mempool<COMB::thread_cache_mempool::MemPool<counting_allocator>>(
+      ops, num_allocs, peak_nbytes, "thread_cache", "mempool-thread_cache", tm, nrepeats);
+
+  int num_threads = max_num_threads();
+  do_mempool_threads<locked_pool<COMB::size_class_mempool::MemPool<detail::host_allocator>>>(
+      ops, num_allocs, num_threads, "locked_size_class", "mempool-threads-locked_size_class", tm, nrepeats);
+  do_mempool_threads<COMB::thread_cache_mempool::MemPool<detail::host_allocator>>(
+      ops, num_allocs, num_threads, "thread_cache", "mempool-threads-thread_cache", tm, nrepeats);
+
+  print_timer(comminfo, tm);
+  tm.clear();
+}
+
+} // namespace COMB
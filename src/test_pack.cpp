@@ -0,0 +1,241 @@
+//////////////////////////////////////////////////////////////////////////////
+// Copyright (c) 2018-2020, Lawrence Livermore National Security, LLC.
+//
+// Produced at the Lawrence Livermore National Laboratory
+//
+// LLNL-CODE-758885
+//
+// All rights reserved.
+//
+// This file is part of Comb.
+//
+// For details, see https://github.com/LLNL/Comb
+// Please also see the LICENSE file for MIT license.
+//////////////////////////////////////////////////////////////////////////////
+
+#include "comb.hpp"
+
+#include "comm_pol_mock.hpp"
+#include "CommFactory.hpp"
+
+namespace COMB {
+
+template < typename pol >
+bool should_do_pack(ExecContext<pol>& con,
+                    COMB::AllocatorInfo& mesh_aloc,
+                    COMB::AllocatorInfo& buf_aloc)
+{
+  return mesh_aloc.available() // && buf_aloc.available()
+      && mesh_aloc.accessible(con)
+      && buf_aloc.accessible(con) ;
+}
+
+template < typename T >
+double sum_values(T const* data, IdxT len)
+{
+  double sum = 0.0;
+  for (IdxT i = 0; i < len; ++i) {
+    sum += data[i];
+  }
+  return sum;
+}
+
+// reads every mesh value, timed after packing to show how much
+// of the mesh was evicted from cache by packing
+double read_vars(std::vector<MeshData>& vars, IdxT len)
+{
+  double sum = 0.0;
+  for (MeshData& var : vars) {
+    switch (var.type) {
+      case ElemType::f64: sum += sum_values(static_cast<double const*>(var.ptr), len); break;
+      case ElemType::f32: sum += sum_values(static_cast<float const*>(var.ptr),  len); break;
+      case ElemType::i32: sum += sum_values(static_cast<int const*>(var.ptr),    len); break;
+    }
+  }
+  return sum;
+}
+
+// packs the send messages of the halo exchange nrepeats times
+// using the given pack mode, reading the mesh after each pack,
+// returns the pack bandwidth and mesh read bandwidth in GB/s
+template < typename pol >
+double do_pack_mode(ExecContext<pol>& con,
+                    CommContext<mock_pol>& con_comm,
+                    CommInfo& comminfo,
+                    std::vector<MeshData>& vars, IdxT totallen,
+                    COMB::Allocator& aloc_mesh,
+                    COMB::Allocator& aloc_buf,
+                    PackMode mode,
+                    Timer& tm, IdxT nrepeats,
+                    double& read_bw)
+{
+  CPUContext tm_con;
+
+  using comm_type = Comm<pol, pol, mock_pol>;
+  using send_message_type = typename comm_type::send_message_type;
+
+  SetReset<PackMode> sr_pm(comb_pack_mode(), mode);
+  // pack the messages whose partner is this rank too
+  SetReset<bool> sr_sc(comb_allow_self_copy(), false);
+
+  // timer keeps the name pointer so use string literals
+  const char* sub_test_name = (mode == PackMode::box)  ? "pack-box"
+                            : (mode == PackMode::runs) ? "pack-runs" : "pack-list";
+  const char* read_test_name = (mode == PackMode::box)  ? "read-after-pack-box"
+                             : (mode == PackMode::runs) ? "read-after-pack-runs" : "read-after-pack-list";
+
+  comm_type comm(con_comm, comminfo, aloc_mesh, aloc_buf, aloc_buf);
+
+  {
+    CommFactory factory(comminfo);
+
+    for (MeshData& var : vars) {
+      factory.add_var(var);
+    }
+
+    factory.populate(comm, con, con);
+  }
+
+  // cutoff is 0 so all messages are in the many group
+  std::vector<send_message_type*> msgs;
+  for (send_message_type& msg : comm.m_sends.message_group_many.messages) {
+    msgs.emplace_back(&msg);
+  }
+  assert(comm.m_sends.message_group_few.messages.empty());
+
+  IdxT num_msgs = msgs.size();
+  send_message_type** msgs_ptr = (num_msgs > 0) ? &msgs[0] : nullptr;
+
+  double nbytes = 0.0;
+  for (send_message_type* msg : msgs) {
+    nbytes += static_cast<double>(msg->nbytes());
+  }
+
+  double read_nbytes = 0.0;
+  for (MeshData& var : vars) {
+    read_nbytes += static_cast<double>(totallen) * elem_type_size(var.type);
+  }
+  volatile double read_sum = 0.0;
+
+  for (IdxT rep = 0; rep < nrepeats; ++rep) {
+
+    comm.m_sends.message_group_many.allocate(con, con_comm, msgs_ptr, num_msgs);
+
+    tm.start(tm_con, sub_test_name);
+
+    comm.m_sends.message_group_many.pack(con, con_comm, msgs_ptr, num_msgs, ::detail::Async::no);
+    comm.m_sends.message_group_many.wait_pack_complete(con, con_comm, msgs_ptr, num_msgs, ::detail::Async::no);
+
+    tm.stop(tm_con);
+
+    tm.start(tm_con, read_test_name);
+
+    read_sum = read_sum + read_vars(vars, totallen);
+
+    tm.stop(tm_con);
+
+    comm.m_sends.message_group_many.deallocate(con, con_comm, msgs_ptr, num_msgs);
+  }
+
+  double time = 0.0;
+  double read_time = 0.0;
+  for (auto& stat : tm.getStats()) {
+    if (stat.name == sub_test_name) {
+      time = stat.sum;
+    } else if (stat.name == read_test_name) {
+      read_time = stat.sum;
+    }
+  }
+
+  read_bw = (read_time > 0.0) ? read_nbytes * nrepeats / read_time / 1.0e9 : 0.0;
+  return (time > 0.0) ? nbytes * nrepeats / time / 1.0e9 : 0.0;
+}
+
+template < typename pol >
+void do_pack(ExecContext<pol>& con,
+             CommContext<mock_pol>& con_comm_in,
+             CommInfo& comm_info, MeshInfo& info,
+             COMB::Allocator& aloc_mesh,
+             COMB::Allocator& aloc_buf,
+             PackStore store,
+             Timer& tm, IdxT num_vars, IdxT nrepeats)
+{
+  tm.clear();
+
+  SetReset<PackStore> sr_ps(comb_pack_store(), store);
+
+  char test_name[1024] = ""; snprintf(test_name, 1024, "pack %s Mesh %s Buffers %s store %s", pol::get_name(), aloc_mesh.name(), aloc_buf.name(), pack_store_str(store));
+  fgprintf(FileGroup::all, "Starting test %s\n", test_name);
+
+  Range r(test_name, Range::green);
+
+  // make a copy of comminfo to duplicate the MPI communicator
+  CommInfo comminfo(comm_info);
+  comminfo.cutoff = 0;
+
+  CommContext<mock_pol> con_comm(con_comm_in
+#ifdef COMB_ENABLE_MPI
+                                ,comminfo.cart.comm
+#endif
+                                 );
+
+  std::vector<MeshData> vars;
+  vars.reserve(num_vars);
+
+  for (IdxT i = 0; i < num_vars; ++i) {
+
+    vars.push_back(MeshData(info, aloc_mesh, comb_var_type(i)));
+
+    vars[i].allocate();
+
+    con.for_all(0, info.totallen, detail::set_n1(vars[i].data()));
+  }
+
+  con.synchronize();
+
+  double list_read_bw = 0.0;
+  double box_read_bw  = 0.0;
+  double runs_read_bw = 0.0;
+  double list_bw = do_pack_mode(con, con_comm, comminfo, vars, info.totallen, aloc_mesh, aloc_buf, PackMode::list, tm, nrepeats, list_read_bw);
+  double box_bw  = do_pack_mode(con, con_comm, comminfo, vars, info.totallen, aloc_mesh, aloc_buf, PackMode::box,  tm, nrepeats, box_read_bw);
+  double runs_bw = do_pack_mode(con, con_comm, comminfo, vars, info.totallen, aloc_mesh, aloc_buf, PackMode::runs, tm, nrepeats, runs_read_bw);
+
+  print_timer(comminfo, tm);
+  tm.clear();
+
+  fgprintf(FileGroup::all, "pack bandwidth list %.3f GB/s box %.3f GB/s runs %.3f GB/s\n", list_bw, box_bw, runs_bw);
+  fgprintf(FileGroup::all, "read after pack bandwidth list %.3f GB/s box %.3f GB/s runs %.3f GB/s\n", list_read_bw, box_read_bw, runs_read_bw);
+}
+
+void test_pack(CommInfo& comminfo, MeshInfo& info,
+               COMB::ExecContexts& exec,
+               COMB::Allocators& alloc,
+               COMB::ExecutorsAvailable& exec_avail,
+               Timer& tm, IdxT num_vars, IdxT nrepeats)
+{
+#ifdef COMB_ENABLE_MPI
+  CommContext<mock_pol> con_comm{exec.base_mpi};
+#else
+  CommContext<mock_pol> con_comm{exec.base_cpu};
+#endif
+
+  // pack host memory tests
+  AllocatorInfo& mesh_aloc = alloc.host;
+  AllocatorInfo& buf_aloc  = alloc.host;
+
+  if (exec_avail.seq && should_do_pack(exec.seq, mesh_aloc, buf_aloc))
+    do_pack(exec.seq, con_comm, comminfo, info, mesh_aloc.allocator(), buf_aloc.allocator(), PackStore::cached, tm, num_vars, nrepeats);
+
+  // simd packing compares regular and streaming stores
+  if (exec_avail.simd && should_do_pack(exec.simd, mesh_aloc, buf_aloc)) {
+    do_pack(exec.simd, con_comm, comminfo, info, mesh_aloc.allocator(), buf_aloc.allocator(), PackStore::cached,    tm, num_vars, nrepeats);
+    do_pack(exec.simd, con_comm, comminfo, info, mesh_aloc.allocator(), buf_aloc.allocator(), PackStore::streaming, tm, num_vars, nrepeats);
+  }
+
+#ifdef COMB_ENABLE_OPENMP
+  if (exec_avail.omp && should_do_pack(exec.omp, mesh_aloc, buf_aloc))
+    do_pack(exec.omp, con_comm, comminfo, info, mesh_aloc.allocator(), buf_aloc.allocator(), PackStore::cached, tm, num_vars, nrepeats);
+#endif
+}
+
+} // namespace COMB